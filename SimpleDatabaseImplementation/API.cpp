@@ -3,22 +3,52 @@
 #include"API.h"
 #include"Exceptions.h"
 #include"RecordManager.h"
+#include"BloomFilter.h"
+#include"ArtIndex.h"
 #include<iostream>
 #include <boost/filesystem.hpp>
 #include<iomanip>
+#include<thread>
+#include<algorithm>
 
 using namespace std;
 
+/*ɾļֶδ洢ʱĺļfile.1file.2*/
+static void RemoveSegmentFiles(string file_name)
+{
+	for (int k = 1; boost::filesystem::exists(file_name + "." + to_string(k)); k++)
+		boost::filesystem::remove(file_name + "." + to_string(k));
+}
+
+/*ļض̵blocks飬ֶʱɾȥĶΣĩβĶνض*/
+static void TruncateFile(string file_name, int blocks, int segment_blocks)
+{
+	long long size = (long long)blocks * 4 * 1024;
+	if (segment_blocks > 0 && blocks > segment_blocks)
+	{
+		int last = (blocks - 1) / segment_blocks;
+		for (int k = last + 1; boost::filesystem::exists(file_name + "." + to_string(k)); k++)
+			boost::filesystem::remove(file_name + "." + to_string(k));
+		file_name += "." + to_string(last);
+		size = (long long)(blocks - last * segment_blocks) * 4 * 1024;
+	}
+	else RemoveSegmentFiles(file_name);
+	if (boost::filesystem::exists(file_name) && (long long)boost::filesystem::file_size(file_name) > size)
+		boost::filesystem::resize_file(file_name, size);
+}
+
 /*API캯*/
 API::API(string path) :path_(path)
 {
 	catalog_manager_ = new CatalogManager(path);
+	max_parallel_workers_ = min(max(1, (int)thread::hardware_concurrency()), MAX_PARALLEL_WORKERS);/*ĬΪCPU*/
 }
 
 /*API*/
 API::~API(void)
 {
 	delete buffer_manager_;
+	if (current_database_.length() != 0) ArtIndex::SaveAll(current_database_);/*¼дغдARTĿ*/
 	delete catalog_manager_;
 }
 
@@ -33,13 +63,17 @@ void API::help()
 	cout << setw(16) << "show databases" << setw(2) << "|" << "ʾݿ⡣show databases;" << endl;
 	cout << setw(16) << "show tables" << setw(2) << "|" << "ʾǰݿݱshow tables;" << endl;
 	cout << setw(16) << "use" << setw(2) << "|" << "ѡһݿ⡣use university;" << endl;
-	cout << setw(16) << "create database" << setw(2) << "|" << "һݿ⡣create database university;" << endl;
-	cout << setw(16) << "create table" << setw(2) << "|" << "ڵǰݿⴴһݱcreate table student(id int,name char(20),primary key(id));" << endl;
-	cout << setw(16) << "create index" << setw(2) << "|" << "һűϴcreate index on student(id);" << endl;
+	cout << setw(16) << "create database" << setw(2) << "|" << "һݿ⡣create database university; ļÿ1024MBһΣcreate database university segment 1024;" << endl;
+	cout << setw(16) << "create table" << setw(2) << "|" << "ڵǰݿⴴһݱcreate table student(id int,name char(20),primary key(id)); 䳤¼charʵʳȴţɾƶ¼create table student(id int,name varchar(255),primary key(id)) using slotted; дţۼֻõֶΣcreate table score(id int,grade float) using pax;" << endl;
+	cout << setw(16) << "create index" << setw(2) << "|" << "ڱһֶϴһűжcreate index i1 on student(name); create index i2 on student(name, age); ϣcreate index i3 on student(id) using hash; create index i4 on student(id) include (name); ڴеARTcreate index i5 on student(age) using art; ָ߳ĬΪCPUcreate index i6 on student(name) threads 4;" << endl;
+	cout << setw(16) << "create bloom" << setw(2) << "|" << "ڱһֶϴ¡ֵѯжֵڣÿһcreate bloom on student(id); ָÿ4096create bloom on student(id) blocks 64;" << endl;
 	cout << setw(16) << "drop database" << setw(2) << "|" << "ɾݿ⡣drop database university;" << endl;
 	cout << setw(16) << "drop table" << setw(2) << "|" << "ɾǰݿһݱdrop table student;" << endl;
 	cout << setw(16) << "drop index" << setw(2) << "|" << "ɾ drop index i1;" << endl;
-	cout << setw(16) << "select" << setw(2) << "|" << "ѯݡselete * from student where id=1 and name='Tom';" << endl;
+	cout << setw(16) << "drop bloom" << setw(2) << "|" << "ɾĲ¡drop bloom on student;" << endl;
+	cout << setw(16) << "vacuum index" << setw(2) << "|" << "ȥļĩβĿп飨ϲճĿƽʱɷãvacuum index i1;" << endl;
+	cout << setw(16) << "select" << setw(2) << "|" << "ѯݡselete * from student where id=1 and name='Tom'; select * from student where age > 18 order by id desc limit 10; ǰ20select * from student order by id limit 10 offset 20;" << endl;
+	cout << setw(16) << "set" << setw(2) << "|" << "޸áȫɨ߳ĬΪCPU64set max_parallel_workers = 4;" << endl;
 	cout << setw(16) << "insert" << setw(2) << "|" << "ݡinsert into student values(2,'Tim');" << endl;
 	cout << setw(16) << "delete" << setw(2) << "|" << "ɾݡdelete from student where id=2;" << endl;
 	cout << setw(16) << "update" << setw(2) << "|" << "ݡupdate student set name='Tom' where id='2';" << endl;
@@ -61,7 +95,8 @@ void API::CreateDatabase(SQLCreateDatabase& sql_statement)
 	}
 	boost::filesystem::create_directories(folder_path);/*file systemboostⴴļַӦļ*/
 	cout << "ݿļѴ" << endl;
-	catalog_manager_->CreateDatabase(sql_statement.get_database_name());/*catalog managercatalogдݿ*/
+	catalog_manager_->CreateDatabase(sql_statement.get_database_name(), sql_statement.get_segment_size() * 256);/*catalog managercatalogдݿ⣬ֶδСΪ*/
+	if (sql_statement.get_segment_size() > 0) cout << "ļÿ " << sql_statement.get_segment_size() << "MB ΪһΡ" << endl;
 	cout << "Ŀ¼д롣" << endl << endl;
 	catalog_manager_->WriteArchiveFile();/*catalog managercatalogдĵ*/
 
@@ -85,6 +120,7 @@ void API::CreateTable(SQLCreateTable& sql_statement)
 		boost::filesystem::remove_all(folder_path);/*file SystemboostɾļַӦļ*/
 		cout << "ݱļѴڣɾ" << endl;
 	}
+	RemoveSegmentFiles(file_name);
 	ofstream ofs(file_name);/*file SystemļַӦļ*/
 	ofs.close();
 	cout << "ݱļѴ" << endl;
@@ -114,6 +150,24 @@ void API::CreateIndex(SQLCreateIndex& sql_statement)
 	cout << " " + sql_statement.get_tb_name() + " д " + sql_statement.get_index_name() << endl;
 }
 
+/*½¡еĹ滻*/
+void API::CreateBloom(SQLCreateBloom& sql_statement)
+{
+	cout << "¡: " << sql_statement.get_tb_name() << "(" << sql_statement.get_column_name() << ")" << endl;
+	if (current_database_.length() == 0) throw NoDatabaseSelectedException();
+
+	Database *db = catalog_manager_->GetDB(current_database_);
+	Table *tb = db->GetTable(sql_statement.get_tb_name());
+	if (tb == NULL) throw TableNotExistException();
+	if (tb->GetAttribute(sql_statement.get_column_name()) == NULL) throw AttributeNotExistException();
+
+	int blocks = sql_statement.get_blocks() > 0 ? sql_statement.get_blocks() : BLOOM_DEFAULT_BLOCKS;
+	IndexManager *im = new IndexManager(catalog_manager_, buffer_manager_, current_database_);
+	im->CreateBloom(tb, sql_statement.get_column_name(), blocks);
+	delete im;
+	cout << "¡Ѵ " << blocks << " 顣" << endl;
+}
+
 /*ʾݿ*/
 void API::ShowDatabases()
 {
@@ -193,6 +247,7 @@ void API::DropDatabase(SQLDropDatabase& sql_statement)
 		cout << sql_statement.get_database_name() + " ݿļɾ" << endl;
 	}
 
+	ArtIndex::DropDatabase(sql_statement.get_database_name());/*ͷڴеART*/
 	catalog_manager_->DeleteDatabase(sql_statement.get_database_name());/*catalog managerĿ¼ɾݿ*/
 	cout << sql_statement.get_database_name() + " ݿĿ¼ɾ" << endl;
 	catalog_manager_->WriteArchiveFile();/*catalog managercatalogдĵ*/
@@ -234,13 +289,18 @@ void API::DropTable(SQLDropTable& sql_statement)
 	else
 	{
 		boost::filesystem::remove(file_name);/*file systemboostɾļ*/
+		RemoveSegmentFiles(file_name);
 		cout << sql_statement.get_table_name() + "ݱļɾ" << endl;
 	}
 
+	boost::filesystem::remove(path_ + current_database_ + "/" + sql_statement.get_table_name() + ".bloom");/*file systemɾ¡ļûʱκ£*/
+	RemoveSegmentFiles(path_ + current_database_ + "/" + sql_statement.get_table_name() + ".bloom");
+
 	cout << "ɾݱļ" << endl;
 	for (unsigned int i = 0; i < tb->GetIndexNum(); i++)
 	{
 		string file_name(path_ + current_database_ + "/" + tb->GetIndex(i)->get_name() + ".index");/*ȡݱļַ*/
+		ArtIndex::Drop(current_database_, tb->GetIndex(i)->get_name());/*ͷڴеART*/
 		if (!boost::filesystem::exists(file_name))/*file systemboostжϸļǷ*/
 		{
 			cout << "ļڡ" << endl;
@@ -248,6 +308,7 @@ void API::DropTable(SQLDropTable& sql_statement)
 		else
 		{
 			boost::filesystem::remove(file_name);
+			RemoveSegmentFiles(file_name);
 			cout << "ļɾ" << endl;
 		}
 	}
@@ -274,6 +335,7 @@ void API::DropIndex(SQLDropIndex& sql_statement)
 	{
 		throw IndexNotExistException();
 	}
+	ArtIndex::Drop(current_database_, sql_statement.get_index_name());/*ͷڴеART*/
 	string file_name(path_ + current_database_ + "/" + sql_statement.get_index_name() + ".index");/*file systemȡļַ*/
 	if (!boost::filesystem::exists(file_name))/*file systemboostжϵǰļǷ*/
 	{
@@ -281,6 +343,7 @@ void API::DropIndex(SQLDropIndex& sql_statement)
 		return;
 	}
 	boost::filesystem::remove(file_name);/*file systemboostɾļַӦļ*/
+	RemoveSegmentFiles(file_name);
 	cout << "ļɾ" << endl;
 
 	db->DropIndex(sql_statement);/*catalog managerĿ¼ṹɾ*/
@@ -289,6 +352,68 @@ void API::DropIndex(SQLDropIndex& sql_statement)
 										 //cout << "ɾ" << endl;
 }
 
+/*ļĩβĿп飺B+ϲĿڿпϹʱãļĩβĿпժ²ضļ*/
+void API::VacuumIndex(SQLVacuumIndex& sql_statement)
+{
+	if (current_database_.length() == 0)/*жϵǰݿǷѡ*/
+	{
+		throw NoDatabaseSelectedException();
+	}
+	Database *db = catalog_manager_->GetDB(current_database_);
+	if (db == NULL)/*жϵǰݿǷ*/
+	{
+		throw DatabaseNotExistException();
+	}
+	Index *idx = db->GetIndex(sql_statement.get_index_name());/*catalog managerȡ*/
+	if (idx == NULL)
+	{
+		throw IndexNotExistException();
+	}
+	IndexManager *im = new IndexManager(catalog_manager_, buffer_manager_, current_database_);
+	int reclaimed = im->VacuumIndex(idx);
+	delete im;
+	buffer_manager_->WriteToDisk();/*buffer managerпͷ޸дأٽضļ*/
+	if (reclaimed > 0)
+	{
+		string file_name(path_ + current_database_ + "/" + sql_statement.get_index_name() + ".index");/*file systemȡļַ*/
+		TruncateFile(file_name, idx->get_max_count(), db->get_segment_blocks());
+		if (!idx->has_header()) catalog_manager_->WriteArchiveFile();/*catalog managerĿĿ¼*/
+	}
+	cout << " " << sql_statement.get_index_name() << "  " << reclaimed << " 飬 " << idx->get_max_count() << " 顣" << endl;
+}
+
+/*޸ãmax_parallel_workersΪȫɨ߳Ϊ1MAX_PARALLEL_WORKERSʱMAX_PARALLEL_WORKERS*/
+void API::Set(SQLSet& sql_statement)
+{
+	if (sql_statement.get_variable() != "max_parallel_workers" || sql_statement.get_value() < 1)
+	{
+		throw SyntaxErrorException();
+	}
+	max_parallel_workers_ = min(sql_statement.get_value(), MAX_PARALLEL_WORKERS);
+	cout << "max_parallel_workers = " << max_parallel_workers_ << endl;
+}
+
+/*ɾ¡*/
+void API::DropBloom(SQLDropBloom& sql_statement)
+{
+	if (current_database_.length() == 0) throw NoDatabaseSelectedException();
+
+	Database *db = catalog_manager_->GetDB(current_database_);
+	Table *tb = db->GetTable(sql_statement.get_tb_name());
+	if (tb == NULL) throw TableNotExistException();
+	if (tb->get_bloom_attr() == "")
+	{
+		cout << "ñûв¡" << endl;
+		return;
+	}
+	string file_name(path_ + current_database_ + "/" + sql_statement.get_tb_name() + ".bloom");/*file systemȡļַ*/
+	boost::filesystem::remove(file_name);
+	RemoveSegmentFiles(file_name);
+	tb->SetBloom("", 0);
+	catalog_manager_->WriteArchiveFile();/*catalog managercatalogдĵ*/
+	cout << "¡ɾ" << endl;
+}
+
 /*ѡǰݿ*/
 void API::Use(SQLUse& sql_statement)
 {
@@ -303,9 +428,10 @@ void API::Use(SQLUse& sql_statement)
 		cout << "رѡݿ⣺" << current_database_ << endl;
 		catalog_manager_->WriteArchiveFile();/*catalog managercatalogдĵ*/
 		delete buffer_manager_;
+		ArtIndex::SaveAll(current_database_);/*дARTĿ*/
 	}
 	current_database_ = sql_statement.get_database_name();/*µǰݿ*/
-	buffer_manager_ = new BufferManager(path_);/*»*/
+	buffer_manager_ = new BufferManager(path_, db->get_segment_blocks());/*»ļݿķֶδСд*/
 	cout << endl << "ݿ" + sql_statement.get_database_name() + "ѽ롣" << endl;
 	cout << "ѡݿ" << endl << endl;
 }
@@ -341,8 +467,8 @@ void API::Select(SQLSelect& sql_statement)
 		throw TableNotExistException();
 	}
 	RecordManager *rm = new RecordManager(catalog_manager_, buffer_manager_, current_database_);
-	vector<vector<TKey>>result;
-	result = rm->Select(sql_statement);
+	rm->set_parallel_workers(max_parallel_workers_);
+	rm->Select(sql_statement);
 	delete rm;
 	//cout << "ѯ" << endl;
 }
@@ -26,11 +26,15 @@ public:
 	void CreateDatabase(SQLCreateDatabase& sql_statement);/*½ݿ*/
 	void CreateTable(SQLCreateTable& sql_statement);/*½ݱ*/
 	void CreateIndex(SQLCreateIndex& sql_statement);/*½*/
+	void CreateBloom(SQLCreateBloom& sql_statement);/*½¡*/
 	void ShowDatabases();/*ʾݿ*/
 	void ShowTables();/*ʾݱ*/
 	void DropDatabase(SQLDropDatabase& sql_statement);/*ɾݿ*/
 	void DropTable(SQLDropTable& sql_statement);/*ɾݱ*/
 	void DropIndex(SQLDropIndex& sql_statement);/*ɾ*/
+	void DropBloom(SQLDropBloom& sql_statement);/*ɾ¡*/
+	void VacuumIndex(SQLVacuumIndex& sql_statement);/*ļĩβĿп*/
+	void Set(SQLSet& sql_statement);/*޸*/
 	void Use(SQLUse& sql_statement);/*ѡݿ*/
 	void Insert(SQLInsert& sql_statement, bool &flag);/**/
 	void Select(SQLSelect& sql_statement);/*ѯ*/
@@ -42,5 +46,6 @@ private:
 	string current_database_;//ǰѡݿ
 	CatalogManager* catalog_manager_;//Ŀ¼
 	BufferManager*	buffer_manager_;//
+	int max_parallel_workers_;//ȫɨ߳
 };
 #endif // ! API_H_
\ No newline at end of file
@@ -0,0 +1,651 @@
+//飺ART
+//ãڴʵӦadaptive radix treeΪֶεĽձ룬ֵֵ֧ѯ뷶Χѯ
+#include "ArtIndex.h"
+#include "Exceptions.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+
+#define ART_NODE4 0
+#define ART_NODE16 1
+#define ART_NODE48 2
+#define ART_NODE256 3
+
+struct ArtNode
+{
+	unsigned char type;				/*ڵ*/
+	int count;						/**/
+	string prefix;					/*ѹ·ýڵмڸڵķֽ֧֮еֽ*/
+};
+struct ArtNode4 : ArtNode { unsigned char keys[4]; void *children[4]; };			/*keys*/
+struct ArtNode16 : ArtNode { unsigned char keys[16]; void *children[16]; };		/*keys*/
+struct ArtNode48 : ArtNode { unsigned char index[256]; void *children[48]; };	/*index[b]Ϊֽbĺchildrenеλüһ0ʾû*/
+struct ArtNode256 : ArtNode { void *children[256]; };
+struct ArtLeaf { RID value; int len; unsigned char key[1]; };					/*keyʵʳΪlen*/
+
+struct ArtScan
+{
+	bool low_eq, high_eq;			/*Ƿ˵*/
+	bool reverse;					/*ӴС*/
+	int limit;						/*෵صĸС0ʱ*/
+	vector<RID> values;
+	vector<TKey> *keys;
+};
+
+static map<string, ArtIndex*> arts;		/*ѶARTԡ/Ϊ*/
+static mutex arts_mutex;
+
+#pragma region ڵ
+static bool is_leaf(void *p) { return ((uintptr_t)p & 1) != 0; }
+static ArtLeaf* as_leaf(void *p) { return (ArtLeaf*)((uintptr_t)p & ~(uintptr_t)1); }
+
+static void* make_leaf(const unsigned char *key, int len, RID value)
+{
+	ArtLeaf *leaf = (ArtLeaf*)malloc(offsetof(ArtLeaf, key) + len);
+	leaf->value = value;
+	leaf->len = len;
+	memcpy(leaf->key, key, len);
+	return (void*)((uintptr_t)leaf | 1);
+}
+
+template <class T> static T* new_node(unsigned char type)
+{
+	T *node = new T();
+	node->type = type;
+	node->count = 0;
+	return node;
+}
+
+/*ֽڱȽϣ̵ļǳļǰ׺ʱ̵ǰB+T_BINARY˳ͬ*/
+static int compare(const unsigned char *a, int alen, const unsigned char *b, int blen)
+{
+	int r = memcmp(a, b, alen < blen ? alen : blen);
+	if (r != 0) return r;
+	return alen - blen;
+}
+
+/*·ΪpathĽڵµмboundȽϣȫСڷ-1ȫڷ1ȷ0
+  ЩpathͷұpathpathboundͷʱǶbound*/
+static int compare_path(const string &path, TKey *bound)
+{
+	int blen = bound->get_length(), plen = path.size();
+	int r = memcmp(path.data(), bound->get_key(), plen < blen ? plen : blen);
+	if (r != 0) return r < 0 ? -1 : 1;
+	return plen >= blen ? 1 : 0;
+}
+
+/*ֽbӦĺָĵַû򷵻NULL*/
+static void** find_child(ArtNode *n, unsigned char b)
+{
+	switch (n->type)
+	{
+	case ART_NODE4:
+	{
+		ArtNode4 *node = (ArtNode4*)n;
+		for (int i = 0; i < node->count; i++)
+			if (node->keys[i] == b) return &node->children[i];
+		return NULL;
+	}
+	case ART_NODE16:
+	{
+		ArtNode16 *node = (ArtNode16*)n;
+		for (int i = 0; i < node->count; i++)
+			if (node->keys[i] == b) return &node->children[i];
+		return NULL;
+	}
+	case ART_NODE48:
+	{
+		ArtNode48 *node = (ArtNode48*)n;
+		return node->index[b] ? &node->children[node->index[b] - 1] : NULL;
+	}
+	default:
+	{
+		ArtNode256 *node = (ArtNode256*)n;
+		return node->children[b] ? &node->children[b] : NULL;
+	}
+	}
+}
+
+/*ֽ˳ȡnкӣغ*/
+static int ordered_children(ArtNode *n, unsigned char *bytes, void **children)
+{
+	int count = 0;
+	switch (n->type)
+	{
+	case ART_NODE4:
+		memcpy(bytes, ((ArtNode4*)n)->keys, n->count);
+		memcpy(children, ((ArtNode4*)n)->children, n->count * sizeof(void*));
+		return n->count;
+	case ART_NODE16:
+		memcpy(bytes, ((ArtNode16*)n)->keys, n->count);
+		memcpy(children, ((ArtNode16*)n)->children, n->count * sizeof(void*));
+		return n->count;
+	case ART_NODE48:
+		for (int b = 0; b < 256; b++)
+		{
+			if (((ArtNode48*)n)->index[b] == 0) continue;
+			bytes[count] = (unsigned char)b;
+			children[count++] = ((ArtNode48*)n)->children[((ArtNode48*)n)->index[b] - 1];
+		}
+		return count;
+	default:
+		for (int b = 0; b < 256; b++)
+		{
+			if (((ArtNode256*)n)->children[b] == NULL) continue;
+			bytes[count] = (unsigned char)b;
+			children[count++] = ((ArtNode256*)n)->children[b];
+		}
+		return count;
+	}
+}
+
+/*вһ*/
+static void insert_sorted(unsigned char *keys, void **children, int count, unsigned char b, void *child)
+{
+	int i = count;
+	while (i > 0 && keys[i - 1] > b)
+	{
+		keys[i] = keys[i - 1];
+		children[i] = children[i - 1];
+		i--;
+	}
+	keys[i] = b;
+	children[i] = child;
+}
+
+/*nͬѹ·½һtypeĽڵ㣬nк*/
+static ArtNode* copy_node(ArtNode *n, unsigned char type);
+
+/*nֽΪbĺӣn򻻳ɸĽڵ㣬*refΪָ½ڵ*/
+static void add_child(void **ref, ArtNode *n, unsigned char b, void *child)
+{
+	switch (n->type)
+	{
+	case ART_NODE4:
+		if (n->count < 4)
+		{
+			insert_sorted(((ArtNode4*)n)->keys, ((ArtNode4*)n)->children, n->count++, b, child);
+			return;
+		}
+		break;
+	case ART_NODE16:
+		if (n->count < 16)
+		{
+			insert_sorted(((ArtNode16*)n)->keys, ((ArtNode16*)n)->children, n->count++, b, child);
+			return;
+		}
+		break;
+	case ART_NODE48:
+		if (n->count < 48)
+		{
+			ArtNode48 *node = (ArtNode48*)n;
+			int slot = 0;
+			while (node->children[slot] != NULL) slot++;
+			node->children[slot] = child;
+			node->index[b] = (unsigned char)(slot + 1);
+			n->count++;
+			return;
+		}
+		break;
+	default:
+		((ArtNode256*)n)->children[b] = child;
+		n->count++;
+		return;
+	}
+	ArtNode *grown = copy_node(n, n->type + 1);
+	delete n;
+	*ref = grown;
+	add_child(ref, grown, b, child);
+}
+
+static ArtNode* copy_node(ArtNode *n, unsigned char type)
+{
+	unsigned char bytes[256];
+	void *children[256];
+	int count = ordered_children(n, bytes, children);
+	ArtNode *node;
+	switch (type)
+	{
+	case ART_NODE4: node = new_node<ArtNode4>(type); break;
+	case ART_NODE16: node = new_node<ArtNode16>(type); break;
+	case ART_NODE48: node = new_node<ArtNode48>(type); break;
+	default: node = new_node<ArtNode256>(type); break;
+	}
+	node->prefix = n->prefix;
+	void *ref = node;
+	for (int i = 0; i < count; i++)
+		add_child(&ref, node, bytes[i], children[i]);
+	return node;
+}
+
+/*ɾȥnֽΪbĺӣ򻻳ɸСĽڵ㣻ֻʣһӵArtNode4ɸúӴ棬ʱtrue*/
+static bool remove_child(void **ref, ArtNode *n, unsigned char b)
+{
+	unsigned char shrink_type = n->type;
+	switch (n->type)
+	{
+	case ART_NODE4:
+	case ART_NODE16:
+	{
+		unsigned char *keys = n->type == ART_NODE4 ? ((ArtNode4*)n)->keys : ((ArtNode16*)n)->keys;
+		void **children = n->type == ART_NODE4 ? ((ArtNode4*)n)->children : ((ArtNode16*)n)->children;
+		int i = 0;
+		while (keys[i] != b) i++;
+		for (n->count--; i < n->count; i++)
+		{
+			keys[i] = keys[i + 1];
+			children[i] = children[i + 1];
+		}
+		if (n->type == ART_NODE16 && n->count == 3) shrink_type = ART_NODE4;
+		break;
+	}
+	case ART_NODE48:
+	{
+		ArtNode48 *node = (ArtNode48*)n;
+		node->children[node->index[b] - 1] = NULL;
+		node->index[b] = 0;
+		if (--n->count == 12) shrink_type = ART_NODE16;
+		break;
+	}
+	default:
+		((ArtNode256*)n)->children[b] = NULL;
+		if (--n->count == 37) shrink_type = ART_NODE48;
+		break;
+	}
+
+	if (n->type == ART_NODE4 && n->count == 1)
+	{
+		/* Ψһĺӽýڵ㣺ڲڵѹ·ǰ油ϸýڵѹ·ֽ֧ڣҶбļ */
+		ArtNode4 *node = (ArtNode4*)n;
+		void *child = node->children[0];
+		if (!is_leaf(child))
+			((ArtNode*)child)->prefix = node->prefix + (char)node->keys[0] + ((ArtNode*)child)->prefix;
+		*ref = child;
+		delete node;
+		return true;
+	}
+	if (shrink_type != n->type)
+	{
+		*ref = copy_node(n, shrink_type);
+		delete n;
+	}
+	return false;
+}
+
+/*˳nҶд*/
+static void write_leaves(void *n, ofstream &ofs)
+{
+	if (n == NULL) return;
+	if (is_leaf(n))
+	{
+		ArtLeaf *leaf = as_leaf(n);
+		ofs.write((char*)&leaf->len, sizeof(int));
+		ofs.write((char*)leaf->key, leaf->len);
+		ofs.write((char*)&leaf->value, sizeof(RID));
+		return;
+	}
+	unsigned char bytes[256];
+	void *children[256];
+	int count = ordered_children((ArtNode*)n, bytes, children);
+	for (int i = 0; i < count; i++)
+		write_leaves(children[i], ofs);
+}
+#pragma endregion
+
+#pragma region 
+ArtIndex* ArtIndex::Find(string db_name, string index_name)
+{
+	lock_guard<mutex> guard(arts_mutex);
+	auto it = arts.find(db_name + "/" + index_name);
+	return it == arts.end() ? NULL : it->second;
+}
+
+ArtIndex* ArtIndex::Open(string db_name, string index_name, string file_name)
+{
+	lock_guard<mutex> guard(arts_mutex);
+	ArtIndex *&art = arts[db_name + "/" + index_name];
+	delete art;
+	art = new ArtIndex(file_name);
+	return art;
+}
+
+void ArtIndex::Drop(string db_name, string index_name)
+{
+	lock_guard<mutex> guard(arts_mutex);
+	auto it = arts.find(db_name + "/" + index_name);
+	if (it == arts.end()) return;
+	delete it->second;
+	arts.erase(it);
+}
+
+void ArtIndex::DropDatabase(string db_name)
+{
+	lock_guard<mutex> guard(arts_mutex);
+	string prefix = db_name + "/";
+	for (auto it = arts.begin(); it != arts.end();)
+	{
+		if (it->first.compare(0, prefix.size(), prefix) != 0)
+		{
+			it++;
+			continue;
+		}
+		delete it->second;
+		it = arts.erase(it);
+	}
+}
+
+void ArtIndex::SaveAll(string db_name)
+{
+	lock_guard<mutex> guard(arts_mutex);
+	string prefix = db_name + "/";
+	for (auto it = arts.begin(); it != arts.end(); it++)
+	{
+		if (it->first.compare(0, prefix.size(), prefix) == 0 && !it->second->snapshot_valid_)
+			it->second->SaveSnapshot();
+	}
+}
+#pragma endregion
+
+ArtIndex::ArtIndex(string file_name) :root_(NULL), key_count_(0), node_count_(0), file_name_(file_name), snapshot_valid_(false) {}
+
+ArtIndex::~ArtIndex(void)
+{
+	free_tree(root_);
+}
+
+void ArtIndex::free_tree(void *n)
+{
+	if (n == NULL) return;
+	if (is_leaf(n))
+	{
+		free(as_leaf(n));
+		return;
+	}
+	unsigned char bytes[256];
+	void *children[256];
+	int count = ordered_children((ArtNode*)n, bytes, children);
+	for (int i = 0; i < count; i++)
+		free_tree(children[i]);
+	switch (((ArtNode*)n)->type)
+	{
+	case ART_NODE4: delete (ArtNode4*)n; break;
+	case ART_NODE16: delete (ArtNode16*)n; break;
+	case ART_NODE48: delete (ArtNode48*)n; break;
+	default: delete (ArtNode256*)n; break;
+	}
+}
+
+/*еļѾ룻ļʱѶĲ*/
+bool ArtIndex::LoadSnapshot()
+{
+	lock_guard<mutex> guard(mutex_);
+	ifstream ifs(file_name_.c_str(), ios::binary);
+	int magic = 0, count = 0;
+	ifs.read((char*)&magic, sizeof(int));
+	ifs.read((char*)&count, sizeof(int));
+	if (!ifs || magic != ART_SNAPSHOT_MAGIC) return false;
+	vector<unsigned char> key;
+	for (int i = 0; i < count; i++)
+	{
+		int len = 0;
+		RID value = 0;
+		ifs.read((char*)&len, sizeof(int));
+		if (!ifs || len <= 0 || len > 64 * 1024) break;
+		key.resize(len);
+		ifs.read((char*)&key[0], len);
+		ifs.read((char*)&value, sizeof(RID));
+		if (!ifs) break;
+		insert(&root_, &key[0], len, 0, value);
+	}
+	if (key_count_ != count)
+	{
+		free_tree(root_);
+		root_ = NULL;
+		key_count_ = node_count_ = 0;
+		return false;
+	}
+	snapshot_valid_ = true;
+	return true;
+}
+
+/*дʱļд滻գдһ˳ʱɿȻ*/
+void ArtIndex::SaveSnapshot()
+{
+	lock_guard<mutex> guard(mutex_);
+	string tmp_name = file_name_ + ".tmp";
+	ofstream ofs(tmp_name.c_str(), ios::binary | ios::trunc);
+	int magic = ART_SNAPSHOT_MAGIC;
+	ofs.write((char*)&magic, sizeof(int));
+	ofs.write((char*)&key_count_, sizeof(int));
+	write_leaves(root_, ofs);
+	ofs.close();
+	if (!ofs) return;
+	boost::filesystem::rename(tmp_name, file_name_);
+	snapshot_valid_ = true;
+}
+
+void ArtIndex::invalidate_snapshot()
+{
+	if (!snapshot_valid_) return;
+	ofstream ofs(file_name_.c_str(), ios::binary | ios::trunc);
+	ofs.close();
+	snapshot_valid_ = false;
+}
+
+bool ArtIndex::add(TKey& key, RID value)
+{
+	lock_guard<mutex> guard(mutex_);
+	invalidate_snapshot();
+	return insert(&root_, (const unsigned char*)key.get_key(), key.get_length(), 0, value);
+}
+
+bool ArtIndex::remove(TKey& key)
+{
+	lock_guard<mutex> guard(mutex_);
+	invalidate_snapshot();
+	return erase(&root_, (const unsigned char*)key.get_key(), key.get_length(), 0);
+}
+
+/*refָļkeyǰdepthֽڿͷͬһеļΪǰ׺ǰ׺ϵ˵Ĳ*/
+bool ArtIndex::insert(void **ref, const unsigned char *key, int len, int depth, RID value)
+{
+	void *n = *ref;
+	if (n == NULL)
+	{
+		*ref = make_leaf(key, len, value);
+		key_count_++;
+		return true;
+	}
+	if (is_leaf(n))
+	{
+		/* ҶӷΪһArtNode4ѹ·Ϊdepth֮еֽ */
+		ArtLeaf *leaf = as_leaf(n);
+		if (compare(leaf->key, leaf->len, key, len) == 0) return false;
+		int i = depth;
+		while (i < leaf->len && i < len && leaf->key[i] == key[i]) i++;
+		if (i == leaf->len || i == len) throw BPlusTreeException();
+		ArtNode4 *node = new_node<ArtNode4>(ART_NODE4);
+		node->prefix.assign((const char*)key + depth, i - depth);
+		insert_sorted(node->keys, node->children, node->count++, leaf->key[i], n);
+		insert_sorted(node->keys, node->children, node->count++, key[i], make_leaf(key, len, value));
+		*ref = node;
+		node_count_++;
+		key_count_++;
+		return true;
+	}
+
+	ArtNode *node = (ArtNode*)n;
+	int plen = node->prefix.size(), p = 0;
+	while (p < plen && depth + p < len && (unsigned char)node->prefix[p] == key[depth + p]) p++;
+	if (p < plen)
+	{
+		/* ѹ·ڵpֽڴͬ½ArtNode4ѹ·ΪǰpֽڣԭڵҶΪ */
+		if (depth + p == len) throw BPlusTreeException();
+		ArtNode4 *parent = new_node<ArtNode4>(ART_NODE4);
+		parent->prefix = node->prefix.substr(0, p);
+		unsigned char b = (unsigned char)node->prefix[p];
+		node->prefix.erase(0, p + 1);
+		insert_sorted(parent->keys, parent->children, parent->count++, b, node);
+		insert_sorted(parent->keys, parent->children, parent->count++, key[depth + p], make_leaf(key, len, value));
+		*ref = parent;
+		node_count_++;
+		key_count_++;
+		return true;
+	}
+	depth += plen;
+	if (depth == len) throw BPlusTreeException();
+	void **child = find_child(node, key[depth]);
+	if (child != NULL) return insert(child, key, len, depth + 1, value);
+	add_child(ref, node, key[depth], make_leaf(key, len, value));
+	key_count_++;
+	return true;
+}
+
+bool ArtIndex::erase(void **ref, const unsigned char *key, int len, int depth)
+{
+	void *n = *ref;
+	if (n == NULL) return false;
+	if (is_leaf(n))
+	{
+		ArtLeaf *leaf = as_leaf(n);
+		if (compare(leaf->key, leaf->len, key, len) != 0) return false;
+		free(leaf);
+		*ref = NULL;
+		key_count_--;
+		return true;
+	}
+	ArtNode *node = (ArtNode*)n;
+	int plen = node->prefix.size();
+	if (len - depth <= plen || memcmp(node->prefix.data(), key + depth, plen) != 0) return false;
+	depth += plen;
+	void **child = find_child(node, key[depth]);
+	if (child == NULL) return false;
+	if (!is_leaf(*child)) return erase(child, key, len, depth + 1);
+
+	ArtLeaf *leaf = as_leaf(*child);
+	if (compare(leaf->key, leaf->len, key, len) != 0) return false;
+	free(leaf);
+	key_count_--;
+	if (remove_child(ref, node, key[depth])) node_count_--;
+	return true;
+}
+
+RID ArtIndex::get_value(TKey& key)
+{
+	lock_guard<mutex> guard(mutex_);
+	const unsigned char *k = (const unsigned char*)key.get_key();
+	int len = key.get_length(), depth = 0;
+	void *n = root_;
+	while (n != NULL)
+	{
+		if (is_leaf(n))
+		{
+			ArtLeaf *leaf = as_leaf(n);
+			return compare(leaf->key, leaf->len, k, len) == 0 ? leaf->value : -1;
+		}
+		ArtNode *node = (ArtNode*)n;
+		int plen = node->prefix.size();
+		if (len - depth <= plen || memcmp(node->prefix.data(), k + depth, plen) != 0) return -1;
+		depth += plen;
+		void **child = find_child(node, k[depth]);
+		if (child == NULL) return -1;
+		n = *child;
+		depth++;
+	}
+	return -1;
+}
+
+vector<RID> ArtIndex::get_range(TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys, bool reverse, int limit)
+{
+	lock_guard<mutex> guard(mutex_);
+	ArtScan s;
+	s.low_eq = low_eq;
+	s.high_eq = high_eq;
+	s.reverse = reverse;
+	s.limit = limit;
+	s.keys = keys;
+	string path;
+	if (limit != 0) scan(root_, path, low, high, s);
+	return s.values;
+}
+
+/*½ʱٱȽ½磻СϽʱٱȽϽ硣
+  ˳ʱС½Ͻʱʱ*/
+bool ArtIndex::scan(void *n, string &path, TKey *low, TKey *high, ArtScan &s)
+{
+	if (n == NULL) return true;
+	if (is_leaf(n))
+	{
+		ArtLeaf *leaf = as_leaf(n);
+		if (low != NULL)
+		{
+			int r = compare(leaf->key, leaf->len, (const unsigned char*)low->get_key(), low->get_length());
+			if (r < 0 || (r == 0 && !s.low_eq)) return !s.reverse;
+		}
+		if (high != NULL)
+		{
+			int r = compare(leaf->key, leaf->len, (const unsigned char*)high->get_key(), high->get_length());
+			if (r > 0 || (r == 0 && !s.high_eq)) return s.reverse;
+		}
+		s.values.push_back(leaf->value);
+		if (s.keys != NULL)
+		{
+			TKey key(T_BINARY, leaf->len);
+			memcpy(key.get_key(), leaf->key, leaf->len);
+			s.keys->push_back(key);
+		}
+		return s.limit < 0 || (int)s.values.size() < s.limit;
+	}
+
+	ArtNode *node = (ArtNode*)n;
+	size_t base = path.size();
+	path += node->prefix;
+	if (low != NULL)
+	{
+		int r = compare_path(path, low);
+		if (r < 0)
+		{
+			path.resize(base);
+			return !s.reverse;
+		}
+		if (r > 0) low = NULL;
+	}
+	if (high != NULL)
+	{
+		int r = compare_path(path, high);
+		if (r > 0)
+		{
+			path.resize(base);
+			return s.reverse;
+		}
+		if (r < 0) high = NULL;
+	}
+	unsigned char bytes[256];
+	void *children[256];
+	int count = ordered_children(node, bytes, children);
+	bool go = true;
+	for (int i = 0; i < count && go; i++)
+	{
+		int k = s.reverse ? count - 1 - i : i;
+		path.push_back((char)bytes[k]);
+		go = scan(children[k], path, low, high, s);
+		path.pop_back();
+	}
+	path.resize(base);
+	return go;
+}
+
+void ArtIndex::print()
+{
+	lock_guard<mutex> guard(mutex_);
+	printf("*----------------------------------------------*\n");
+	printf("ART: %d, ڲڵ: %d \n", key_count_, node_count_);
+}
@@ -0,0 +1,69 @@
+//飺ART
+//ãڴʵӦadaptive radix treeΪֶεĽձ룬ֵֵ֧ѯ뷶Χѯ
+#pragma once
+#ifndef _ARTINDEX_H_
+#define _ARTINDEX_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "SQLStatement.h"
+#include "ConstValue.h"
+
+using namespace std;
+
+/*
+ARTֻڴУеһõʱļеĿն룬Чʱɱļ¼ؽIndexManager::GetArt
+˺롢ɾڴά
+еڲڵ㰴Ϊ41648256֣Ӷ˻ɸĽڵ㣬˻ɸСĽڵ㣻ڵ㱣ѹ·prefix
+Ҷӱļ¼ַָλΪ1ʱָҶӡ
+Ĳǰ׺ѹʽB+ͬIndexManager::BuildKeyͬһеļΪǰ׺ÿһҶϡ
+գļ.index0-3ֽΪART_SNAPSHOT_MAGIC4-7ֽΪ󰴼˳Ϊ[4][][¼ַ8]
+ڹرݿʱд룻պһ޸ʱȰļգ;˳ʱ´ɼ¼ؽʱĿա
+*/
+#define ART_SNAPSHOT_MAGIC 0x53545241
+
+struct ArtScan;
+
+class ArtIndex
+{
+public:
+	//ڽ̵ARTвdb_nameindex_nameûʱNULL
+	static ArtIndex* Find(string db_name, string index_name);
+	//еǼһյARTfile_nameΪĿļ
+	static ArtIndex* Open(string db_name, string index_name, string file_name);
+	//ɾ / ɾݿʱͷڴеART
+	static void Drop(string db_name, string index_name);
+	static void DropDatabase(string db_name);
+	//رݿʱdb_name޸ĹARTд
+	static void SaveAll(string db_name);
+
+	bool LoadSnapshot();									/*գղڻЧʱfalseΪ*/
+	void SaveSnapshot();									/*мдļ*/
+	bool add(TKey& key, RID value);							/*ΪkeyԪأѴʱfalse*/
+	bool remove(TKey& key);									/*ɾΪkeyԪأʱfalse*/
+	RID get_value(TKey& key);								/*keyѯvalueֵʱ-1*/
+	vector<RID> get_range(TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys = NULL, bool reverse = false, int limit = -1);	/*Χɨ裬ͬBPlusTree::get_rangereverseΪtrueʱӴС*/
+	void print();
+
+private:
+	ArtIndex(string file_name);
+	~ArtIndex(void);
+
+	void *root_;											/*ڵ㣨ֻһʱҶӣ*/
+	int key_count_;											/**/
+	int node_count_;										/*ڲڵ*/
+	string file_name_;										/*ļ*/
+	bool snapshot_valid_;									/*ļڴеһ*/
+	mutex mutex_;											/*ͬһʱֻһ̶߳д*/
+
+	void invalidate_snapshot();								/*һ޸ǰտļ*/
+	bool insert(void **ref, const unsigned char *key, int len, int depth, RID value);
+	bool erase(void **ref, const unsigned char *key, int len, int depth);
+	//˳򣨻򣩱n[low, high]֮ҶӣpathΪnѹ·֮ǰֽڣfalseʾԽ߽Ѷ
+	bool scan(void *n, string &path, TKey *low, TKey *high, ArtScan &s);
+	void free_tree(void *n);
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include "BPlusTree.h"
 #include "Exceptions.h"
 #include "ConstValue.h"
+#include "IndexHeader.h"
+#include <algorithm>
 using namespace std;
 
 BPlusTree::BPlusTree(Index* idx, BufferManager* bm, CatalogManager* cm, string dbname)
@@ -15,14 +17,16 @@ BPlusTree::BPlusTree(Index* idx, BufferManager* bm, CatalogManager* cm, string d
 	idx_ = idx;
 	degree_ = 2 * idx_->get_rank() + 1;
 	db_name_ = dbname;
+	header_dirty_ = false;
+	IndexHeader::Load(idx_, buffer_m_, db_name_);
 }
 
-BPlusTree::~BPlusTree(void) {}
+BPlusTree::~BPlusTree(void) { flush(); }
 
 void BPlusTree::InitTree()
 {
-	BTNode *root_node = new BTNode(this, true, get_new_blocknum(), true);
-	idx_->set_root(0);
+	BTNode *root_node = new_node(true);
+	idx_->set_root(root_node->get_block_num());
 	idx_->set_leaf_head(idx_->get_root());
 	idx_->set_key_count(0);
 	idx_->set_node_count(1);
@@ -38,114 +42,103 @@ string BPlusTree::get_db_name() { return db_name_; }
 /*ڵblock_numϼԪkey ƫoffset*/
 bool BPlusTree::add(TKey& key, int block_num, int offset)
 {
-	int value = (block_num << 16) | offset;/*offsetݼ¼offsetһ16λƳȵ:0000000000|offset->ȡoffsetĺ16λ*/
+	RID value = MAKE_RID(block_num, offset);/*¼ַڸλڵoffset¼ڵ16λ*/
+	if (idx_->get_rid_len() == 4 && block_num > 0x7fff) throw BPlusTreeException();/*ļ¼ַֻ4ֽڣŲ¸Ŀ*/
 	if (idx_->get_root() == -1)
 		InitTree();
 
+	bool ans = false;
 	FindNodeParam fnp = search(idx_->get_root(), key);
 	if (!fnp.flag)
 	{
 		fnp.pnode->add(key, value);
-		idx_->IncreaseKeyCount();
-		if (fnp.pnode->get_count() == degree_)
-			return spiltForAdd(fnp.pnode->get_block_num());
-		return true;
+		change_key_count(1);
+		ans = true;
+		if (fnp.pnode->IsOverflow())
+			ans = spiltForAdd(fnp.pnode->get_block_num());
 	}
-	return false;
+	flush();
+	return ans;
 }
-/*ԪغB+:*/
+/*ԪغB+:ѡǰ׺ѹʽ·ֳұ߿ȻŲ£BTNode::SplitPointѵÿڵ㶼ŵ£ٰѸָβ븸ڵ*/
 bool BPlusTree::spiltForAdd(int node)
 {
 	BTNode *pnode = get_node(node);
-	TKey key(idx_->get_key_type(), idx_->get_key_len());
-	BTNode *newnode = pnode->split(key);
-	idx_->IncreaseNodeCount();
-	int parent = pnode->get_parent();
+	vector<TKey> keys;
+	vector<int> nodes(1, node);/*nodes[i]nodes[i + 1]keys[i]*/
+	while (pnode->IsOverflow())
+	{
+		TKey key(idx_->get_key_type(), idx_->get_key_len());
+		BTNode *newnode = pnode->split(key);
+		idx_->IncreaseNodeCount();
+		if (newnode->is_leaf() && newnode->get_next_leaf() != -1 && idx_->has_prev_links())
+			get_node(newnode->get_next_leaf())->set_prev_leaf(newnode->get_block_num());/*ԭһҶӵһҶӸΪҶ*/
+		keys.push_back(key);
+		nodes.push_back(newnode->get_block_num());
+		pnode = newnode;
+	}
+	int parent = parent_of(node);
 
+	BTNode *parentnode;
 	if (parent == -1)											/* ǰڵǸڵ */
 	{
-		BTNode *newroot = new BTNode(this, true, get_new_blocknum());
-		if (newroot == NULL) return false;
+		parentnode = new_node(false);
+		if (parentnode == NULL) return false;
 
 		idx_->IncreaseNodeCount();
-		idx_->set_root(newroot->get_block_num());
-
-		newroot->add(key);
-		newroot->set_values(0, pnode->get_block_num());
-		newroot->set_values(1, newnode->get_block_num());
-
-		pnode->set_parent(idx_->get_root());
-		newnode->set_parent(idx_->get_root());
-		newnode->set_next_leaf(-1);
+		idx_->set_root(parentnode->get_block_num());
+		path_.insert(path_.begin(), parentnode->get_block_num());
 		idx_->IncreaseLevel();
-		return true;
 	}
-	else
-	{
-		BTNode *parentnode = get_node(parent);
-		int index = parentnode->add(key);
+	else parentnode = get_node(parent);
 
-		parentnode->set_values(index, pnode->get_block_num());
-		parentnode->set_values(index + 1, newnode->get_block_num());
+	for (int i = 0; i < (int)keys.size(); i++)
+	{
+		int index = parentnode->add(keys[i]);
 
-		if (parentnode->get_count() == degree_)
-			return spiltForAdd(parentnode->get_block_num());
-		return true;
+		parentnode->set_values(index, nodes[i]);
+		parentnode->set_values(index + 1, nodes[i + 1]);
 	}
+
+	if (parentnode->IsOverflow())
+		return spiltForAdd(parentnode->get_block_num());
+	return true;
 }
-/*ƳkeyԪ*/
+/*ƳkeyԪءڲڵķָֻҪ>=м<ұмɾҶӵ󲻱޸*/
 bool BPlusTree::remove(TKey key)
 {
 	if (idx_->get_root() == -1) return false;
 
-	BTNode *rootnode = get_node(idx_->get_root());
 	FindNodeParam fnp = search(idx_->get_root(), key);
-
 	if (fnp.flag)
 	{
-		if (idx_->get_root() == fnp.pnode->get_block_num())
-		{
-			rootnode->remove(fnp.index);
-			idx_->DecreaseKeyCount();
-			mergeForRemove(fnp.pnode->get_block_num());
-			return true;
-		}
-
-		if (fnp.index == fnp.pnode->get_count() - 1)
-		{
-			FindNodeParam fnpb = search_pos(idx_->get_root(), key);
-			if (fnpb.flag)
-				fnpb.pnode->set_keys(fnpb.index, fnp.pnode->get_keys(fnp.pnode->get_count() - 2));
-		}
-
 		fnp.pnode->remove(fnp.index);
-		idx_->DecreaseKeyCount();
+		change_key_count(-1);
 		mergeForRemove(fnp.pnode->get_block_num());
+		flush();
 		return true;
 	}
+	flush();
 	return false;
 }
-/*ɾԪغB+ϲ*/
+/*ɾԪغB+ϲֵܽڵܽԪʱһϲǰ׺ѹʽ߶УϲŲ£ʱʱϿյĽڵ*/
 bool BPlusTree::mergeForRemove(int node)
 {
 	BTNode* pnode = get_node(node);
-	if (pnode->get_count() >= idx_->get_rank()) return true;
+	if (!pnode->IsUnderflow()) return true;
 
 	if (pnode->isRoot())
 	{
 		if (pnode->get_count() == 0)
 		{
 			if (!pnode->is_leaf())
-			{
-				idx_->set_root(pnode->get_values(0));
-				get_node(pnode->get_values(0))->set_parent(-1);
-			}
+				idx_->set_root((int)pnode->get_values(0));
 			else
 			{
 				idx_->set_root(-1);
 				idx_->set_leaf_head(-1);
 			}
-			delete pnode;
+			free_node(pnode);
 			idx_->DecreaseNodeCount();
 			idx_->DecreaseLevel();
 		}
@@ -154,21 +147,22 @@ bool BPlusTree::mergeForRemove(int node)
 
 	BTNode *pbrother;
 	BTNode *pparent;
-	int pos;
+	int pos = 0;
 
-	pparent = get_node(pnode->get_parent());
-	pparent->search(pnode->get_keys(0), pos);/*ڸڵвѯָpnodeַָpos*/
+	pparent = get_node(parent_of(node));
+	while (pparent->get_values(pos) != node) pos++;/*ڸڵвѯָpnodeַָpos*/
+	TKey sep = pparent->get_keys(pos == pparent->get_count() ? pos - 1 : pos);/*ڵpnodeֵܽڵļ*/
 
 	if (pos == pparent->get_count())/*pnodeǸڵһ*/
 	{
-		pbrother = get_node(pparent->get_values(pos - 1));/*ֵܽڵ:ڵǰһڵ*/
-		if (pbrother->get_count() > idx_->get_rank())/*ֵܽڵ涨rankpbrotherһԪpnode*/
+		pbrother = get_node((int)pparent->get_values(pos - 1));/*ֵܽڵ:ڵǰһڵ*/
+		if (pbrother->CanLend() && pnode->CanAbsorb())/*ֵܽڵһԪغ󲻻٣ǰ׺ѹʽ»Ҫpnodeŵ½ļpbrotherһԪpnode*/
 		{
 			if (pnode->is_leaf())/*pnodeΪҶӽڵ*/
 			{
 				for (int i = pnode->get_count(); i > 0; i--)/*pnodeÿһԪغ*/
 				{
-					pnode->set_keys(i, pnode->get_keys(i - 1));/*ָһҶӽڵĵַָblockͷҶӽڵkey=value*/
+					pnode->set_keys(i, pnode->get_keys(i - 1));/*Ҷӽڵkey=value*/
 					pnode->set_values(i, pnode->get_values(i - 1));
 				}
 				pnode->set_keys(0, pbrother->get_keys(pbrother->get_count() - 1));/*pbrotherһԪpnodeԪλ*/
@@ -176,8 +170,8 @@ bool BPlusTree::mergeForRemove(int node)
 				pnode->set_count(pnode->get_count() + 1);
 
 				pbrother->set_count(pbrother->get_count() - 1);
-				pparent->set_keys(pos - 1, pbrother->get_keys(pbrother->get_count() - 1));/*Ҷӽڵһkeyı仯øڵpbrotherpnodekeyΪpbrotherһԪصkeyַʽΪ<=  > */
-				return true;
+				TKey left = pbrother->get_keys(pbrother->get_count() - 1), right = pnode->get_keys(0);
+				pparent->set_keys(pos - 1, get_separator(left, right));/*Ҷӽڵһkeyı仯ڵpbrotherpnodekeyַʽΪ<=  > */
 			}
 			else
 			{
@@ -194,73 +188,64 @@ bool BPlusTree::mergeForRemove(int node)
 				pnode->set_values(0, pbrother->get_values(pbrother->get_count()));
 				pnode->set_count(pnode->get_count() + 1);
 
-				if (pbrother->get_values(pbrother->get_count()) >= 0)
-				{
-					get_node(pbrother->get_values(pbrother->get_count()))->set_parent(pnode->get_block_num());
-					pbrother->set_values(pbrother->get_count(), -1);
-				}
+				pbrother->set_values(pbrother->get_count(), -1);
 				pbrother->set_count(pbrother->get_count() - 1);
-				return true;
 			}
+			/*ǰ׺ѹʽµķָܱԭĳڵ˷Ų*/
+			if (pparent->IsOverflow()) return spiltForAdd(pparent->get_block_num());
+			return true;
 		}
-		else/*pnodeԪع٣ϲpbrother*/
+		else if (pnode->is_leaf() && can_merge(pbrother, pnode, NULL))/*pnodeԪع٣ϲpbrother*/
 		{
-			if (pnode->is_leaf())
-			{
-				pparent->remove(pos - 1);
-				pparent->set_values(pos - 1, pbrother->get_block_num());
-
-				for (int i = 0; i < pnode->get_count(); i++)
-				{
-					pbrother->set_keys(pbrother->get_count() + i, pnode->get_keys(i));
-					pbrother->set_values(pbrother->get_count() + i, pnode->get_values(i));
-					pnode->set_values(i, -1);
-				}
-				pbrother->set_count(pbrother->get_count() + pnode->get_count());
-				pbrother->set_next_leaf(pnode->get_next_leaf());
+			pparent->remove(pos - 1);
+			pparent->set_values(pos - 1, pbrother->get_block_num());
 
-				delete pnode;
-				idx_->DecreaseNodeCount();
-				return mergeForRemove(pparent->get_block_num());
-			}
-			else
+			for (int i = 0; i < pnode->get_count(); i++)
 			{
-				pbrother->set_keys(pbrother->get_count(), pparent->get_keys(pos - 1));
-				pbrother->set_count(pbrother->get_count() + 1);
-				pparent->remove(pos - 1);
-				pparent->set_values(pos - 1, pbrother->get_block_num());
+				pbrother->set_keys(pbrother->get_count() + i, pnode->get_keys(i));
+				pbrother->set_values(pbrother->get_count() + i, pnode->get_values(i));
+			}
+			pbrother->set_count(pbrother->get_count() + pnode->get_count());
+			pbrother->set_next_leaf(pnode->get_next_leaf());
+			if (pnode->get_next_leaf() != -1 && idx_->has_prev_links())
+				get_node(pnode->get_next_leaf())->set_prev_leaf(pbrother->get_block_num());
 
-				for (int i = 0; i < pnode->get_count(); i++)
-					pbrother->set_keys(pbrother->get_count() + i, pnode->get_keys(i));
+			free_node(pnode);
+			idx_->DecreaseNodeCount();
+			return mergeForRemove(pparent->get_block_num());
+		}
+		else if (!pnode->is_leaf() && can_merge(pbrother, pnode, &sep))
+		{
+			pbrother->set_keys(pbrother->get_count(), pparent->get_keys(pos - 1));
+			pbrother->set_count(pbrother->get_count() + 1);
+			pparent->remove(pos - 1);
+			pparent->set_values(pos - 1, pbrother->get_block_num());
 
-				for (int i = 0; i <= pnode->get_count(); i++)
-				{
-					pbrother->set_values(pbrother->get_count() + i, pnode->get_values(i));
-					get_node(pnode->get_values(i))->set_parent(pbrother->get_block_num());
-				}
-				pbrother->set_count(2 * idx_->get_rank());
+			for (int i = 0; i < pnode->get_count(); i++)
+				pbrother->set_keys(pbrother->get_count() + i, pnode->get_keys(i));
 
-				delete pnode;
-				idx_->DecreaseNodeCount();
-				return mergeForRemove(pparent->get_block_num());
-			}
+			for (int i = 0; i <= pnode->get_count(); i++)
+				pbrother->set_values(pbrother->get_count() + i, pnode->get_values(i));
+			pbrother->set_count(pbrother->get_count() + pnode->get_count());
+
+			free_node(pnode);
+			idx_->DecreaseNodeCount();
+			return mergeForRemove(pparent->get_block_num());
 		}
 	}
 	else/*pnodeǸڵһڵ㣬pnodeֵܽڵǺһڵ*/
 	{
-		pbrother = get_node(pparent->get_values(pos + 1));
-		if (pbrother->get_count() > idx_->get_rank())
+		pbrother = get_node((int)pparent->get_values(pos + 1));
+		if (pbrother->CanLend() && pnode->CanAbsorb())
 		{
 			if (pnode->is_leaf())
 			{
-				pparent->set_keys(pos, pbrother->get_keys(0));
 				pnode->set_keys(pnode->get_count(), pbrother->get_keys(0));
 				pnode->set_values(pnode->get_count(), pbrother->get_values(0));
-
-				pbrother->set_values(0, -1);
 				pnode->set_count(pnode->get_count() + 1);
 				pbrother->remove(0);
-				return true;
+				TKey left = pnode->get_keys(pnode->get_count() - 1), right = pbrother->get_keys(0);
+				pparent->set_keys(pos, get_separator(left, right));
 			}
 			else
 			{
@@ -268,266 +253,494 @@ bool BPlusTree::mergeForRemove(int node)
 				pnode->set_values(pnode->get_count() + 1, pbrother->get_values(0));
 				pnode->set_count(pnode->get_count() + 1);
 				pparent->set_keys(pos, pbrother->get_keys(0));
-				get_node(pbrother->get_values(0))->set_parent(pnode->get_block_num());
 
 				pbrother->remove(0);
-				return true;
 			}
+			if (pparent->IsOverflow()) return spiltForAdd(pparent->get_block_num());
+			return true;
 		}
-		else
+		else if (pnode->is_leaf() && can_merge(pnode, pbrother, NULL))
 		{
-			if (pnode->is_leaf())
+			for (int i = 0; i < pbrother->get_count(); i++)
 			{
-				for (int i = 0; i <idx_->get_rank(); i++)
-				{
-					pnode->set_keys(pnode->get_count() + i, pbrother->get_keys(i));
-					pnode->set_values(pnode->get_count() + i, pbrother->get_values(i));
-					pbrother->set_values(i, -1);
-				}
+				pnode->set_keys(pnode->get_count() + i, pbrother->get_keys(i));
+				pnode->set_values(pnode->get_count() + i, pbrother->get_values(i));
+			}
 
-				pnode->set_count(pnode->get_count() + idx_->get_rank());
-				delete pbrother;
-				idx_->DecreaseNodeCount();
+			pnode->set_count(pnode->get_count() + pbrother->get_count());
+			pnode->set_next_leaf(pbrother->get_next_leaf());/*pbrotherϲҪҶժΧɨɾԪ*/
+			if (pbrother->get_next_leaf() != -1 && idx_->has_prev_links())
+				get_node(pbrother->get_next_leaf())->set_prev_leaf(pnode->get_block_num());
+			free_node(pbrother);
+			idx_->DecreaseNodeCount();
 
-				pparent->remove(pos);
-				pparent->set_values(pos, pnode->get_block_num());
-				return mergeForRemove(pparent->get_block_num());
-			}
-			else
-			{
-				pnode->set_keys(pnode->get_count(), pparent->get_keys(pos));
-				pparent->remove(pos);
-				pparent->set_values(pos, pnode->get_block_num());
-				pnode->set_count(pnode->get_count() + 1);
+			pparent->remove(pos);
+			pparent->set_values(pos, pnode->get_block_num());
+			return mergeForRemove(pparent->get_block_num());
+		}
+		else if (!pnode->is_leaf() && can_merge(pnode, pbrother, &sep))
+		{
+			pnode->set_keys(pnode->get_count(), pparent->get_keys(pos));
+			pparent->remove(pos);
+			pparent->set_values(pos, pnode->get_block_num());
+			pnode->set_count(pnode->get_count() + 1);
 
-				for (int i = 0; i < idx_->get_rank(); i++)
-					pnode->set_keys(pnode->get_count() + i, pbrother->get_keys(i));
+			for (int i = 0; i < pbrother->get_count(); i++)
+				pnode->set_keys(pnode->get_count() + i, pbrother->get_keys(i));
 
-				for (int i = 0; i <= idx_->get_rank(); i++)
-				{
-					pnode->set_values(pnode->get_count() + i, pbrother->get_values(i));
-					get_node(pbrother->get_values(i))->set_parent(pnode->get_block_num());
-				}
+			for (int i = 0; i <= pbrother->get_count(); i++)
+				pnode->set_values(pnode->get_count() + i, pbrother->get_values(i));
 
-				pnode->set_count(pnode->get_count() + idx_->get_rank());
-				delete pbrother;
-				idx_->DecreaseNodeCount();
-				return mergeForRemove(pparent->get_block_num());
-			}
+			pnode->set_count(pnode->get_count() + pbrother->get_count());
+			free_node(pbrother);
+			idx_->DecreaseNodeCount();
+			return mergeForRemove(pparent->get_block_num());
 		}
 	}
+	return true;
 }
 
-/**ֱҶӽڵĲѯnodeʼkeyڵҶӽڵ㡣ans.flagtruekeyB+дڣfalsekeyB+в*/
-FindNodeParam BPlusTree::search(int node, TKey &key)
+/*ʽн費Ԫʱϲһŵ£ǰ׺ѹʽϲĹǰ׺볤*/
+bool BPlusTree::can_merge(BTNode *left, BTNode *right, TKey *sep)
 {
-	FindNodeParam ans;
-	int index = 0;
-	BTNode* pnode = get_node(node);
-	if (pnode->get_count() == 0 && pnode->is_leaf() == false) {
-		ans.flag = false;
-		ans.index = index;
-		ans.pnode = get_node(0);
-		return ans;
-	}
-	if (pnode->search(key, index))
+	if (idx_->get_node_format() == NODE_FORMAT_FIXED) return true;
+	int count = left->get_count() + right->get_count();
+	int bytes = left->GetKeyBytes() + right->GetKeyBytes();
+	int overhead = left->GetEntryOverhead();
+	if (sep != NULL)
 	{
-		if (pnode->is_leaf())
-		{
-			ans.flag = true;
-			ans.index = index;
-			ans.pnode = pnode;
-		}
-		else
-		{
-			pnode = get_node(pnode->get_values(index));
-			while (!pnode->is_leaf())
-			{
-				pnode = get_node(pnode->get_values(pnode->get_count()));
-			}
-			ans.flag = true;
-			ans.index = pnode->get_count() - 1;
-			ans.pnode = pnode;
-		}
+		count++;
+		bytes += sep->get_length();
 	}
-	else
+	TKey first = left->get_count() > 0 ? left->get_keys(0) : (sep != NULL ? *sep : right->get_keys(0));
+	TKey last = right->get_count() > 0 ? right->get_keys(right->get_count() - 1) : (sep != NULL ? *sep : left->get_keys(left->get_count() - 1));
+	int prefix_len = BTNode::CommonPrefix(first, last);
+	return NODE_HEADER_COMPACT + prefix_len + bytes + count * (overhead - prefix_len) <= 4 * 1024;
+}
+
+/*ʽȡߵǰ׺ѹʽȡleftһǰ׺ѵһܼһֽڼһ
+  leftΪleftrightһֽͬڴrightԱrightС*/
+TKey BPlusTree::get_separator(TKey &left, TKey &right)
+{
+	if (idx_->get_node_format() == NODE_FORMAT_FIXED) return left;
+	int common = BTNode::CommonPrefix(left, right);
+	for (int k = common; k < left.get_length() - 1; k++)
 	{
-		if (pnode->is_leaf())
-		{
-			ans.flag = false;
-			ans.index = index;
-			ans.pnode = pnode;
-		}
-		else
-		{
-			return search(pnode->get_values(index), key);
-		}
+		unsigned char c = (unsigned char)left.get_key()[k];
+		if (c == 0xff) continue;
+		if (k == common && c + 1 >= (unsigned char)right.get_key()[k]) continue;
+		TKey sep(T_BINARY, k + 1);
+		memcpy(sep.get_key(), left.get_key(), k);
+		sep.get_key()[k] = (char)(c + 1);
+		return sep;
 	}
-	return ans;
+	return left;
 }
-/*ɾڵʱڲڵ仯ĲѯnodeʼѯkeyڵpnodeindexFindNodeParamеflagtruepnodeΪҶӽڵ㣻falsepnodeΪڲڵ*/
-FindNodeParam BPlusTree::search_pos(int node, TKey &key)
+
+/**ֱҶӽڵĲѯnodeʼkeyڵҶӽڵ㡣ans.flagtruekeyB+дڣfalsekeyB+в*/
+FindNodeParam BPlusTree::search(int node, TKey &key)
 {
 	FindNodeParam ans;
 	int index = 0;
+	path_.assign(1, node);
 	BTNode* pnode = get_node(node);
-
-	if (pnode->is_leaf()) throw BPlusTreeException();
-	if (pnode->search(key, index))
+	while (!pnode->is_leaf())
 	{
-		ans.flag = true;
-		ans.index = index;
-		ans.pnode = pnode;
+		pnode->search(key, index);
+		path_.push_back((int)pnode->get_values(index));
+		pnode = get_node(path_.back());
 	}
-	else
+	ans.flag = pnode->search(key, index);
+	ans.index = index;
+	ans.pnode = pnode;
+	return ans;
+}
+void BPlusTree::change_key_count(int delta)
+{
+	if (delta > 0) idx_->IncreaseKeyCount();
+	else idx_->DecreaseKeyCount();
+	header_dirty_ = true;
+}
+
+int BPlusTree::parent_of(int node)
+{
+	for (unsigned int i = 1; i < path_.size(); i++)
 	{
-		if (!get_node(pnode->get_values(index))->is_leaf())
-			ans = search_pos(pnode->get_values(index), key);
-		else
-		{
-			ans.flag = false;
-			ans.index = index;
-			ans.pnode = pnode;
-		}
+		if (path_[i] == node) return path_[i - 1];
 	}
-	return ans;
+	if (path_.empty() || path_[0] != node) throw BPlusTreeException();
+	return -1;
 }
-/*ȡnumڵ㡣ʵַȡļϵͳеnum飬ÿеdata_ݼΪýڵ*/
+
+/*ȡnumڵ㡣һβͬһֻһΣ֮󷵻ػĽڵ*/
 BTNode* BPlusTree::get_node(int num)
 {
+	map<int, BTNode*>::iterator it = nodes_.find(num);
+	if (it != nodes_.end()) return it->second;
 	BTNode* pnode = new BTNode(this, false, num);
+	nodes_[num] = pnode;
 	return pnode;
 }
+/*һ¿Ϊսڵ*/
+BTNode* BPlusTree::new_node(bool leaf)
+{
+	BTNode* pnode = new BTNode(this, true, get_new_blocknum(), leaf);
+	nodes_[pnode->get_block_num()] = pnode;
+	return pnode;
+}
+/*ڵ㱻ϲҵпͷ*/
+void BPlusTree::free_node(BTNode* pnode)
+{
+	int block = pnode->get_block_num();
+	nodes_.erase(block);
+	delete pnode;
+	set_free(block, idx_->get_rubbish());
+	idx_->set_rubbish(block);
+	header_dirty_ = true;
+}
+
+int BPlusTree::get_next_free(int block)
+{
+	BlockInfo *bp = buffer_m_->GetFileBlock(db_name_, idx_->get_name(), FORMAT_INDEX, block);
+	char *buffer = bp->get_data();
+	if (*((int*)(&buffer[0])) != NODE_FREE) throw BPlusTreeException();/*еĿ鲻ǿп飬ļ*/
+	return *((int*)(&buffer[12]));
+}
+
+void BPlusTree::set_free(int block, int next)
+{
+	BlockInfo *bp = buffer_m_->GetFileBlock(db_name_, idx_->get_name(), FORMAT_INDEX, block);
+	bp->set_dirty(true);
+	char *buffer = bp->get_data();
+	*((int*)(&buffer[0])) = NODE_FREE;
+	*((int*)(&buffer[4])) = 0;
+	*((int*)(&buffer[8])) = -1;
+	*((int*)(&buffer[12])) = next;
+}
+/*޸ĹĽڵдػ飬սڵ㻺*/
+void BPlusTree::flush()
+{
+	map<int, BTNode*> nodes;
+	nodes.swap(nodes_);/*дʱ׳쳣ĻٴflushظͷŽڵ*/
+	for (map<int, BTNode*>::iterator it = nodes.begin(); it != nodes.end(); it++)
+	{
+		if (it->second->is_dirty()) it->second->Write();
+		delete it->second;
+	}
+	if (header_dirty_)
+	{
+		IndexHeader::Store(idx_, buffer_m_, db_name_);
+		header_dirty_ = false;
+	}
+}
 /*keyѯvalueֵ*/
-int BPlusTree::get_value(TKey key)
+RID BPlusTree::get_value(TKey key)
 {
-	int ans = -1;
+	RID ans = -1;
 	if (idx_->get_root() != -1) {	/*Ϊʱձֵ쳣*/
 		FindNodeParam fnp = search(idx_->get_root(), key);
 		if (fnp.flag)
 			ans = fnp.pnode->get_values(fnp.index);
 	}
+	flush();
 	return ans;
 }
 
-/*keyѯvalueֵֵֵ֧ѯ뷶Χѯop_typeжǷΪΧѯ*/
-vector<int> BPlusTree::get_value(TKey key, int op_type, string & searchType)
+/*ɸڵ½һ>=keyԪڵҶӽڵ㡣ڲڵiеļ<=iÿȡһ>=keyļӦĺ*/
+FindNodeParam BPlusTree::search_leaf(TKey &key)
 {
-	vector<int> ans;
-	if (idx_->get_root() != -1) {	/*Ϊʱձֵ쳣*/
-		FindNodeParam fnp = search(idx_->get_root(), key);
+	return search(idx_->get_root(), key);
+}
+
+/*Χɨ裺½ڵҶӿʼҶҶֱԽϽlimitһҶӾսڵ㻺*/
+vector<RID> BPlusTree::get_range(TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys, int limit)
+{
+	vector<RID> ans;
+	if (idx_->get_root() == -1 || limit == 0) return ans;
+
+	BTNode *pnode;
+	int index = 0;
+	if (low != NULL)
+	{
+		FindNodeParam fnp = search_leaf(*low);
+		pnode = fnp.pnode;
+		index = fnp.index;
+	}
+	else pnode = get_node(idx_->get_leaf_head());
 
-		BTNode * temp = new BTNode(*fnp.pnode);
-		BTNode * firstNode = new BTNode(*get_node(idx_->get_leaf_head()));//ȡҶͷڵϢ
-		int index = fnp.index;
-		switch (op_type)
+	while (true)
+	{
+		for (; index < pnode->get_count(); index++)
 		{
-		case SIGN_EQ:
-			if (fnp.flag) {
-				ans.push_back(fnp.pnode->get_values(fnp.index));
-			}
-			break;
-		case SIGN_GT://>	
-			if (!fnp.flag&&fnp.pnode->get_keys(fnp.pnode->get_count() - 1) <= key) {//ֹԣid(1)>0ԸýڵֵҲ<=keyʱýڵЧ
-				break;
-			}
-			searchType = "B+ķΧѯ";
-			//ڵЧ¼				
-			while (index < (*temp).get_count()) {
-				ans.push_back(temp->get_values(index));
-				index++;
-			}
-			//ڵЧ¼
-			while ((*temp).get_next_leaf() != -1) {
-				temp = get_node((*temp).get_next_leaf());
-				index = 0;
-				while (index < (*temp).get_count()) {
-					ans.push_back(temp->get_values(index));
-					index++;
-				}
-			}
-			break;
-		case SIGN_LT://<	
-			if (!fnp.flag&&fnp.pnode->get_keys(0) >= key) {
-				break;
-			}
-			searchType = "B+ķΧѯ";
-			//ǰڵ㵽ǰڵĵǰλõЧ¼
-
-			while ((*firstNode).get_block_num() != (*temp).get_next_leaf()) {
-				int idx = 0;
-				bool flag = true;
-				while (idx < (*firstNode).get_count()) {
-					if ((*firstNode).get_block_num() == (*temp).get_block_num() && idx == index)//ǰĵǰKVʱֹͣ
-					{
-						flag = false;
-						break;
-					}
-					ans.push_back(firstNode->get_values(idx));
-					idx++;
-				}
-				if (!flag)
-					break;
-				firstNode = get_node((*firstNode).get_next_leaf());//һҶӽڵ
+			TKey key = pnode->get_keys(index);
+			if (low != NULL && !low_eq && key == *low) continue;
+			if (high != NULL && (key > *high || (!high_eq && key == *high)))
+			{
+				flush();
+				return ans;
 			}
-			break;
-		case SIGN_GE://>=
-			if (!fnp.flag&&fnp.pnode->get_keys(fnp.pnode->get_count() - 1) < key) {
-				break;
+			ans.push_back(pnode->get_values(index));
+			if (keys != NULL) keys->push_back(key);
+			if (limit > 0 && (int)ans.size() == limit)
+			{
+				flush();
+				return ans;
 			}
-			searchType = "B+ķΧѯ";
-			ans.push_back(fnp.pnode->get_values(fnp.index));//=
-															//ڵЧ¼				
-			while (++index < (*temp).get_count()) {
-				ans.push_back(temp->get_values(index));
+		}
+		int next = pnode->get_next_leaf();
+		flush();
+		if (next == -1) break;
+		pnode = get_node(next);
+		index = 0;
+	}
+	return ans;
+}
+
+/*Χɨ裺ϽڵҶӣϽʱΪҵҶӣʼһҶֱԽ½limit
+  ϽڵҶΪһ>=highļڵҶӣ<=highļߡ
+  ûһҶӵľ˳ɨ󵹹*/
+vector<RID> BPlusTree::get_range_reverse(TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys, int limit)
+{
+	vector<RID> ans;
+	if (!idx_->has_prev_links())
+	{
+		vector<TKey> found;
+		ans = get_range(low, low_eq, high, high_eq, &found);
+		reverse(ans.begin(), ans.end());
+		reverse(found.begin(), found.end());
+		if (limit >= 0 && (int)ans.size() > limit)
+		{
+			ans.resize(limit);
+			found.erase(found.begin() + limit, found.end());
+		}
+		if (keys != NULL) keys->insert(keys->end(), found.begin(), found.end());
+		return ans;
+	}
+	if (idx_->get_root() == -1 || limit == 0) return ans;
+
+	BTNode *pnode;
+	if (high != NULL) pnode = search_leaf(*high).pnode;
+	else
+	{
+		pnode = get_node(idx_->get_root());
+		while (!pnode->is_leaf())
+			pnode = get_node((int)pnode->get_values(pnode->get_count()));
+	}
+	int index = pnode->get_count() - 1;
+
+	while (true)
+	{
+		for (; index >= 0; index--)
+		{
+			TKey key = pnode->get_keys(index);
+			if (high != NULL && (key > *high || (!high_eq && key == *high))) continue;
+			if (low != NULL && (key < *low || (!low_eq && key == *low)))
+			{
+				flush();
+				return ans;
 			}
-			//ڵЧ¼
-			while ((*temp).get_next_leaf() != -1) {
-				temp = get_node((*temp).get_next_leaf());
-				index = 0;
-				while (index < (*temp).get_count()) {
-					ans.push_back(temp->get_values(index));
-					index++;
-				}
+			ans.push_back(pnode->get_values(index));
+			if (keys != NULL) keys->push_back(key);
+			if (limit > 0 && (int)ans.size() == limit)
+			{
+				flush();
+				return ans;
 			}
-			break;
-		case SIGN_LE://<=
-			if (!fnp.flag&&fnp.pnode->get_keys(0) > key) {
-				break;
+		}
+		int prev = pnode->get_prev_leaf();
+		flush();
+		if (prev == -1) break;
+		pnode = get_node(prev);
+		index = pnode->get_count() - 1;
+	}
+	return ans;
+}
+
+/*ҶÿҶӵһҶӿţ֮ķϲά*/
+void BPlusTree::link_prev_leaves()
+{
+	if (idx_->has_prev_links() || !idx_->has_header()) return;
+	int prev = -1;
+	for (int num = idx_->get_leaf_head(); num != -1;)
+	{
+		BTNode *pnode = get_node(num);
+		pnode->set_prev_leaf(prev);
+		prev = num;
+		num = pnode->get_next_leaf();
+		flush();
+	}
+	idx_->set_prev_links(true);
+	header_dirty_ = true;
+}
+
+/*ÿ¸ڵĿżеСһ֮ķָߵұߵСõget_separator
+  ڵ㰴˳BULK_FILL_PERCENTͻһÿһڵܹ٣ߵֵܽԪز*/
+void BPlusTree::bulk_load(vector<pair<TKey, RID> >& entries)
+{
+	if (idx_->get_root() != -1 || entries.empty()) return;
+	vector<int> blocks;
+	vector<TKey> firsts, lasts;
+	int key_count = 0;
+
+	/*ҶӲ㣺ͬԪֻһʱһ*/
+	BTNode *pnode = new_node(true);
+	blocks.push_back(pnode->get_block_num());
+	firsts.push_back(entries[0].first);
+	for (unsigned int i = 0; i < entries.size(); i++)
+	{
+		if (i > 0 && entries[i].first == entries[i - 1].first) continue;
+		if (!append_entry(pnode, entries[i].first, entries[i].second))
+		{
+			BTNode *next = new_node(true);
+			pnode->set_next_leaf(next->get_block_num());
+			next->set_prev_leaf(pnode->get_block_num());
+			lasts.push_back(pnode->get_keys(pnode->get_count() - 1));
+			write_node(pnode);
+			pnode = next;
+			blocks.push_back(pnode->get_block_num());
+			firsts.push_back(entries[i].first);
+			append_entry(pnode, entries[i].first, entries[i].second);
+		}
+		key_count++;
+	}
+	lasts.push_back(pnode->get_keys(pnode->get_count() - 1));
+	write_node(pnode);
+	int n = blocks.size();
+	if (n > 1)
+	{
+		BTNode *left = get_node(blocks[n - 2]), *right = get_node(blocks[n - 1]);
+		while (right->IsUnderflow() && left->CanLend())
+		{
+			int last = left->get_count() - 1;
+			TKey key = left->get_keys(last);
+			RID val = left->get_values(last);
+			left->set_count(last);
+			right->add(key, val);
+		}
+		lasts[n - 2] = left->get_keys(left->get_count() - 1);
+		firsts[n - 1] = right->get_keys(0);
+		flush();
+	}
+	idx_->set_leaf_head(blocks[0]);
+	int node_count = n, level = 1;
+
+	/*ڲڵ㣺startsΪÿڵĵһһеλ*/
+	while (blocks.size() > 1)
+	{
+		vector<int> up_blocks, starts;
+		vector<TKey> up_firsts, up_lasts;
+		pnode = NULL;
+		for (unsigned int i = 0; i < blocks.size(); i++)
+		{
+			if (pnode != NULL)
+			{
+				TKey sep = get_separator(lasts[i - 1], firsts[i]);
+				if (append_entry(pnode, sep, blocks[i])) continue;
+				up_lasts.push_back(lasts[i - 1]);
+				write_node(pnode);
 			}
-			searchType = "B+ķΧѯ";
-			//ǰڵ㵽ǰڵĵǰλõЧ¼
-
-			while ((*firstNode).get_block_num() != (*temp).get_next_leaf()) {
-				int idx = 0;
-				bool flag = true;
-				while (idx < (*firstNode).get_count()) {
-					if ((*firstNode).get_block_num() == (*temp).get_block_num() && idx == index)
-					{
-						ans.push_back(fnp.pnode->get_values(fnp.index));//=
-						flag = false;
-						break;
-					}
-					ans.push_back(firstNode->get_values(idx));
-					idx++;
-				}
-				if (!flag)
-					break;
-				firstNode = get_node((*firstNode).get_next_leaf());//һҶӽڵ
+			pnode = new_node(false);
+			pnode->set_values(0, blocks[i]);
+			up_blocks.push_back(pnode->get_block_num());
+			up_firsts.push_back(firsts[i]);
+			starts.push_back(i);
+		}
+		up_lasts.push_back(lasts.back());
+		write_node(pnode);
+		int m = up_blocks.size();
+		if (m > 1)
+		{
+			/*һڵҪӣֵܵһƵǰ*/
+			BTNode *left = get_node(up_blocks[m - 2]), *right = get_node(up_blocks[m - 1]);
+			int start = starts[m - 1];
+			while (right->get_count() == 0 || (right->IsUnderflow() && left->CanLend()))
+			{
+				TKey sep = get_separator(lasts[start - 1], firsts[start]);
+				int count = right->get_count();
+				for (int k = count; k > 0; k--)
+					right->set_keys(k, right->get_keys(k - 1));
+				for (int k = count + 1; k > 0; k--)
+					right->set_values(k, right->get_values(k - 1));
+				right->set_keys(0, sep);
+				right->set_values(0, blocks[start - 1]);
+				right->set_count(count + 1);
+				left->set_count(left->get_count() - 1);
+				start--;
 			}
-			break;
-		default:
-			break;
+			up_lasts[m - 2] = lasts[start - 1];
+			up_firsts[m - 1] = firsts[start];
+			flush();
 		}
+		blocks.swap(up_blocks);
+		firsts.swap(up_firsts);
+		lasts.swap(up_lasts);
+		node_count += m;
+		level++;
+	}
+	idx_->set_root(blocks[0]);
+	idx_->set_key_count(key_count);
+	idx_->set_node_count(node_count);
+	idx_->set_level(level);
+	header_dirty_ = true;
+	flush();
+}
 
+bool BPlusTree::append_entry(BTNode *pnode, TKey &key, RID val)
+{
+	int n = pnode->get_count();
+	pnode->set_keys(n, key);
+	pnode->set_values(pnode->is_leaf() ? n : n + 1, val);
+	pnode->set_count(n + 1);
+	bool full = idx_->get_node_format() == NODE_FORMAT_FIXED ? (n + 1) * 100 > (degree_ - 1) * BULK_FILL_PERCENT
+		: pnode->GetSize() * 100 > 4 * 1024 * BULK_FILL_PERCENT;
+	if (n == 0 || !full) return true;
+	pnode->set_count(n);
+	return false;
+}
 
-	}
-	return ans;
+void BPlusTree::write_node(BTNode *pnode)
+{
+	pnode->Write();
+	nodes_.erase(pnode->get_block_num());
+	delete pnode;
 }
+
 /*ȡblockţidx_ֵһ*/
 int BPlusTree::get_new_blocknum()
 {
-	return idx_->IncreaseMaxCount();
+	header_dirty_ = true;
+	int block = idx_->get_rubbish();
+	if (block == -1) return idx_->IncreaseMaxCount();
+	idx_->set_rubbish(get_next_free(block));
+	return block;
+}
+
+/*ļĩβĿпصп鰴ԭ˳´*/
+int BPlusTree::vacuum()
+{
+	vector<int> free_blocks;
+	for (int block = idx_->get_rubbish(); block != -1; block = get_next_free(block))
+	{
+		if (free_blocks.size() >= (unsigned int)idx_->get_max_count()) throw BPlusTreeException();/*л*/
+		free_blocks.push_back(block);
+	}
+	set<int> free_set(free_blocks.begin(), free_blocks.end());
+	int count = idx_->get_max_count();
+	while (count > 0 && free_set.count(count - 1)) count--;
+	int reclaimed = idx_->get_max_count() - count;
+	if (reclaimed == 0) return 0;
+
+	int head = -1;
+	for (int i = (int)free_blocks.size() - 1; i >= 0; i--)
+	{
+		if (free_blocks[i] >= count) continue;
+		set_free(free_blocks[i], head);
+		head = free_blocks[i];
+	}
+	idx_->set_rubbish(head);
+	idx_->set_max_count(count);
+	header_dirty_ = true;
+	return reclaimed;
 }
 
 void BPlusTree::print()
@@ -537,6 +750,7 @@ void BPlusTree::print()
 
 	if (idx_->get_root() != -1)
 		print_node(idx_->get_root());
+	flush();
 }
 /**ӡڵϢ*/
 void BPlusTree::print_node(int num)
@@ -545,7 +759,7 @@ void BPlusTree::print_node(int num)
 	pnode->print();
 	if (!pnode->is_leaf())
 	{
-		for (int i = 0; i <= pnode->get_count(); ++i)
-			print_node(pnode->get_values(i));
+		for (int i = 0; i <= pnode->get_count(); i++)
+			print_node((int)pnode->get_values(i));
 	}
 }
@@ -7,13 +7,18 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <set>
 
 #include "BTNode.h"
 #include "CatalogManager.h"
 #include "BufferManager.h"
+#include "ConstValue.h"
 
 using namespace std;
 
+#define BULK_FILL_PERCENT 90	/*ʱڵޣռİٷֱȣĿռ֮Ĳ룬һͷ*/
+
 class BPlusTree;		/*B+*/
 class BTNode;
 
@@ -37,18 +42,26 @@ public:
 	string get_db_name();									/*ȡB+ݿ*/
 
 	bool add(TKey& key, int block_num, int offset);			/*ڵblock_numϼԪkey ƫoffset*/
-	bool spiltForAdd(int node);							/*ԪغB+*/
+	bool spiltForAdd(int node);							/*ԪغB+nodeʱѣ½·ϲָ*/
 
 	bool remove(TKey key);									/*ƳkeyԪ*/
 	bool mergeForRemove(int node);						/*ɾԪغB+*/
 
-	FindNodeParam search(int node, TKey &key);				/*ֱҶӽڵĲѯnodeʼkeyڵҶӽڵ㡣ans.flagtruekeyB+дڣfalsekeyB+в*/
-	FindNodeParam search_pos(int node, TKey &key);		/*ɾڵʱڲڵ仯ĲѯnodeʼѯkeyڵpnodeindexFindNodeParamеflagtruepnodeΪҶӽڵ㣻falsepnodeΪڲڵ*/
-	BTNode* get_node(int num);						/*ȡnumڵ㡣ʵַȡļϵͳеnum飬ÿеdata_ݼΪýڵ*/
+	FindNodeParam search(int node, TKey &key);				/*ֱҶӽڵĲѯnodeʼkeyڵҶӽڵ㣬Ľڵpath_Сans.flagtruekeyB+дڣfalsekeyB+в*/
+	BTNode* get_node(int num);						/*ȡnumڵ㡣һβͬһֻһΣ֮󷵻ػĽڵ*/
+	BTNode* new_node(bool leaf);						/*һ¿Ϊսڵ*/
+	void free_node(BTNode* pnode);					/*ڵ㱻ϲҵпͷ*/
+	void flush();									/*޸ĹĽڵдػ飬սڵ㻺*/
+	TKey get_separator(TKey &left, TKey &right);		/*ҶʱƵķָsleft <= s < rightǰ׺ѹʽȡĽ϶̵ļ׺ضϣ*/
 
-	int get_value(TKey key);									/*keyѯvalueֵ*/
-	vector<int> get_value(TKey key, int op_type, string &searchType);		/*keyѯvalueֵop_typeжǷΪΧѯ*/
-	int get_new_blocknum();									/*idx_ֵһ*/
+	RID get_value(TKey key);									/*keyѯvalueֵ*/
+	FindNodeParam search_leaf(TKey &key);					/*ɸڵ½һ>=keyԪڵҶӽڵ㣬ans.indexΪҶеλãܵcountʾӦһҶӿʼ*/
+	vector<RID> get_range(TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys = NULL, int limit = -1);	/*Χɨ裺lowhigh֮Ԫصvaluelow/highΪNULLʾö޽磬low_eq/high_eqʾǷ˵㣻keysΪNULLʱͬʱЩԪصļlimit>=0ʱ෵limit*/
+	vector<RID> get_range_reverse(TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys = NULL, int limit = -1);	/*Χɨ裺ͬget_rangeӴС*/
+	void bulk_load(vector<pair<TKey, RID> >& entries);		/*ɰźԪԵϽҶӣÿڵļΧ㽨һ㡣ֻڿûʱ*/
+	void link_prev_leaves();								/*ûһҶӿŵľϣûʱ*/
+	int get_new_blocknum();									/*һ飺пʱȡͷidx_ֵһ*/
+	int vacuum();											/*ļĩβĿпժ²СֵػյĿûʱ*/
 
 	void print();
 	void print_node(int num);
@@ -59,7 +72,17 @@ private:
 	BufferManager *buffer_m_;								/*ָ*/
 	CatalogManager *catalog_m_;								/*Ŀ¼ָ*/
 	string db_name_;										/*B+db*/
+	map<int, BTNode*> nodes_;								/*βõĽڵ㣬->ڵ*/
+	vector<int> path_;										/*βɸ½ҶӾĽڵţϲҸڵ*/
+	int parent_of(int node);								/*node½·ϵĸڵ㣬nodeΪʱ-1*/
+	bool can_merge(BTNode *left, BTNode *right, TKey *sep);	/*ֵܽڵ㣨ڲڵ㻹ҪϸڵеķָsepϲܷŽһ*/
 	void InitTree();										/*ʼڵ㣬ʼidx*/
+	void change_key_count(int delta);						/*delta*/
+	bool header_dirty_;										/*βԪݣflushʱдͷ*/
+	bool append_entry(BTNode *pnode, TKey &key, RID val);	/*keyvalڽڵĩβڲڵvalΪkeyұߵĺӣʱfalse*/
+	void write_node(BTNode *pnode);							/*ڵѽãдػ鲢ӽڵ㻺ȥ*/
+	int get_next_free(int block);							/*пblockеһ*/
+	void set_free(int block, int next);						/*blockдɿп飬һΪnext*/
 };
 
 #endif
\ No newline at end of file
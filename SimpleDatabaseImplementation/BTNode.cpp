@@ -3,146 +3,260 @@
 //ãʵB+
 #include <iomanip>
 #include<iostream>
+#include <algorithm>
 #include "BTNode.h"
 #include "Exceptions.h"
 #include "ConstValue.h"
 
 using namespace std;
 
+#define NODE_UNDERFLOW_SIZE (4 * 1024 / 3)		/*ǰ׺ѹʽĽڵСڸֽʱҪֵܽϲ*/
+
 BTNode::BTNode(BPlusTree* tree, bool isnew, int blocknum, bool newleaf)
 {
 	tree_ = tree;
-	is_leaf_ = newleaf;
 	rank_ = (tree_->get_degree() - 1) / 2;
 	block_num_ = blocknum;
-	get_buffer();
 	if (isnew)
 	{
-		set_parent(-1);
-		set_node_type(newleaf ? 1 : 0);
-		set_count(0);
+		node_type_ = newleaf ? 1 : 0;
+		count_ = 0;
+		next_leaf_ = -1;
+		prev_leaf_ = -1;
+		dirty_ = true;
 	}
+	else Read();
 }
 
 BTNode::~BTNode() {}
 
 int BTNode::get_block_num() { return block_num_; }
 /*ȡindexkeyֵ*/
-TKey BTNode::get_keys(int index)
-{
-	TKey k(tree_->GetIndex()->get_key_type(), tree_->GetIndex()->get_key_len());
-	int base = 12;
-	int lenr = 4 + tree_->GetIndex()->get_key_len();
-	memcpy(k.get_key(), &buffer_[base + index * lenr + 4], tree_->GetIndex()->get_key_len());
-	return k;
-}
+TKey BTNode::get_keys(int index) { return keys_[index]; }
 /*ȡindexvalueֵ*/
-int BTNode::get_values(int index)
-{
-	int base = 12;
-	int lenR = 4 + tree_->GetIndex()->get_key_len();
-	return *((int*)(&buffer_[base + index*lenR]));
-}
+RID BTNode::get_values(int index) { return index < (int)values_.size() ? values_[index] : -1; }
 /*ȡһҶӽڵ*/
-int BTNode::get_next_leaf()
-{
-	int base = 12;
-	int lenR = 4 + tree_->GetIndex()->get_key_len();
-	return *((int*)(&buffer_[base + tree_->get_degree()*lenR]));
-}
-/*ȡһڵ㣬õǸýڵbufferеĵַţǸýڵڵbufferĵ8-11ֽ*/
-int BTNode::get_parent() { return *((int*)(&buffer_[8])); }
-/*ȡڵͣýڵbufferеĵ0-3ֽ*/
-int BTNode::get_node_type() { return *((int*)(&buffer_[0])); }
-/*ȡڵݸýڵbufferеĵ4-7ֽ*/
-int BTNode::get_count() { return *((int*)(&buffer_[4])); }
+int BTNode::get_next_leaf() { return next_leaf_; }
+/*ȡһҶӽڵ*/
+int BTNode::get_prev_leaf() { return prev_leaf_; }
+/*ȡڵ*/
+int BTNode::get_node_type() { return node_type_; }
+/*ȡڵݸ*/
+int BTNode::get_count() { return count_; }
 /*жǷҶӽڵ*/
-bool BTNode::is_leaf() { return get_node_type() == 1; }
-/*key.key_ýڵĵindex*/
+bool BTNode::is_leaf() { return node_type_ == 1; }
+/*keyýڵĵindexСԱcount_count_֮λļһֻݴ*/
 void BTNode::set_keys(int index, TKey key)
 {
-	int base = 12;
-	int lenr = 4 + tree_->GetIndex()->get_key_len();
-	memcpy(&buffer_[base + index*lenr + 4], key.get_key(), tree_->GetIndex()->get_key_len());
+	if (index >= (int)keys_.size()) keys_.resize(index + 1, key);
+	else keys_[index] = key;
+	dirty_ = true;
 }
 /*õindexԪصֵΪval*/
-void BTNode::set_values(int index, int val)
+void BTNode::set_values(int index, RID val)
 {
-	int base = 12;
-	int lenr = 4 + tree_->GetIndex()->get_key_len();
-	*((int*)(&buffer_[base + index*lenr])) = val;
+	if (index >= (int)values_.size()) values_.resize(index + 1, -1);
+	values_[index] = val;
+	dirty_ = true;
 }
 /*һҶӽڵֵ*/
-void BTNode::set_next_leaf(int val)
-{
-	int base = 12;
-	int len = 4 + tree_->GetIndex()->get_key_len();
-	*((int*)(&buffer_[base + tree_->get_degree() * len])) = val;/*øýڵһvalueΪָһҶӽڵָ롣degreeڵĶȣýڵԷŵKV*/
-}
-/*øڵֵ*/
-void BTNode::set_parent(int val) { *((int*)(&buffer_[8])) = val; }
+void BTNode::set_next_leaf(int val) { next_leaf_ = val; dirty_ = true; }
+/*һҶӽڵֵ*/
+void BTNode::set_prev_leaf(int val) { prev_leaf_ = val; dirty_ = true; }
 /*ڵͣҶӽڵΪ1ҶӽڵΪ0*/
-void BTNode::set_node_type(int val) { *((int*)(&buffer_[0])) = val; }
+void BTNode::set_node_type(int val) { node_type_ = val; dirty_ = true; }
 /*ýڵ洢Ԫظ*/
-void BTNode::set_count(int val) { *((int*)(&buffer_[4])) = val; }
+void BTNode::set_count(int val) { count_ = val; dirty_ = true; }
 /*ýڵǷΪҶӽڵ*/
 void BTNode::set_is_leaf(bool val) { set_node_type(val ? 1 : 0); }
-/*fileлȡǰB+ڵdbеǰļ*/
-void BTNode::get_buffer()
+
+/*¼ַlenֽڴţ4ֽڵľint*/
+static RID ReadRID(char *p, int len)
 {
-	BlockInfo *bp = tree_->GetBufferManager()->GetFileBlock(tree_->get_db_name(), tree_->GetIndex()->get_name(), FORMAT_INDEX, block_num_);
-	buffer_ = bp->get_data();
-	bp->set_dirty(true);
+	if (len == 4) return *((int*)p);
+	RID val;
+	memcpy(&val, p, sizeof(RID));
+	return val;
 }
-/*B+keyڵλãֵindexСֵtrueindexΪkeyλĽڵַfalseindexΪָһָ롣ڵԪظ20ڣ˳ң20⣬ֲ*/
-bool BTNode::search(TKey key, int &index)
+
+static void WriteRID(char *p, RID val, int len)
 {
-	bool ans = false;
-	if (get_count() == 0) { index = 0; return false; }
-	if (get_keys(0) > key) { index = 0;  return false; }
-	if (get_keys(get_count() - 1) < key) { index = get_count(); return false; }
-	if (get_count() > 20)										/* ֲ */
+	if (len == 4) *((int*)p) = (int)val;
+	else memcpy(p, &val, sizeof(RID));
+}
+
+/*fileлȡǰB+ڵdbеǰļ飬ڵʽ*/
+void BTNode::Read()
+{
+	Index *idx = tree_->GetIndex();
+	BlockInfo *bp = tree_->GetBufferManager()->GetFileBlock(tree_->get_db_name(), idx->get_name(), FORMAT_INDEX, block_num_);
+	char *buffer = bp->get_data();
+	node_type_ = *((int*)(&buffer[0]));
+	count_ = *((int*)(&buffer[4]));
+	prev_leaf_ = is_leaf() ? *((int*)(&buffer[8])) : -1;
+	keys_.clear();
+	values_.clear();
+	if (idx->get_node_format() == NODE_FORMAT_FIXED)
+	{
+		int vlen = idx->get_rid_len();
+		int lenr = vlen + idx->get_key_len();
+		for (int i = 0; i < count_; i++)
+		{
+			TKey k(idx->get_key_type(), idx->get_key_len());
+			memcpy(k.get_key(), &buffer[12 + i * lenr + vlen], idx->get_key_len());
+			keys_.push_back(k);
+			values_.push_back(ReadRID(&buffer[12 + i * lenr], vlen));
+		}
+		if (is_leaf()) next_leaf_ = (int)ReadRID(&buffer[12 + tree_->get_degree() * lenr], vlen);
+		else
+		{
+			values_.push_back(ReadRID(&buffer[12 + count_ * lenr], vlen));
+			next_leaf_ = -1;
+		}
+	}
+	else
 	{
-		int mid, start, end;
-		start = 0;
-		end = get_count() - 1;
-		while (start < end)
+		next_leaf_ = *((int*)(&buffer[12]));
+		int prefix_len = *((unsigned short*)(&buffer[16]));
+		int vlen = GetEntryOverhead() - 2;
+		char *prefix = &buffer[NODE_HEADER_COMPACT];
+		char *p = prefix + prefix_len;
+		for (int i = 0; i < count_; i++)
 		{
-			mid = (start + end) / 2;
-			if (key == get_keys(mid)) { index = mid; return true; }
-			else if (key < get_keys(mid)) end = mid;
-			else start = mid;
+			int suffix_len = *((unsigned short*)(p + vlen));
+			TKey k(T_BINARY, prefix_len + suffix_len);
+			memcpy(k.get_key(), prefix, prefix_len);
+			memcpy(k.get_key() + prefix_len, p + vlen + 2, suffix_len);
+			keys_.push_back(k);
+			values_.push_back(ReadRID(p, vlen));
+			p += vlen + 2 + suffix_len;
+		}
+		if (!is_leaf())
+		{
+			values_.push_back(next_leaf_);
+			next_leaf_ = -1;
+		}
+	}
+	dirty_ = false;
+}
 
-			if (start == end - 1)
-			{
-				if (key == get_keys(start)) { index = start; return true; }
-				if (key == get_keys(end)) { index = end; return true; }
-				if (key < get_keys(start)) { index = start; return false; }
-				if (key < get_keys(end)) { index = end; return false; }
-				if (key > get_keys(end)) { index = end + 1; return false; }
-			}
+/*ڵʽдļ顣¿ļĩβ֮⣬ͷȫд*/
+void BTNode::Write()
+{
+	Index *idx = tree_->GetIndex();
+	if (IsOverflow() && idx->get_node_format() == NODE_FORMAT_COMPACT) throw BPlusTreeException();
+	BlockInfo *bp = tree_->GetBufferManager()->GetFileBlock(tree_->get_db_name(), idx->get_name(), FORMAT_INDEX, block_num_);
+	bp->set_dirty(true);
+	char *buffer = bp->get_data();
+	*((int*)(&buffer[0])) = node_type_;
+	*((int*)(&buffer[4])) = count_;
+	*((int*)(&buffer[8])) = is_leaf() ? prev_leaf_ : -1;
+	int last_child = is_leaf() ? next_leaf_ : (int)get_values(count_);
+	if (idx->get_node_format() == NODE_FORMAT_FIXED)
+	{
+		int vlen = idx->get_rid_len();
+		int lenr = vlen + idx->get_key_len();
+		for (int i = 0; i < count_; i++)
+		{
+			WriteRID(&buffer[12 + i * lenr], values_[i], vlen);
+			memcpy(&buffer[12 + i * lenr + vlen], keys_[i].get_key(), idx->get_key_len());
 		}
-		return false;
+		if (is_leaf()) WriteRID(&buffer[12 + tree_->get_degree() * lenr], next_leaf_, vlen);
+		else WriteRID(&buffer[12 + count_ * lenr], last_child, vlen);
 	}
-	else														/* ˳ */
+	else
 	{
-		for (int i = 0; i < get_count(); i++)
+		int prefix_len = count_ > 0 ? CommonPrefix(keys_[0], keys_[count_ - 1]) : 0;
+		*((int*)(&buffer[12])) = last_child;
+		*((unsigned short*)(&buffer[16])) = (unsigned short)prefix_len;
+		*((unsigned short*)(&buffer[18])) = 0;
+		int vlen = GetEntryOverhead() - 2;
+		char *p = &buffer[NODE_HEADER_COMPACT];
+		if (count_ > 0) memcpy(p, keys_[0].get_key(), prefix_len);
+		p += prefix_len;
+		for (int i = 0; i < count_; i++)
 		{
-			if (key < get_keys(i))
-			{
-				index = i;
-				ans = false;
-				break;
-			}
-			else if (key == get_keys(i))
-			{
-				index = i;
-				ans = true;
-				break;
-			}
+			int suffix_len = keys_[i].get_length() - prefix_len;
+			WriteRID(p, values_[i], vlen);
+			*((unsigned short*)(p + vlen)) = (unsigned short)suffix_len;
+			memcpy(p + vlen + 2, keys_[i].get_key() + prefix_len, suffix_len);
+			p += vlen + 2 + suffix_len;
 		}
-		return ans;
 	}
+	dirty_ = false;
+}
+
+bool BTNode::is_dirty() { return dirty_; }
+
+/*Ĺǰ׺ȡڵеļβĹǰ׺мĹǰ׺*/
+int BTNode::CommonPrefix(TKey &a, TKey &b)
+{
+	int len = a.get_length() < b.get_length() ? a.get_length() : b.get_length();
+	int i = 0;
+	while (i < len && a.get_key()[i] == b.get_key()[i]) i++;
+	return i;
+}
+
+int BTNode::GetKeyBytes()
+{
+	int bytes = 0;
+	for (int i = 0; i < count_; i++)
+		bytes += keys_[i].get_length();
+	return bytes;
+}
+
+int BTNode::GetEntryOverhead() { return (is_leaf() ? tree_->GetIndex()->get_rid_len() : 4) + 2; }
+
+/*ʽĿС̶ǰ׺ѹʽΪ ͷ + ǰ׺ + ÿԪ(value + 2ֽں׺ + ׺)*/
+int BTNode::GetSize()
+{
+	if (tree_->GetIndex()->get_node_format() == NODE_FORMAT_FIXED)
+		return 12 + (count_ + 1) * (tree_->GetIndex()->get_rid_len() + tree_->GetIndex()->get_key_len());
+	int prefix_len = count_ > 0 ? CommonPrefix(keys_[0], keys_[count_ - 1]) : 0;
+	return NODE_HEADER_COMPACT + prefix_len + GetKeyBytes() + count_ * (GetEntryOverhead() - prefix_len);
+}
+
+bool BTNode::IsOverflow()
+{
+	if (tree_->GetIndex()->get_node_format() == NODE_FORMAT_FIXED) return count_ >= tree_->get_degree();
+	return GetSize() > 4 * 1024;
+}
+
+bool BTNode::IsUnderflow()
+{
+	if (tree_->GetIndex()->get_node_format() == NODE_FORMAT_FIXED) return count_ < rank_;
+	return GetSize() < NODE_UNDERFLOW_SIZE;
+}
+
+/*ǵһһԪأϳǸ*/
+bool BTNode::CanLend()
+{
+	if (tree_->GetIndex()->get_node_format() == NODE_FORMAT_FIXED) return count_ > rank_;
+	if (count_ < 2) return false;
+	int len = keys_[0].get_length() > keys_[count_ - 1].get_length() ? keys_[0].get_length() : keys_[count_ - 1].get_length();
+	return GetSize() - GetEntryOverhead() - len >= NODE_UNDERFLOW_SIZE;
+}
+
+/*ǰ׺ѹʽѹĴСƣļʹǰ׺*/
+bool BTNode::CanAbsorb()
+{
+	Index *idx = tree_->GetIndex();
+	if (idx->get_node_format() == NODE_FORMAT_FIXED) return count_ + 1 < tree_->get_degree();
+	return NODE_HEADER_COMPACT + GetKeyBytes() + idx->get_key_len() + (count_ + 1) * GetEntryOverhead() <= 4 * 1024;
+}
+
+/*ֲҵһ>=keyļ*/
+bool BTNode::search(TKey &key, int &index)
+{
+	int start = 0, end = count_;
+	while (start < end)
+	{
+		int mid = (start + end) / 2;
+		if (keys_[mid] < key) start = mid + 1;
+		else end = mid;
+	}
+	index = start;
+	return start < count_ && keys_[start] == key;
 }
 /*Ȳb+Ƿڸkey񣺽keyӦλ*/
 int BTNode::add(TKey &key)
@@ -157,7 +271,7 @@ int BTNode::add(TKey &key)
 	if (!search(key, index))
 	{
 		for (int i = get_count(); i > index; i--)
-			set_keys(i, get_keys(i - 1));
+			set_keys(i, keys_[i - 1]);
 
 		for (int i = get_count() + 1; i > index; i--)
 			set_values(i, get_values(i - 1));
@@ -169,7 +283,7 @@ int BTNode::add(TKey &key)
 	return index;
 }
 /*KV*/
-int BTNode::add(TKey &key, int &val)
+int BTNode::add(TKey &key, RID &val)
 {
 	int index = 0;
 	if (get_count() == 0)
@@ -182,7 +296,7 @@ int BTNode::add(TKey &key, int &val)
 	if (!search(key, index)) {
 		for (int i = get_count(); i > index; i--)
 		{
-			set_keys(i, get_keys(i - 1));
+			set_keys(i, keys_[i - 1]);
 			set_values(i, get_values(i - 1));
 		}
 
@@ -192,57 +306,80 @@ int BTNode::add(TKey &key, int &val)
 	}
 	return index;
 }
-/*ڵ*/
+/*
+ʽм䣨rankѡǰ׺ѹʽ߱ŵһλУѡ߽ϴСġ
+¼ԭĹǰ׺ʱļûйǰ׺мѹҪüŷŵ£
+û߶ŵµλãʱ߷ŵұBPlusTree::spiltForAddѡٸһ
+*/
+int BTNode::SplitPoint()
+{
+	if (tree_->GetIndex()->get_node_format() == NODE_FORMAT_FIXED) return rank_;
+	vector<int> bytes(count_ + 1, 0);/*bytes[i]Ϊǰiĳ֮*/
+	for (int i = 0; i < count_; i++)
+		bytes[i + 1] = bytes[i] + keys_[i].get_length();
+	auto size = [&](int from, int to)/*ֻfromto - 1ĽڵֽͬGetSize*/
+	{
+		int prefix_len = CommonPrefix(keys_[from], keys_[to - 1]);
+		return NODE_HEADER_COMPACT + prefix_len + bytes[to] - bytes[from] + (to - from) * (GetEntryOverhead() - prefix_len);
+	};
+	/*ԽԽmұmС*/
+	int first = is_leaf() ? 0 : 1, best = first, best_size = -1;
+	for (int m = first; m <= count_ - 2; m++)
+	{
+		int left = size(0, is_leaf() ? m + 1 : m);
+		if (left > 4 * 1024) break;
+		int larger = max(left, size(m + 1, count_));
+		if (best_size == -1 || larger < best_size)
+		{
+			best = m;
+			best_size = larger;
+		}
+	}
+	return best;
+}
+/*ڵѣҶӽڵ㱣[0, m]ƵļΪߵķָڲڵ㱣[0, m)m*/
 BTNode* BTNode::split(TKey &key)
 {
-	BTNode* newnode = new BTNode(tree_, true, tree_->get_new_blocknum(), is_leaf());
+	BTNode* newnode = tree_->new_node(is_leaf());
 	if (newnode == NULL)
 	{
 		throw BPlusTreeException();
 		return NULL;
 	}
-	key = get_keys(rank_);
+	int m = SplitPoint();
 	if (is_leaf())
 	{
-		for (int i = rank_ + 1; i< tree_->get_degree(); i++)
+		key = tree_->get_separator(keys_[m], keys_[m + 1]);
+		for (int i = m + 1; i < get_count(); i++)
 		{
-			newnode->set_keys(i - rank_ - 1, get_keys(i));
-			newnode->set_values(i - rank_ - 1, get_values(i));
+			newnode->set_keys(i - m - 1, keys_[i]);
+			newnode->set_values(i - m - 1, get_values(i));
 		}
 
-		newnode->set_count(rank_);
-		set_count(rank_ + 1);
+		newnode->set_count(get_count() - m - 1);
+		set_count(m + 1);
 		newnode->set_next_leaf(get_next_leaf());
+		newnode->set_prev_leaf(block_num_);
 		set_next_leaf(newnode->get_block_num());
-		newnode->set_parent(get_parent());
 	}
 	else
 	{
-		for (int i = rank_ + 1; i< tree_->get_degree(); i++)
-			newnode->set_keys(i - rank_ - 1, get_keys(i));
-
-		for (int i = rank_ + 1; i <= tree_->get_degree(); i++)
-			newnode->set_values(i - rank_ - 1, get_values(i));
+		key = keys_[m];
+		for (int i = m + 1; i < get_count(); i++)
+			newnode->set_keys(i - m - 1, keys_[i]);
 
-		newnode->set_parent(get_parent());
-		newnode->set_count(rank_);
+		for (int i = m + 1; i <= get_count(); i++)
+			newnode->set_values(i - m - 1, get_values(i));
 
-		int childnode_num;
-		for (int i = 0; i <= newnode->get_count(); i++)
-		{
-			childnode_num = newnode->get_values(i);
-			BTNode* node = tree_->get_node(childnode_num);
-			if (node) node->set_parent(newnode->get_block_num());
-		}
-		set_count(rank_);
+		newnode->set_count(get_count() - m - 1);
+		set_count(m);
 	}
 	return newnode;
 }
 /*жǷΪڵ*/
 bool BTNode::isRoot()
 {
-	if (get_parent() == -1) return true;
-	return false;
+	return block_num_ == tree_->GetIndex()->get_root();
 }
 //ӱڵɾindexԪ
 bool BTNode::remove(int index)
@@ -251,14 +388,14 @@ bool BTNode::remove(int index)
 	if (is_leaf()) {
 		for (int i = index; i < get_count() - 1; i++)
 		{
-			set_keys(i, get_keys(i + 1));
+			set_keys(i, keys_[i + 1]);
 			set_values(i, get_values(i + 1));
 		}
 	}
 	else
 	{
 		for (int i = index; i< get_count() - 1; i++)
-			set_keys(i, get_keys(i + 1));
+			set_keys(i, keys_[i + 1]);
 
 		for (int i = index; i < get_count(); i++)
 			set_values(i, get_values(i + 1));
@@ -270,10 +407,10 @@ bool BTNode::remove(int index)
 void BTNode::print()
 {
 	printf("*----------------------------------------------*\n");
-	printf(": %d : %d, ڵ: %d  Ҷӽڵ㣿:%d\n", block_num_, get_count(), get_parent(), is_leaf());
+	printf(": %d : %d, Ҷӽڵ㣿:%d\n", block_num_, get_count(), is_leaf());
 	printf("K: { ");
 	for (int i = 0; i < get_count(); i++)
-		cout << setw(9) << left << get_keys(i);
+		cout << setw(9) << left << keys_[i];
 	printf(" }\n");
 
 	if (is_leaf())
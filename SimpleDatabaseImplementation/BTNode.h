@@ -15,6 +15,19 @@
 
 using namespace std;
 
+/*
+ڵڴǽļֵ飬BPlusTreeŻ棬޸ĺһβʱĽڵʽдļ顣
+ڵ㲻Ǹڵ㣺ϲBPlusTree½ʱµ·ϵӻ˸ڵҲøдڵĿ顣
+ʽNODE_FORMAT_FIXED0-3ֽڽڵͣ4-7ֽԪظ8-11ֽһҶӣΪdegree[value][key]degreevalueΪһҶӡ
+ǰ׺ѹʽNODE_FORMAT_COMPACT0-3ֽڽڵͣ4-7ֽԪظ8-11ֽһҶӣ12-15ֽһҶӣڲڵΪһӣ
+16-17ֽڹǰ׺ȣΪǰ׺ΪԪ[value][׺2][׺]мǰ׺ֻһΣchar0
+ҶӽڵvalueΪ¼ַռrid_lenֽڣΪ4ǰ׺ѹʽڲڵvalueΪӿţռ4ֽڡ
+һҶֻhas_prev_linksΪtrueʱЧǰ8-11ֽΪ-1ɵĸڵţڲڵΪ-1
+ϲĿΪп飺0-3ֽΪNODE_FREE4-7ֽΪ08-11ֽڱ12-15ֽΪпеһ飨Ϊ-1ͷrubbish_С
+*/
+#define NODE_HEADER_COMPACT 20
+#define NODE_FREE -1
+
 class BPlusTree;
 class BTNode
 {
@@ -25,38 +38,56 @@ public:
 	int get_block_num();
 
 	TKey get_keys(int index);			/*ȡindexkeyֵ*/
-	int get_values(int index);			/*ȡindexvalueֵ*/
+	RID get_values(int index);			/*ȡindexvalueֵҶӽڵΪ¼ַڲڵΪӿ*/
 	int get_next_leaf();					/*ȡһҶӽڵ*/
-	int get_parent();					/*ȡһڵ㣬õǸýڵbufferеĵַţǸýڵڵbufferĵ8λ*/
-	int get_node_type();					/*ȡڵͣýڵbufferеĵ0λ*/
-	int get_count();						/*ȡڵݸýڵbufferеĵ4λ*/
+	int get_prev_leaf();					/*ȡһҶӽڵ*/
+	int get_node_type();					/*ȡڵ*/
+	int get_count();						/*ȡڵݸ*/
 	bool is_leaf();					/*жǷҶӽڵ*/
 
-	void set_keys(int index, TKey key);	/*key.key_ýڵĵindex*/
-	void set_values(int index, int val);	/*õindexԪصֵΪval*/
+	void set_keys(int index, TKey key);	/*keyýڵĵindex*/
+	void set_values(int index, RID val);	/*õindexԪصֵΪval*/
 	void set_next_leaf(int val);			/*һҶӽڵֵ*/
-	void set_parent(int val);			/*øڵֵ*/
+	void set_prev_leaf(int val);			/*һҶӽڵֵ*/
 	void set_node_type(int val);			/*ڵͣҶӽڵΪ1ҶӽڵΪ0*/
 	void set_count(int val);				/*ýڵ洢Ԫظ*/
 	void set_is_leaf(bool val);			/*ýڵǷΪҶӽڵ*/
 
-	void get_buffer();					/*fileлȡǰB+ڵdbеǰļ*/
+	void Read();							/*ļаڵʽ*/
+	void Write();						/*ڵʽдļ*/
+	bool is_dirty();						/*Ƿ޸Ĺ*/
+
+	int GetSize();						/*ռֽ*/
+	int GetKeyBytes();					/*мĳ֮*/
+	int GetEntryOverhead();				/*ǰ׺ѹʽÿԪس׺ֽvalue2ֽں׺*/
+	bool IsOverflow();					/*Ų£ҪѡʽΪԪظﵽ*/
+	bool IsUnderflow();					/*Ԫع٣ҪֵܽϲʽΪrank*/
+	bool CanLend();						/*һԪغ󲻻*/
+	bool CanAbsorb();					/*ټһļҲ*/
 
-	bool search(TKey key, int &index);	/*B+keyڵλãֵindexСֵtrueindexΪkeyλĽڵַfalseindexΪָһָ롣ڵԪظ20ڣ˳ң20⣬ֲ*/
+	bool search(TKey &key, int &index);	/*ڽڵвҵһ>=keyļλøֵindexСֵtrueükeyfalseڵkeyļ*/
 	int add(TKey &key);					/*Ȳb+Ƿڸkey񣺽keyӦλ*/
-	int add(TKey &key, int &val);		/*KV*/
+	int add(TKey &key, RID &val);		/*KV*/
 	BTNode* split(TKey &key);	/**/
 
 	bool isRoot();						/*жǷΪڵ*/
 	bool remove(int index);			/*ƳindexԪ*/
 	void print();
 
+	static int CommonPrefix(TKey &a, TKey &b);	/*Ĺǰ׺*/
+
 private:
+	int SplitPoint();					/*λã벿ֱ[0, SplitPoint]Ҷӣ[0, SplitPoint)ڲڵ㣩*/
+
 	BPlusTree* tree_;
 	int block_num_;
 	int rank_;
-	char* buffer_;//һblock
-	bool is_leaf_;
-	bool is_new_node_;
+	int node_type_;
+	int count_;
+	int next_leaf_;
+	int prev_leaf_;
+	bool dirty_;
+	vector<TKey> keys_;
+	vector<RID> values_;
 };
-#endif
\ No newline at end of file
+#endif
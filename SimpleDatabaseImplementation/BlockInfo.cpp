@@ -109,18 +109,37 @@ char* BlockInfo::GetContentAdress()
 {
 	return data_ + 12;
 }
-//ָ·аϢϢļdata_
-void BlockInfo::ReadInfo(string path)
+//ɿڵļƫơֶʱt.recordsУnֶʱkΣk>0Ϊt.records.k0Ϊt.records
+//ƫư64λ㣬ļԳ2GB
+string BlockInfo::GetFilePath(string path, long long &offset)
 {
 	path += file_->get_db_name() + "/" + file_->get_file_name();
 	//ļ
 	if (file_->get_type() == FORMAT_INDEX) path += ".index";
+	//¡ļ
+	else if (file_->get_type() == FORMAT_BLOOM) path += ".bloom";
 	//¼ļ
 	else path += ".records";
 
+	long long block = block_num_;
+	int segment_blocks = file_->get_segment_blocks();
+	if (segment_blocks > 0 && block >= segment_blocks)
+	{
+		path += "." + to_string(block / segment_blocks);
+		block %= segment_blocks;
+	}
+	offset = block * 4 * 1024;
+	return path;
+}
+//ָ·аϢϢļdata_
+void BlockInfo::ReadInfo(string path)
+{
+	long long offset;
+	path = GetFilePath(path, offset);
+
 	ifstream ifs(path, ios::binary);
 	//ҵÿļλãݿţ
-	ifs.seekg(block_num_ * 4 * 1024);
+	ifs.seekg(offset);
 	//ȡϢ
 	ifs.read(data_, 4 * 1024);
 	ifs.close();
@@ -128,18 +147,19 @@ void BlockInfo::ReadInfo(string path)
 //data_Ϣдָ·ļ¼ļ
 void BlockInfo::WriteInfo(string path)
 {
-	path += file_->get_db_name() + "/" + file_->get_file_name();
-	if (file_->get_type() == FORMAT_INDEX) path += ".index";
-	else path += ".records";
-
-	//ofstream ofs(path, ios::binary);
-	////ҵÿļλ
-	//ofs.seekp(block_num_ * 4 * 1024);
-	//ofs.write(data_, 4 * 1024);
-	//ofs.close();
-	FILE* filePt = fopen(path.c_str(), "rb+");
-	fseek(filePt, block_num_ * 4 * 1024, SEEK_SET);
-	fwrite(data_, 4 * 1024, 1, filePt);
-	fclose(filePt);
+	long long offset;
+	path = GetFilePath(path, offset);
 
+	//Զдʽ򿪲ļֶļһдʱڣȴ
+	fstream fs(path, ios::in | ios::out | ios::binary);
+	if (!fs.is_open())
+	{
+		ofstream ofs(path, ios::binary);
+		ofs.close();
+		fs.open(path, ios::in | ios::out | ios::binary);
+	}
+	//ҵÿļλ
+	fs.seekp(offset);
+	fs.write(data_, 4 * 1024);
+	fs.close();
 }
\ No newline at end of file
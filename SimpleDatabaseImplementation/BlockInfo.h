@@ -57,6 +57,8 @@ public:
 	void WriteInfo(string path);
 
 private:
+	//ɿڵļֶʱΪblock_num_/ֶοΣڸļеƫ
+	string GetFilePath(string path, long long &offset);
 	//ÿӦļϢ
 	FileInfo *file_;
 	//ı
@@ -0,0 +1,87 @@
+//飺¡
+//ãһֶά¡ǰֵѯֱжֵֶ
+#include "BloomFilter.h"
+#include "ConstValue.h"
+
+#include <cstring>
+
+using namespace std;
+
+BloomFilter::BloomFilter(Table* tb, BufferManager* bm, string dbname)
+{
+	tb_ = tb;
+	buffer_m_ = bm;
+	db_name_ = dbname;
+	counters_ = (long long)tb_->get_bloom_blocks() * 4 * 1024;
+}
+
+BloomFilter::~BloomFilter(void) {}
+
+void BloomFilter::Clear()
+{
+	for (int i = 0; i < tb_->get_bloom_blocks(); i++)
+	{
+		BlockInfo *bp = buffer_m_->GetFileBlock(db_name_, tb_->get_tb_name(), FORMAT_BLOOM, i);
+		memset(bp->get_data(), 0, 4 * 1024);
+		bp->set_dirty(true);
+	}
+}
+
+/*˫عϣiλΪh1+i*h2*/
+void BloomFilter::Positions(TKey& value, long long *pos)
+{
+	char buf[4 * 1024];
+	int len = value.EncodeCompact(buf);
+	if (value.get_key_type() == T_FLOAT && memcmp(buf, "\x7f\xff\xff\xff", 4) == 0)
+		memcpy(buf, "\x80\x00\x00\x00", 4);/*-0.00.0ȣ0.0ıϣ*/
+	unsigned long long h = 14695981039346656037ull;
+	for (int i = 0; i < len; i++)
+	{
+		h ^= (unsigned char)buf[i];
+		h *= 1099511628211ull;
+	}
+	unsigned long long h1 = h, h2 = (h >> 32 | h << 32) | 1;
+	for (int i = 0; i < BLOOM_HASHES; i++)
+		pos[i] = (long long)((h1 + i * h2) % (unsigned long long)counters_);
+}
+
+unsigned char* BloomFilter::get_counter(long long pos, bool dirty)
+{
+	BlockInfo *bp = buffer_m_->GetFileBlock(db_name_, tb_->get_tb_name(), FORMAT_BLOOM, (int)(pos / (4 * 1024)));
+	if (dirty) bp->set_dirty(true);
+	return (unsigned char*)bp->get_data() + pos % (4 * 1024);
+}
+
+void BloomFilter::Add(TKey& value)
+{
+	long long pos[BLOOM_HASHES];
+	Positions(value, pos);
+	for (int i = 0; i < BLOOM_HASHES; i++)
+	{
+		unsigned char *c = get_counter(pos[i], true);
+		if (*c != 255) (*c)++;
+	}
+}
+
+/*ͬһֵļλÿͬʱʱҲͬΣһ*/
+void BloomFilter::Remove(TKey& value)
+{
+	long long pos[BLOOM_HASHES];
+	Positions(value, pos);
+	for (int i = 0; i < BLOOM_HASHES; i++)
+	{
+		unsigned char *c = get_counter(pos[i], true);
+		if (*c != 255 && *c != 0) (*c)--;
+	}
+}
+
+bool BloomFilter::MayContain(TKey& value)
+{
+	long long pos[BLOOM_HASHES];
+	Positions(value, pos);
+	for (int i = 0; i < BLOOM_HASHES; i++)
+	{
+		if (*get_counter(pos[i], false) == 0) return false;
+	}
+	return true;
+}
@@ -0,0 +1,43 @@
+//飺¡
+//ãһֶά¡ǰֵѯֱжֵֶ
+#pragma once
+#ifndef _BLOOMFILTER_H_
+#define _BLOOMFILTER_H_
+
+#include <string>
+
+#include "CatalogManager.h"
+#include "BufferManager.h"
+
+using namespace std;
+
+/*
+ļΪ.bloombloom_blocks飬ÿ40968λд
+ֵֶĽձ루TKey::EncodeCompactеļͬ64λFNV-1aϣ˫عϣõBLOOM_HASHES
+¼ʱЩһɾʱһӵ255ٱ仯ֻ౨ܴڡ©
+*/
+#define BLOOM_HASHES 4
+#define BLOOM_DEFAULT_BLOCKS 16
+
+class BloomFilter
+{
+public:
+	BloomFilter(Table* tb, BufferManager* bm, string dbname);
+	~BloomFilter(void);
+
+	void Clear();									/*м0½ʱļлûЩ*/
+	void Add(TKey& value);							/*һֵֶ*/
+	void Remove(TKey& value);						/*ɾһֵֶ*/
+	bool MayContain(TKey& value);					/*falseʱֵһڱ*/
+
+private:
+	Table *tb_;										/*ı*/
+	BufferManager *buffer_m_;						/*ָ*/
+	string db_name_;								/*db*/
+	long long counters_;							/**/
+
+	void Positions(TKey& value, long long *pos);	/*ֵֶӦBLOOM_HASHES*/
+	unsigned char* get_counter(long long pos, bool dirty);	/*posڻеĵַdirtyΪtrueʱѿΪ*/
+};
+
+#endif
@@ -5,7 +5,7 @@
 #include <string>
 #include <fstream>
 
-BufferManager::BufferManager(string path) :path_(path)
+BufferManager::BufferManager(string path, int segment_blocks) :path_(path), segment_blocks_(segment_blocks)
 {
 	bhandle_ = new BlockHandle(path);
 	fhandle_ = new FileHandle(path);
@@ -27,6 +27,7 @@ BlockInfo* BufferManager::GetUsableBlock()
 //ݿļеıΪblock_numĿ
 BlockInfo* BufferManager::GetFileBlock(string db_name, string tb_name, int file_type, int block_num)
 {
+	lock_guard<recursive_mutex> guard(mutex_);
 	//ļзǿտ䶼1
 	fhandle_->IncreaseAge();
 	//õñӦļͷ
@@ -36,8 +37,11 @@ BlockInfo* BufferManager::GetFileBlock(string db_name, string tb_name, int file_
 	{
 		//õblock_numӦĿ
 		BlockInfo *blo = fhandle_->GetBlockInfo(file, block_num);
-		if (blo)//ڣֱӷ
+		if (blo)//ڣ㣨ʹãֱӷ
+		{
+			blo->ResetAge();
 			return blo;
+		}
 		else //ÿ鲻ڣڲϵͳȱҳжϣҪһµblockΪ0޿ÿ飬ҪLRU滻㷨
 		{
 			BlockInfo *bp = GetUsableBlock();
@@ -55,6 +59,7 @@ BlockInfo* BufferManager::GetFileBlock(string db_name, string tb_name, int file_
 		bp->set_block_num(block_num);
 		//һµfile
 		FileInfo *fp = new FileInfo(db_name, file_type, tb_name, 0, 0, NULL, NULL);
+		fp->set_segment_blocks(segment_blocks_);
 		fhandle_->AddFileInfo(fp);
 		bp->SetFile(fp);
 		bp->ReadInfo(path_);
@@ -71,5 +76,11 @@ void BufferManager::WriteBlock(BlockInfo* block)
 //дص	
 void BufferManager::WriteToDisk()
 {
+	lock_guard<recursive_mutex> guard(mutex_);
 	fhandle_->WriteToDisk();
+}
+
+recursive_mutex& BufferManager::get_mutex()
+{
+	return mutex_;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #define _BUFFERMANAGER_H_
 
 #include <string>
+#include <mutex>
 #include "BlockHandle.h"
 #include "FileHandle.h"
 
@@ -12,17 +13,22 @@ using namespace std;
 class BufferManager
 {
 public:
-	BufferManager(string path);
+	//segment_blocksΪݿļÿεĿ0ʾֶ
+	BufferManager(string path, int segment_blocks = 0);
 	~BufferManager();
 	//õݿļеıΪblock_numĿ
 	BlockInfo* GetFileBlock(string db_name, string tb_name, int file_type, int block_num);
 	void WriteBlock(BlockInfo* block);
 	void WriteToDisk();
+	//̹߳ûʱȡ鲢дڼҪиֹ鱻LRU
+	recursive_mutex& get_mutex();
 
 private:
 	BlockHandle* bhandle_;
 	FileHandle* fhandle_;
 	string path_;
+	int segment_blocks_;
+	recursive_mutex mutex_;
 	//ؿÿ׵ַ
 	BlockInfo* GetUsableBlock();
 };
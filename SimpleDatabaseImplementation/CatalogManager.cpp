@@ -66,9 +66,9 @@ void CatalogManager::WriteArchiveFile()
 }
 
 /*ݿ⣬˽бdatabase_һ½database*/
-void CatalogManager::CreateDatabase(string database_name)
+void CatalogManager::CreateDatabase(string database_name, int segment_blocks)
 {
-	databases_.push_back(Database(database_name));
+	databases_.push_back(Database(database_name, segment_blocks));
 }
 
 /*ɾݿ⣬˽бdatabase_ҵdatabaseɾ*/
@@ -86,13 +86,14 @@ void CatalogManager::DeleteDatabase(string database_name)
 /*Database캯*/
 Database::Database()
 {
-	;
+	segment_blocks_ = 0;
 }
 
 /*Database캯*/
-Database::Database(string database_name)
+Database::Database(string database_name, int segment_blocks)
 {
 	database_name_ = database_name;
+	segment_blocks_ = segment_blocks;
 }
 
 /*Database*/
@@ -107,6 +108,12 @@ string Database::get_database_name()
 	return database_name_;
 }
 
+/*ȡsegment_blocks_*/
+int Database::get_segment_blocks()
+{
+	return segment_blocks_;
+}
+
 /*ȡtables_*/
 vector<Table>& Database::get_tables()
 {
@@ -124,6 +131,20 @@ Table* Database::GetTable(string table_name)
 	return NULL;
 }
 
+/*ȡӦIndex࣬ڷNULL*/
+Index* Database::GetIndex(string index_name)
+{
+	for (auto table = tables_.begin(); table != tables_.end(); table++)
+	{
+		for (auto index = table->get_indexs().begin(); index != table->get_indexs().end(); index++)
+		{
+			if (index->get_name() == index_name)
+				return &(*index);
+		}
+	}
+	return NULL;
+}
+
 /*SQLCreateTable󴴽һtable*/
 void Database::CreateTable(SQLCreateTable& sql_obj)
 {
@@ -137,6 +158,7 @@ void Database::CreateTable(SQLCreateTable& sql_obj)
 	}
 	table.set_table_name(sql_obj.get_table_name());/*ֵtable_name_*/
 	table.set_record_length(record_length);/*ֵrecord_length_*/
+	table.set_page_format(sql_obj.get_page_format());/*ֵpage_format_*/
 	tables_.push_back(table);/*table뵽tableб*/
 }
 
@@ -196,6 +218,9 @@ Table::Table()
 	first_block_num_ = -1;
 	first_rubbish_num_ = -1;
 	block_count_ = 0;
+	bloom_attr_ = "";
+	bloom_blocks_ = 0;
+	page_format_ = PAGE_FORMAT_FIXED;
 }
 
 /*Table*/
@@ -267,6 +292,37 @@ void Table::set_first_block_num(int num)
 	first_block_num_ = num;
 }
 
+/*ȡbloom_attr_ûв¡ʱΪմ*/
+string Table::get_bloom_attr()
+{
+	return bloom_attr_;
+}
+
+/*ȡbloom_blocks_*/
+int Table::get_bloom_blocks()
+{
+	return bloom_blocks_;
+}
+
+/*ò¡ڵֶattr_nameΪմʾɾ*/
+void Table::SetBloom(string attr_name, int blocks)
+{
+	bloom_attr_ = attr_name;
+	bloom_blocks_ = attr_name == "" ? 0 : blocks;
+}
+
+/*ȡpage_format_*/
+int Table::get_page_format()
+{
+	return page_format_;
+}
+
+/*ñpage_format_*/
+void Table::set_page_format(int format)
+{
+	page_format_ = format;
+}
+
 /*ȡfirst_rubbish_num_*/
 int Table::get_first_rubbish_num()
 {
@@ -397,13 +453,25 @@ void Attribute::set_length(int length)
 /*Index캯*/
 Index::Index()
 {
-	;
+	unique_ = true;
+	index_type_ = INDEX_BTREE;
+	node_format_ = NODE_FORMAT_FIXED;
+	rid_length_ = 4;
+	rubbish_ = -1;
+	header_ = false;
+	header_loaded_ = false;
+	prev_links_ = false;
 }
 
 /*Index캯*/
-Index::Index(std::string name, std::string attr_name, int keytype, int keylen, int rank)
-{
-	attribute_name_ = attr_name;
+Index::Index(std::string name, vector<string> attr_names, int keytype, int keylen, int rank, bool unique, int index_type)
+{
+	unique_ = unique;
+	index_type_ = index_type;
+	node_format_ = NODE_FORMAT_FIXED;
+	rid_length_ = sizeof(RID);
+	attribute_names_ = attr_names;
+	attribute_name_ = attr_names[0];
 	name_ = name;
 	key_count_ = 0;
 	level_ = -1;
@@ -414,6 +482,9 @@ Index::Index(std::string name, std::string attr_name, int keytype, int keylen, i
 	rank_ = rank;
 	rubbish_ = -1;
 	max_count_ = 0;
+	header_ = true;
+	header_loaded_ = true;
+	prev_links_ = false;
 }
 
 /*ȡattribute_name_*/
@@ -422,6 +493,54 @@ string Index::get_attr_name()
 	return attribute_name_;
 }
 
+/*ȡattribute_names_*/
+vector<string> Index::get_attr_names()
+{
+	return attribute_names_;
+}
+
+/*ȡunique_*/
+bool Index::is_unique()
+{
+	return unique_;
+}
+
+/*ȡindex_type_*/
+int Index::get_index_type()
+{
+	return index_type_;
+}
+
+/*ȡnode_format_*/
+int Index::get_node_format()
+{
+	return node_format_;
+}
+
+/*ñnode_format_*/
+void Index::set_node_format(int node_format)
+{
+	node_format_ = node_format;
+}
+
+/*ȡrid_length_*/
+int Index::get_rid_len()
+{
+	return rid_length_;
+}
+
+/*ȡinclude_names_*/
+vector<string> Index::get_include_names()
+{
+	return include_names_;
+}
+
+/*ñinclude_names_*/
+void Index::set_include_names(vector<string> include_names)
+{
+	include_names_ = include_names;
+}
+
 /*ȡname_*/
 string Index::get_name()
 {
@@ -506,6 +625,60 @@ void Index::set_node_count(int node_count)
 	node_count_ = node_count;
 }
 
+/*ȡrubbish_пͷ*/
+int Index::get_rubbish()
+{
+	return rubbish_;
+}
+
+/*ñrubbish_*/
+void Index::set_rubbish(int rubbish)
+{
+	rubbish_ = rubbish;
+}
+
+/*ȡmax_count_ļѷĿ*/
+int Index::get_max_count()
+{
+	return max_count_;
+}
+
+/*ñmax_count_*/
+void Index::set_max_count(int max_count)
+{
+	max_count_ = max_count;
+}
+
+/*ȡheader_ԪǷļͷ*/
+bool Index::has_header()
+{
+	return header_;
+}
+
+/*ȡheader_loaded_*/
+bool Index::is_header_loaded()
+{
+	return header_loaded_;
+}
+
+/*ñheader_loaded_*/
+void Index::set_header_loaded(bool loaded)
+{
+	header_loaded_ = loaded;
+}
+
+/*ȡprev_links_ҶеһҶӿǷЧ*/
+bool Index::has_prev_links()
+{
+	return prev_links_;
+}
+
+/*ñprev_links_*/
+void Index::set_prev_links(bool prev_links)
+{
+	prev_links_ = prev_links;
+}
+
 /*max_count_++*/
 int Index::IncreaseMaxCount()
 {
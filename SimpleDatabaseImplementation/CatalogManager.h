@@ -5,10 +5,12 @@
 #include <vector>
 #include <string>
 #include "SQLStatement.h"
+#include "ConstValue.h"
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 using namespace std;
 
@@ -30,7 +32,7 @@ public:
 	Database* GetDB(string database_name);/*databaseȡӦDatabase*/
 	void ReadArchiveFile();/*ȡĿ¼ĵ*/
 	void WriteArchiveFile();/*дĿ¼ĵ*/
-	void CreateDatabase(string database_name);/*Ŀ¼иdatabaseһdatabase*/
+	void CreateDatabase(string database_name, int segment_blocks = 0);/*Ŀ¼иdatabaseһdatabase*/
 	void DeleteDatabase(string database_name);/*Ŀ¼иdatabaseɾһdatabase*/
 private:
 	friend class boost::serialization::access;/*ԪΪôлܹ˽гԱҪһԪ*/
@@ -46,11 +48,13 @@ private:
 class Database {
 public:
 	Database();/*Database캯*/
-	Database(string database_name);/*Database캯*/
+	Database(string database_name, int segment_blocks = 0);/*Database캯*/
 	~Database();/*Database*/
 	string get_database_name();/*ȡdatabase_name_*/
+	int get_segment_blocks();/*ȡsegment_blocks_*/
 	vector<Table>& get_tables();/*ȡtables_*/
 	Table* GetTable(string table_name);/*tableȡӦTable*/
+	Index* GetIndex(string index_name);/*ȡӦIndex࣬ڷNULL*/
 	void CreateTable(SQLCreateTable& obj);/*SQLCreateTable󴴽һtable*/
 	void DropTable(SQLDropTable& obj);/*SQLDropTableɾһtable*/
 	void DropIndex(SQLDropIndex& obj);/*SQLDropIndex󴴽һindex*/
@@ -62,8 +66,11 @@ private:
 	{
 		ar & database_name_;
 		ar & tables_;
+		if (version >= 1)/*汾1ļԷֶ*/
+			ar & segment_blocks_;
 	}
 	string database_name_;//洢ݿֵı
+	int segment_blocks_;//ļ.records.indexÿεĿ0ʾÿļֶ
 	vector<Table> tables_;//洢Tableı
 };
 
@@ -85,6 +92,11 @@ public:
 	int get_first_rubbish_num();/*ȡfirst_rubbish_num_*/
 	void set_first_rubbish_num(int num);/*ñfirst_rubbish_num_*/
 	int get_block_count();/*ȡblock_count_*/
+	string get_bloom_attr();/*ȡbloom_attr_ûв¡ʱΪմ*/
+	int get_bloom_blocks();/*ȡbloom_blocks_*/
+	void SetBloom(string attr_name, int blocks);/*ò¡ڵֶattr_nameΪմʾɾ*/
+	int get_page_format();/*ȡpage_format_*/
+	void set_page_format(int format);/*ñpage_format_*/
 
 	unsigned long GetAttributeNum();/*ȡֶ*/
 	void AddAttribute(Attribute& attr);/*Attribute󣬽öTable*/
@@ -106,12 +118,22 @@ private:
 		ar & block_count_;
 		ar & attributes_;
 		ar & indexs_;
+		if (version >= 1)/*汾1в¡*/
+		{
+			ar & bloom_attr_;
+			ar & bloom_blocks_;
+		}
+		if (version >= 2)/*汾2ôĿ¼ļ¼ҳ*/
+			ar & page_format_;
 	}
 	string table_name_;//洢ݱֵı
 	int record_length_;//洢¼ܳȵı
 	int first_block_num_;//洢һĵַı
 	int first_rubbish_num_;
 	int block_count_;//洢ı
+	string bloom_attr_;//¡ڵֶûʱΪմļΪ.bloomBloomFilter.h
+	int bloom_blocks_;//¡Ŀ
+	int page_format_;//¼ҳĸʽPAGE_FORMAT_FIXEDΪ¼PAGE_FORMAT_SLOTTEDΪĿ¼ı䳤¼SlottedPage.hPAGE_FORMAT_PAXΪֶηСҳţPaxPage.h
 
 	std::vector<Attribute> attributes_;//洢ֶεı
 	std::vector<Index> indexs_;//洢ı
@@ -149,8 +171,16 @@ private:
 class Index {
 public:
 	Index();/*Index캯*/
-	Index(std::string name, std::string attr_name, int keytype, int keylen, int rank);/*Index캯*/
-	string get_attr_name();/*ȡattribute_name_*/
+	Index(std::string name, vector<string> attr_names, int keytype, int keylen, int rank, bool unique = true, int index_type = INDEX_BTREE);/*Index캯*/
+	string get_attr_name();/*ȡattribute_name_ĵһֶ*/
+	vector<string> get_attr_names();/*ȡattribute_names_*/
+	bool is_unique();/*ȡunique_*/
+	int get_index_type();/*ȡindex_type_*/
+	int get_node_format();/*ȡnode_format_*/
+	void set_node_format(int node_format);/*ñnode_format_*/
+	int get_rid_len();/*ȡrid_length_*/
+	vector<string> get_include_names();/*ȡinclude_names_*/
+	void set_include_names(vector<string> include_names);/*ñinclude_names_*/
 	string get_name();/*ȡname_*/
 	int get_key_len();/*ȡkey_length_*/
 	int get_key_type();/*ȡkey_type_*/
@@ -165,6 +195,15 @@ public:
 	void set_level(int level);/*ñlevel_*/
 	int get_node_count();/*ȡnode_count_*/
 	void set_node_count(int node_count);/*ñnode_count_*/
+	int get_rubbish();/*ȡrubbish_пͷ*/
+	void set_rubbish(int rubbish);/*ñrubbish_*/
+	int get_max_count();/*ȡmax_count_ļѷĿ*/
+	void set_max_count(int max_count);/*ñmax_count_*/
+	bool has_header();/*ȡheader_ԪǷļͷ*/
+	bool is_header_loaded();/*ȡheader_loaded_*/
+	void set_header_loaded(bool loaded);/*ñheader_loaded_*/
+	bool has_prev_links();/*ȡprev_links_ҶеһҶӿǷЧ*/
+	void set_prev_links(bool prev_links);/*ñprev_links_*/
 
 	int IncreaseMaxCount();/*max_count_++*/
 	int IncreaseKeyCount();/*key_count_++*/
@@ -190,19 +229,55 @@ private:
 		ar & key_count_;
 		ar & level_;
 		ar & node_count_;
+		if (version >= 1)/*汾1ַ֧Ψһ*/
+			ar & unique_;
+		if (version >= 2)/*汾2ָ֧*/
+			ar & attribute_names_;
+		else if (Archive::is_loading::value)
+			attribute_names_.assign(1, attribute_name_);
+		if (version >= 3)/*汾3ֹ֧ϣ*/
+			ar & index_type_;
+		if (version >= 4)/*汾4B+ڵñ䳤ǰ׺ѹʽʱΪʽ*/
+			ar & node_format_;
+		if (version >= 5)/*汾5¼ַΪ8ֽڣʱΪ4ֽ*/
+			ar & rid_length_;
+		if (version >= 6)/*汾6ҶпɸǼֶΣ*/
+			ar & include_names_;
+		if (version >= 7)/*汾7ڵ㡢ȴļͷУʱԴĿ¼*/
+			ar & header_;
+		else if (Archive::is_loading::value)
+			header_ = false;
+		if (Archive::is_loading::value)
+		{
+			header_loaded_ = false;
+			prev_links_ = false;
+		}
 	}
 	int max_count_;//洢ֵı
 	int key_length_;//洢ȵı
 	int key_type_;//洢͵ı
 	int rank_;
-	int rubbish_;
+	int rubbish_;//B+ϲĿ飨ϣΪժ飩ɵĿпͷΪ-1¿ʱȡ
 	int root_;
 	int leaf_head_;
 	int key_count_;
 	int level_;
 	int node_count_;
+	bool header_;//ԪǷļ0ͷУIndexHeader.hĿ¼еֵֻDDLʱ
+	bool header_loaded_;//лĿ¼ǷѴͷԪ
+	bool prev_links_;//лͷУB+ҶеһҶӿǷЧ֮ǰиλΪ-1ɵĸڵ
+	bool unique_;//ǷΪΨһΨһļΪֶα+¼ַ
+	int index_type_;//ͣINDEX_BTREEΪB+INDEX_HASHΪչϣINDEX_ARTΪڴеART
+	int node_format_;//B+ڵʽNODE_FORMAT_FIXEDΪNODE_FORMAT_COMPACTΪǰ׺ѹı䳤
+	int rid_length_;//м¼ַRIDռֽ48
 	string attribute_name_;//洢ֶı
+	vector<string> attribute_names_;//ֶ˳򣻵ֻattribute_name_һ
+	vector<string> include_names_;//includeӾеֵֶҶԪصļ֮󣬲ֻڽɨ
 	string name_;//洢ı
 };
 
+BOOST_CLASS_VERSION(Database, 1)
+BOOST_CLASS_VERSION(Table, 2)
+BOOST_CLASS_VERSION(Index, 7)
+
 #endif
\ No newline at end of file
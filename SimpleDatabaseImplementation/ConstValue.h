@@ -4,11 +4,14 @@
 // File Format
 #define FORMAT_RECORD 0
 #define FORMAT_INDEX 1
+#define FORMAT_BLOOM 2
 
 // Data Type
 #define T_INT 0
 #define T_FLOAT 1
 #define T_CHAR 2
+// Index key only: order-preserving encoded bytes, compared with memcmp
+#define T_BINARY 3
 
 // = <> < > <= >=
 #define SIGN_EQ 0
@@ -18,4 +21,27 @@
 #define SIGN_LE 4
 #define SIGN_GE 5
 
+// Index Type
+#define INDEX_BTREE 0
+#define INDEX_HASH 1
+#define INDEX_ART 2
+
+// Record Identifier: block number in the high bits, offset within the block in the low 16 bits
+typedef long long RID;
+#define MAKE_RID(block_num, offset) (((RID)(block_num) << 16) | (RID)(offset))
+#define RID_BLOCK(rid) ((int)((rid) >> 16))
+#define RID_OFFSET(rid) ((int)((rid) & 0xffff))
+
+// B+ Tree Node Format
+#define NODE_FORMAT_FIXED 0
+#define NODE_FORMAT_COMPACT 1
+
+// Record Page Format
+#define PAGE_FORMAT_FIXED 0
+#define PAGE_FORMAT_SLOTTED 1
+#define PAGE_FORMAT_PAX 2
+
+// Parallel Scan: upper bound of max_parallel_workers
+#define MAX_PARALLEL_WORKERS 64
+
 #endif
\ No newline at end of file
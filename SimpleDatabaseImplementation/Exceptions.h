@@ -41,18 +41,10 @@ class IndexNotExistException : public std::exception {
 
 };
 
-class OneIndexEachTableException : public std::exception {
-
-};
-
 class BPlusTreeException : public std::exception {
 
 };
 
-class IndexMustBeCreatedOnPrimaryKeyException : public std::exception {
-
-};
-
 class PrimaryKeyConflictException : public std::exception {
 
 };
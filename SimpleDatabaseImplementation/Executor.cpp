@@ -0,0 +1,618 @@
+//飺ִ
+//ãӵʵ֡еֶΰдţɨӰθƣۼѡѭ
+#include "Executor.h"
+#include "RecordManager.h"
+#include "IndexManager.h"
+#include "ConstValue.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+Batch::Batch(Table* tb) : layout_(tb, BATCH_SIZE), data_(layout_.get_data_size(), 0), row_count_(0) {}
+
+RecordLayout* Batch::get_layout() { return &layout_; }
+char* Batch::get_data() { return &data_[0]; }
+char* Batch::Field(int col, int row) { return &data_[0] + layout_.get_offset(col) + row * layout_.get_length(col); }
+int Batch::get_row_count() { return row_count_; }
+vector<int>& Batch::get_selection() { return selection_; }
+bool Batch::IsFull() { return row_count_ == BATCH_SIZE; }
+
+void Batch::Clear()
+{
+	row_count_ = 0;
+	selection_.clear();
+}
+
+int Batch::AddRows(int count)
+{
+	int first = row_count_;
+	for (int i = 0; i < count; i++)
+		selection_.push_back(row_count_++);
+	return first;
+}
+
+/*Ŀ¼ҳcharֶεʵַ֮0ͬRecordView::GetKey*/
+void Batch::Set(int row, RecordView& record, vector<int>& columns)
+{
+	for (auto col = columns.begin(); col != columns.end(); col++)
+	{
+		int len = layout_.get_length(*col), n = min(record.FieldLength(*col), len);
+		char *dst = Field(*col, row);
+		memcpy(dst, record.Field(*col), n);
+		if (n < len) memset(dst + n, 0, len - n);
+	}
+}
+
+/*Ŀ¼ҳƣPAXҳֶθƣļ¼θ*/
+void Batch::Copy(RecordLayout* layout, char* data, int* offsets, int count, vector<int>& columns)
+{
+	int row = AddRows(count);
+	if (layout->get_format() == PAGE_FORMAT_SLOTTED)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			RecordView record(layout, data, offsets[i]);
+			Set(row + i, record, columns);
+		}
+		return;
+	}
+	for (auto col = columns.begin(); col != columns.end(); col++)
+	{
+		const char *src = layout->Column(data, *col);
+		int stride = layout->get_stride(*col), len = layout->get_length(*col);
+		char *dst = Field(*col, row);
+		if (stride == len && offsets[count - 1] - offsets[0] == count - 1)
+			memcpy(dst, src + offsets[0] * len, count * len);
+		else
+		{
+			for (int i = 0; i < count; i++)
+				memcpy(dst + i * len, src + offsets[i] * stride, len);
+		}
+	}
+}
+
+/*ѯõֶοظѡֶΡwhereorder byеֶΣֻһ*/
+static vector<int> Distinct(vector<int>& columns)
+{
+	vector<int> result = columns;
+	sort(result.begin(), result.end());
+	result.erase(unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+TableScan::TableScan(RecordManager* rm, Table* tb, vector<int>& columns, WherePredicate* predicate)
+	: rm_(rm), tb_(tb), columns_(Distinct(columns)), predicate_(predicate), layout_(tb),
+	block_num_(tb->get_first_block_num()), current_block_(-1), position_(0), batch_(tb) {}
+
+Batch* TableScan::Next()
+{
+	batch_.Clear();
+	char *data = NULL;
+	while (!batch_.IsFull())
+	{
+		if (position_ == offsets_.size())
+		{
+			if (block_num_ == -1) break;
+			BlockInfo *bp = rm_->GetBlockInfo(tb_, block_num_);
+			data = bp->get_data();
+			offsets_ = rm_->GetOffsets(tb_, data);
+			if (predicate_ != NULL) predicate_->Filter(&layout_, data, offsets_);
+			position_ = 0;
+			current_block_ = block_num_;
+			block_num_ = bp->GetNextBlockNum();
+			continue;
+		}
+		/*һڿмˣѱ¶*/
+		if (data == NULL) data = rm_->GetBlockInfo(tb_, current_block_)->get_data();
+		int count = min(BATCH_SIZE - batch_.get_row_count(), (int)(offsets_.size() - position_));
+		batch_.Copy(&layout_, data, &offsets_[position_], count, columns_);
+		position_ += count;
+	}
+	return batch_.get_row_count() == 0 ? NULL : &batch_;
+}
+
+ParallelScan::ParallelScan(RecordManager* rm, Table* tb, vector<int>& columns, WherePredicate* predicate, int workers)
+	: rm_(rm), tb_(tb), columns_(Distinct(columns)), predicate_(predicate), workers_(max(1, min(workers, MAX_PARALLEL_WORKERS))), current_(NULL), running_(0), stop_(false)
+{
+	/*ÿ߳װһڶлѱNextȡ*/
+	batches_.reserve(workers_ * 2 + 1);
+	for (int i = 0; i < workers_ * 2 + 1; i++)
+	{
+		batches_.push_back(Batch(tb));
+		free_.push_back(&batches_[i]);
+	}
+}
+
+ParallelScan::~ParallelScan()
+{
+	{
+		lock_guard<mutex> guard(mutex_);
+		stop_ = true;
+	}
+	free_cv_.notify_all();
+	for (auto t = threads_.begin(); t != threads_.end(); t++)
+		t->join();
+}
+
+/*һεʱ̡߳߳ʧʱ쳣׸ߣ߳threads_Уͣ£
+  threads_reservepush_backڴʧܶ»е߳*/
+Batch* ParallelScan::Next()
+{
+	unique_lock<mutex> lock(mutex_);
+	if (threads_.empty())
+	{
+		int blocks = tb_->get_block_count();
+		threads_.reserve(workers_);
+		for (int t = 0; t < workers_; t++)
+		{
+			threads_.push_back(thread(&ParallelScan::Scan, this, (int)((long long)blocks * t / workers_), (int)((long long)blocks * (t + 1) / workers_)));
+			running_++;
+		}
+	}
+	if (current_ != NULL)
+	{
+		free_.push_back(current_);
+		current_ = NULL;
+		free_cv_.notify_one();
+	}
+	ready_cv_.wait(lock, [this]() { return !ready_.empty() || running_ == 0; });
+	if (ready_.empty()) return NULL;
+	current_ = ready_.front();
+	ready_.pop_front();
+	return current_;
+}
+
+Batch* ParallelScan::Publish(Batch* batch)
+{
+	unique_lock<mutex> lock(mutex_);
+	if (batch != NULL)
+	{
+		ready_.push_back(batch);
+		ready_cv_.notify_one();
+	}
+	free_cv_.wait(lock, [this]() { return stop_ || !free_.empty(); });
+	if (stop_) return NULL;
+	Batch *next = free_.back();
+	free_.pop_back();
+	next->Clear();
+	return next;
+}
+
+/*鸴Ƴ߳ԼĻֵ븴ƣռû*/
+void ParallelScan::Scan(int first, int last)
+{
+	RecordLayout layout(tb_);
+	vector<char> data(4 * 1024);
+	Batch *batch = Publish(NULL);
+	for (int block_num = first; block_num < last && batch != NULL; block_num++)
+	{
+		rm_->CopyBlock(tb_, block_num, &data[0]);
+		vector<int> offsets = rm_->GetOffsets(tb_, &data[0]);
+		if (predicate_ != NULL) predicate_->Filter(&layout, &data[0], offsets);
+		for (unsigned int position = 0; position < offsets.size() && batch != NULL;)
+		{
+			int count = min(BATCH_SIZE - batch->get_row_count(), (int)(offsets.size() - position));
+			batch->Copy(&layout, &data[0], &offsets[position], count, columns_);
+			position += count;
+			if (batch->IsFull()) batch = Publish(batch);
+		}
+	}
+	lock_guard<mutex> guard(mutex_);
+	if (batch != NULL)
+	{
+		if (batch->get_row_count() > 0) ready_.push_back(batch);
+		else free_.push_back(batch);
+	}
+	running_--;
+	ready_cv_.notify_all();
+}
+
+RidScan::RidScan(RecordManager* rm, IndexCursor* cursor, vector<int>& columns, WherePredicate* predicate, int limit)
+	: rm_(rm), cursor_(cursor), tb_(cursor->get_table()), columns_(Distinct(columns)), predicate_(predicate), limit_(limit),
+	layout_(tb_), position_(0), produced_(0), batch_(tb_) {}
+
+/*limitʱֻαҪwhereļ¼ʱҪ*/
+Batch* RidScan::Next()
+{
+	batch_.Clear();
+	while (!batch_.IsFull() && !(limit_ >= 0 && produced_ == limit_))
+	{
+		if (position_ == rids_.size())
+		{
+			rids_.clear();
+			position_ = 0;
+			if (!cursor_->Fetch(limit_ >= 0 ? min(BATCH_SIZE, limit_ - produced_) : BATCH_SIZE, rids_)) break;
+			continue;
+		}
+		RID rid = rids_[position_++];
+		RecordView record(&layout_, rm_->GetBlockInfo(tb_, RID_BLOCK(rid))->get_data(), RID_OFFSET(rid));
+		if (predicate_ != NULL && !predicate_->Evaluate(record)) continue;
+		batch_.Set(batch_.AddRows(1), record, columns_);
+		produced_++;
+	}
+	return batch_.get_row_count() == 0 ? NULL : &batch_;
+}
+
+KeyScan::KeyScan(IndexManager* im, IndexCursor* cursor, WherePredicate* predicate, int limit)
+	: im_(im), cursor_(cursor), predicate_(predicate), limit_(limit), produced_(0), batch_(cursor->get_table()) {}
+
+Batch* KeyScan::Next()
+{
+	Table *tb = cursor_->get_table();
+	RecordLayout *layout = batch_.get_layout();
+	while (!(limit_ >= 0 && produced_ == limit_))
+	{
+		batch_.Clear();
+		vector<RID> rids;
+		vector<TKey> keys;
+		if (!cursor_->Fetch(limit_ >= 0 ? min(BATCH_SIZE, limit_ - produced_) : BATCH_SIZE, rids, &keys)) break;
+		for (auto key = keys.begin(); key != keys.end(); key++)
+		{
+			vector<TKey> tuple = im_->DecodeKey(tb, cursor_->get_index(), *key);
+			int row = batch_.AddRows(1);
+			for (int col = 0; col < layout->get_column_count(); col++)
+				memcpy(batch_.Field(col, row), tuple[col].get_key(), min(layout->get_length(col), tuple[col].get_length()));
+		}
+		vector<int> &selection = batch_.get_selection();
+		if (predicate_ != NULL) predicate_->Filter(layout, batch_.get_data(), selection);
+		produced_ += selection.size();
+		if (!selection.empty()) return &batch_;
+	}
+	return NULL;
+}
+
+FilterOperator::FilterOperator(BatchOperator* child, WherePredicate* predicate) : child_(child), predicate_(predicate) {}
+
+Batch* FilterOperator::Next()
+{
+	Batch *batch;
+	while ((batch = child_->Next()) != NULL)
+	{
+		predicate_->Filter(batch->get_layout(), batch->get_data(), batch->get_selection());
+		if (!batch->get_selection().empty()) return batch;
+	}
+	return NULL;
+}
+
+NestedLoopJoin::NestedLoopJoin(BatchOperator* left, BatchOperator* right, Table* joined)
+	: left_(left), right_(right), built_(false), outer_(NULL), outer_pos_(0), inner_batch_(0), inner_pos_(0), output_(joined) {}
+
+Batch* NestedLoopJoin::Next()
+{
+	if (!built_)
+	{
+		Batch *batch;
+		while ((batch = right_->Next()) != NULL)
+		{
+			if (!batch->get_selection().empty()) inner_.push_back(*batch);
+		}
+		built_ = true;
+	}
+	output_.Clear();
+	if (inner_.empty()) return NULL;
+	while (!output_.IsFull())
+	{
+		if (outer_ == NULL || outer_pos_ == outer_->get_selection().size())
+		{
+			if ((outer_ = left_->Next()) == NULL) break;
+			outer_pos_ = inner_batch_ = inner_pos_ = 0;
+			continue;
+		}
+		if (inner_batch_ == inner_.size())
+		{
+			outer_pos_++;
+			inner_batch_ = inner_pos_ = 0;
+			continue;
+		}
+		Batch &inner = inner_[inner_batch_];
+		vector<int> &selection = inner.get_selection();
+		if (inner_pos_ == selection.size())
+		{
+			inner_batch_++;
+			inner_pos_ = 0;
+			continue;
+		}
+		/*ߵһ¼ұһеcount¼ϣߵֶظcountΣұߵֶΰи*/
+		int count = min(BATCH_SIZE - output_.get_row_count(), (int)(selection.size() - inner_pos_));
+		int row = output_.AddRows(count);
+		RecordLayout *left = outer_->get_layout(), *right = inner.get_layout();
+		int outer_row = outer_->get_selection()[outer_pos_], left_count = left->get_column_count();
+		for (int col = 0; col < left_count; col++)
+		{
+			int len = left->get_length(col);
+			const char *value = outer_->Field(col, outer_row);
+			char *dst = output_.Field(col, row);
+			for (int i = 0; i < count; i++)
+				memcpy(dst + i * len, value, len);
+		}
+		for (int col = 0; col < right->get_column_count(); col++)
+		{
+			int len = right->get_length(col);
+			char *dst = output_.Field(left_count + col, row);
+			for (int i = 0; i < count; i++)
+				memcpy(dst + i * len, inner.Field(col, selection[inner_pos_ + i]), len);
+		}
+		inner_pos_ += count;
+	}
+	return output_.get_row_count() == 0 ? NULL : &output_;
+}
+
+HashJoin::HashJoin(BatchOperator* left, BatchOperator* right, Table* joined, vector<JoinKey>& keys)
+	: left_(left), right_(right), keys_(keys), built_(false), build_left_(false), left_count_(0), probe_buffered_(0),
+	probe_child_(NULL), probe_(NULL), probe_pos_(0), probe_hash_(0), match_(-1), output_(joined) {}
+
+/*ÿδѶ¼ٵһ߶һֱһ߶ꣻһ߽ϣһѶ̽*/
+void HashJoin::Build()
+{
+	built_ = true;
+	vector<Batch> batches[2];
+	long long rows[2] = { 0, 0 };
+	BatchOperator *children[2] = { left_, right_ };
+	int done = -1;
+	while (done == -1)
+	{
+		int side = rows[0] <= rows[1] ? 0 : 1;
+		Batch *batch = children[side]->Next();
+		if (batch == NULL) done = side;
+		else if (!batch->get_selection().empty())
+		{
+			batches[side].push_back(*batch);
+			rows[side] += batch->get_selection().size();
+		}
+	}
+	build_left_ = done == 0;
+	build_.swap(batches[done]);
+	if (build_.empty()) return;
+	probe_buffer_.swap(batches[1 - done]);
+	probe_child_ = children[1 - done];
+	int build_count = build_[0].get_layout()->get_column_count();
+	left_count_ = build_left_ ? build_count : output_.get_layout()->get_column_count() - build_count;
+
+	size_t buckets = 1;
+	while (buckets < rows[done] * 2) buckets <<= 1;
+	buckets_.assign(buckets, -1);
+	entries_.reserve(rows[done]);
+	for (unsigned int b = 0; b < build_.size(); b++)
+	{
+		vector<int> &selection = build_[b].get_selection();
+		for (auto row = selection.begin(); row != selection.end(); row++)
+		{
+			Entry entry;
+			if (!Hash(build_[b], *row, build_left_, entry.hash)) continue;
+			entry.batch = b;
+			entry.row = *row;
+			entry.next = buckets_[entry.hash & (buckets - 1)];
+			buckets_[entry.hash & (buckets - 1)] = entries_.size();
+			entries_.push_back(entry);
+		}
+	}
+}
+
+Batch* HashJoin::NextProbe()
+{
+	if (probe_buffered_ < probe_buffer_.size()) return &probe_buffer_[probe_buffered_++];
+	Batch *batch = probe_child_ != NULL ? probe_child_->Next() : NULL;
+	if (batch == NULL) probe_child_ = NULL;
+	return batch;
+}
+
+/*intֵfloatֵ0-0ͬcharȡ߳н϶̵һһ0ΪֹMatchıȽһ*/
+bool HashJoin::Hash(Batch& batch, int row, bool left, size_t& hash)
+{
+	RecordLayout *layout = output_.get_layout();
+	hash = 0;
+	for (auto key = keys_.begin(); key != keys_.end(); key++)
+	{
+		int col = left ? key->left : key->right - left_count_;
+		const char *value = batch.Field(col, row);
+		size_t h = 0;
+		if (layout->get_type(key->left) == T_INT)
+		{
+			int v;
+			memcpy(&v, value, 4);
+			h = (size_t)(unsigned int)v;
+		}
+		else if (layout->get_type(key->left) == T_FLOAT)
+		{
+			float v;
+			memcpy(&v, value, 4);
+			if (v != v) return false;
+			if (v == 0) v = 0;
+			unsigned int bits;
+			memcpy(&bits, &v, 4);
+			h = bits;
+		}
+		else
+		{
+			int len = min(layout->get_length(key->left), layout->get_length(key->right));
+			for (int i = 0; i < len && value[i] != 0; i++)
+				h = h * 131 + (unsigned char)value[i];
+		}
+		hash = (hash ^ h) * 0x9E3779B1 + (hash >> 16);
+	}
+	return true;
+}
+
+bool HashJoin::Match(Batch& build, int build_row, Batch& probe, int probe_row)
+{
+	RecordLayout *layout = output_.get_layout();
+	Batch &left = build_left_ ? build : probe, &right = build_left_ ? probe : build;
+	int left_row = build_left_ ? build_row : probe_row, right_row = build_left_ ? probe_row : build_row;
+	for (auto key = keys_.begin(); key != keys_.end(); key++)
+	{
+		const char *a = left.Field(key->left, left_row), *b = right.Field(key->right - left_count_, right_row);
+		int type = layout->get_type(key->left);
+		if (type == T_INT)
+		{
+			if (memcmp(a, b, 4) != 0) return false;
+		}
+		else if (type == T_FLOAT)
+		{
+			float x, y;
+			memcpy(&x, a, 4);
+			memcpy(&y, b, 4);
+			if (!(x == y)) return false;
+		}
+		else
+		{
+			/*ͬRecordView::CompareCharskey_1ֶεĳȱȽϣһ߳ĳȵĲֵ0*/
+			int alen = layout->get_length(key->left), blen = layout->get_length(key->right);
+			if (!key->key_1_left)
+			{
+				swap(a, b);
+				swap(alen, blen);
+			}
+			for (int i = 0; i < alen; i++)
+			{
+				char ca = a[i], cb = i < blen ? b[i] : 0;
+				if (ca != cb) return false;
+				if (ca == 0) break;
+			}
+		}
+	}
+	return true;
+}
+
+Batch* HashJoin::Next()
+{
+	if (!built_) Build();
+	output_.Clear();
+	if (build_.empty()) return NULL;
+	while (!output_.IsFull())
+	{
+		/*ǰ̽ļ¼ȽˣȡһҵͰ*/
+		if (match_ == -1)
+		{
+			if (probe_ != NULL) probe_pos_++;
+			while (probe_ == NULL || probe_pos_ >= probe_->get_selection().size())
+			{
+				if ((probe_ = NextProbe()) == NULL) return output_.get_row_count() == 0 ? NULL : &output_;
+				probe_pos_ = 0;
+			}
+			if (Hash(*probe_, probe_->get_selection()[probe_pos_], !build_left_, probe_hash_))
+				match_ = buckets_[probe_hash_ & (buckets_.size() - 1)];
+			continue;
+		}
+		Entry &entry = entries_[match_];
+		match_ = entry.next;
+		int probe_row = probe_->get_selection()[probe_pos_];
+		if (entry.hash != probe_hash_ || !Match(build_[entry.batch], entry.row, *probe_, probe_row)) continue;
+		/*ӽΪߵֶκұߵֶ*/
+		int row = output_.AddRows(1);
+		Batch &left = build_left_ ? build_[entry.batch] : *probe_, &right = build_left_ ? *probe_ : build_[entry.batch];
+		int left_row = build_left_ ? entry.row : probe_row, right_row = build_left_ ? probe_row : entry.row;
+		RecordLayout *layout = output_.get_layout();
+		for (int col = 0; col < layout->get_column_count(); col++)
+		{
+			const char *src = col < left_count_ ? left.Field(col, left_row) : right.Field(col - left_count_, right_row);
+			memcpy(output_.Field(col, row), src, layout->get_length(col));
+		}
+	}
+	return &output_;
+}
+
+AggregateOperator::AggregateOperator(BatchOperator* child, Table* tb, vector<string>& functions, vector<int>& cols)
+	: child_(child), tb_(tb), functions_(functions), cols_(cols) {}
+
+int AggregateOperator::Run(vector<TKey>& values)
+{
+	vector<Attribute> &attrs = tb_->GetAttributes();
+	values.clear();
+	for (unsigned int i = 0; i < functions_.size(); i++)
+	{
+		values.push_back(TKey(attrs[cols_[i]].get_data_type(), attrs[cols_[i]].get_length()));
+		memset(values[i].get_key(), 0, values[i].get_length());
+	}
+	vector<bool> started(functions_.size(), false);
+	int count = 0;
+	Batch *batch;
+	while (child_ != NULL && (batch = child_->Next()) != NULL)
+	{
+		vector<int> &selection = batch->get_selection();
+		unsigned int n = selection.size();
+		for (unsigned int i = 0; i < functions_.size() && n > 0; i++)
+		{
+			string f = functions_[i].substr(0, 3);
+			int col = cols_[i], len = attrs[col].get_length(), type = attrs[col].get_data_type();
+			if (f == "cou" || (f == "avg" && type == T_CHAR)) continue;
+			const char *column = batch->Field(col, 0);
+			unsigned int j = 0;
+			if (!started[i])
+			{
+				memcpy(values[i].get_key(), column + selection[0] * len, len);
+				started[i] = true;
+				j = 1;
+			}
+			char *acc = values[i].get_key();
+			if (type == T_INT)
+			{
+				int a;
+				memcpy(&a, acc, 4);
+				for (; j < n; j++)
+				{
+					int v;
+					memcpy(&v, column + selection[j] * 4, 4);
+					if (f == "min") a = v < a ? v : a;
+					else if (f == "max") a = v > a ? v : a;
+					else a += v;
+				}
+				memcpy(acc, &a, 4);
+			}
+			else if (type == T_FLOAT)
+			{
+				float a;
+				memcpy(&a, acc, 4);
+				for (; j < n; j++)
+				{
+					float v;
+					memcpy(&v, column + selection[j] * 4, 4);
+					if (f == "min") a = a > v ? v : a;
+					else if (f == "max") a = a < v ? v : a;
+					else a += v;
+				}
+				memcpy(acc, &a, 4);
+			}
+			else
+			{
+				/*ͬTKeyıȽϣstrncmp(ǰֵ, ֶ, )*/
+				for (; j < n; j++)
+				{
+					const char *v = column + selection[j] * len;
+					int cmp = strncmp(acc, v, len);
+					if ((f == "min" && cmp > 0) || (f == "max" && cmp < 0)) memcpy(acc, v, len);
+				}
+			}
+		}
+		count += n;
+	}
+	for (unsigned int i = 0; i < functions_.size(); i++)
+	{
+		string f = functions_[i].substr(0, 3);
+		if (f == "cou")
+		{
+			values[i] = TKey(T_INT, 4);
+			memcpy(values[i].get_key(), &count, 4);
+		}
+		else if (f == "avg" && values[i].get_key_type() != T_CHAR && count > 0) values[i] /= count;
+	}
+	return count;
+}
+
+ProjectOperator::ProjectOperator(BatchOperator* child, vector<int>& columns) : child_(child), columns_(columns), batch_(NULL), position_(0) {}
+
+bool ProjectOperator::Next(vector<TKey>& tuple)
+{
+	while (batch_ == NULL || position_ == batch_->get_selection().size())
+	{
+		if (child_ == NULL || (batch_ = child_->Next()) == NULL)
+		{
+			child_ = NULL;
+			return false;
+		}
+		position_ = 0;
+	}
+	tuple = RecordView(batch_->get_layout(), batch_->get_data(), batch_->get_selection()[position_++]).ToTuple(&columns_);
+	return true;
+}
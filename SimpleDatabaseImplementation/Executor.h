@@ -0,0 +1,261 @@
+//飺ִ
+//ãѯɣ֮ÿδһ¼ֶΰţѡȻЧС
+//      ɨ衢ˡӡۼͶӰֻͶӰĽŸƳvector<TKey>
+//      ɸȡÿֻ浱ǰһӻұߵѯռõڴĴС޹
+#pragma once
+#ifndef _EXECUTOR_H_
+#define _EXECUTOR_H_
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "CatalogManager.h"
+#include "SQLStatement.h"
+#include "RecordView.h"
+#include "Predicate.h"
+#include "FilterKernels.h"
+
+using namespace std;
+
+class RecordManager;
+class IndexManager;
+class IndexCursor;
+
+/*һļ¼ںѡλͼĴСFILTER_MAX_ROWSں˿ֱһ*/
+#define BATCH_SIZE 1024
+
+/*
+һ¼ֶtbͬͬPAXҳRecordLayoutcolֶεBATCH_SIZEֵš
+ɨֻƲѯõֶΣֶεֵû塣ѡΪЧекţС
+*/
+class Batch
+{
+public:
+	Batch(Table* tb);
+	RecordLayout* get_layout();
+	char* get_data();
+	char* Field(int col, int row);
+	int get_row_count();
+	vector<int>& get_selection();
+	bool IsFull();
+	void Clear();
+	int AddRows(int count);						/*βcountвѡУصһек*/
+	void Set(int row, RecordView& record, vector<int>& columns);	/*Ѽ¼columnsֶθƵrow*/
+	void Copy(RecordLayout* layout, char* data, int* offsets, int count, vector<int>& columns);	/*ѿdatacount¼columnsֶμӵβ*/
+private:
+	RecordLayout layout_;
+	vector<char> data_;
+	int row_count_;
+	vector<int> selection_;
+};
+
+/*ӣNextһ¼û˷NULLصӣһεNext֮ǰЧ*/
+class BatchOperator
+{
+public:
+	virtual ~BatchOperator() {}
+	virtual Batch* Next() = 0;
+};
+
+/*˳ɨĿwhereڿֵWherePredicate::Filterֻļ¼columnsֶθƽ*/
+class TableScan : public BatchOperator
+{
+public:
+	TableScan(RecordManager* rm, Table* tb, vector<int>& columns, WherePredicate* predicate);
+	Batch* Next();
+private:
+	RecordManager *rm_;
+	Table *tb_;
+	vector<int> columns_;
+	WherePredicate *predicate_;
+	RecordLayout layout_;
+	int block_num_;								/*һҪĿ飬-1ʾ*/
+	int current_block_;							/*offsets_ڵĿ*/
+	vector<int> offsets_;						/*ǰûзŽļ¼*/
+	unsigned int position_;
+	Batch batch_;
+};
+
+/*
+ɨ裺ĿΪ0block_count-1еĿյĿտ飬տûм¼ŷֳworkersν̣߳
+ؿһ顣߳ԼĿwhereֶΣװŽĶУNextӶȡ
+˳˳ͬĸ̶Nextȡʱ̵߳ȴеʱ֪ͨ߳ͣ
+*/
+class ParallelScan : public BatchOperator
+{
+public:
+	ParallelScan(RecordManager* rm, Table* tb, vector<int>& columns, WherePredicate* predicate, int workers);
+	~ParallelScan();
+	Batch* Next();
+private:
+	void Scan(int first, int last);				/*һ̣߳ɨ[first, last)еĿ*/
+	Batch* Publish(Batch* batch);				/*װõΪNULLŽУȡһеҪͣʱNULL*/
+	RecordManager *rm_;
+	Table *tb_;
+	vector<int> columns_;
+	WherePredicate *predicate_;
+	int workers_;
+	vector<thread> threads_;
+	vector<Batch> batches_;
+	vector<Batch*> free_;						/*е*/
+	deque<Batch*> ready_;						/*װõȴNextȡ*/
+	Batch *current_;							/*һNextصһNextʱŷŻؿе*/
+	int running_;								/*ûɨ߳*/
+	bool stop_;
+	mutex mutex_;
+	condition_variable ready_cv_;
+	condition_variable free_cv_;
+};
+
+/*α갴˳ȡ¼ַ¼жwherelimit>=0ʱlimitͣ*/
+class RidScan : public BatchOperator
+{
+public:
+	RidScan(RecordManager* rm, IndexCursor* cursor, vector<int>& columns, WherePredicate* predicate, int limit = -1);
+	Batch* Next();
+private:
+	RecordManager *rm_;
+	IndexCursor *cursor_;
+	Table *tb_;
+	vector<RID> rids_;							/*αȡһ¼ַ*/
+	vector<int> columns_;
+	WherePredicate *predicate_;
+	int limit_;
+	RecordLayout layout_;
+	unsigned int position_;
+	int produced_;
+	Batch batch_;
+};
+
+/*ɨ裺α갴˳ȡɸļԭֶΣ¼ԭжwherelimitͬRidScan*/
+class KeyScan : public BatchOperator
+{
+public:
+	KeyScan(IndexManager* im, IndexCursor* cursor, WherePredicate* predicate, int limit = -1);
+	Batch* Next();
+private:
+	IndexManager *im_;
+	IndexCursor *cursor_;
+	WherePredicate *predicate_;
+	int limit_;
+	int produced_;
+	Batch batch_;
+};
+
+/*ˣӵÿһwhereֻСѡƼ¼*/
+class FilterOperator : public BatchOperator
+{
+public:
+	FilterOperator(BatchOperator* child, WherePredicate* predicate);
+	Batch* Next();
+private:
+	BatchOperator *child_;
+	WherePredicate *predicate_;
+};
+
+/*
+ǶѭӣȶұߵٶߵÿһЧ¼ұߵЧ¼ϡ
+joinedֶΪߵֶκұߵֶΣϵFilterOperatorжϡ
+*/
+class NestedLoopJoin : public BatchOperator
+{
+public:
+	NestedLoopJoin(BatchOperator* left, BatchOperator* right, Table* joined);
+	Batch* Next();
+private:
+	BatchOperator *left_;
+	BatchOperator *right_;
+	vector<Batch> inner_;						/*ұߵ*/
+	bool built_;
+	Batch *outer_;								/*ߵĵǰ*/
+	unsigned int outer_pos_;					/*ߵǰеĵڼЧ¼*/
+	unsigned int inner_batch_;
+	unsigned int inner_pos_;
+	Batch output_;
+};
+
+/*ϣӵһֵleftrightΪߵֶӽекţkey_1_leftΪwhereдڵȺߵֶǷߣcharֶΰĳȱȽϣͬColumnPredicate*/
+struct JoinKey
+{
+	int left;
+	int right;
+	bool key_1_left;
+};
+
+/*
+ϣӣӽͬNestedLoopJoinֻϵֵkeysļ¼ߵȶһߣ¼ٵһߣ
+ڴнϣһ̽⣺Ѿ̽⣬֮߶̽⣬ضꡣ̽ʱȽϹϣֵͬļ¼ֶΣ
+floatֶΪNaNļ¼κμ¼ȡϵFilterOperatorж
+*/
+class HashJoin : public BatchOperator
+{
+public:
+	HashJoin(BatchOperator* left, BatchOperator* right, Table* joined, vector<JoinKey>& keys);
+	Batch* Next();
+private:
+	struct Entry
+	{
+		size_t hash;
+		int batch;
+		int row;
+		int next;								/*ͬһͰеһ-1ʾû*/
+	};
+	void Build();
+	Batch* NextProbe();
+	bool Hash(Batch& batch, int row, bool left, size_t& hash);	/*NaNʱfalse*/
+	bool Match(Batch& build, int build_row, Batch& probe, int probe_row);
+	BatchOperator *left_;
+	BatchOperator *right_;
+	vector<JoinKey> keys_;
+	bool built_;
+	bool build_left_;							/*߽ϣ*/
+	int left_count_;							/*ߵֶ*/
+	vector<Batch> build_;						/*ϣһߵ*/
+	vector<int> buckets_;						/*ͰĵһͰΪ2*/
+	vector<Entry> entries_;
+	vector<Batch> probe_buffer_;				/*ʱѾ̽һߵ*/
+	unsigned int probe_buffered_;
+	BatchOperator *probe_child_;				/*̽һߣΪNULL*/
+	Batch *probe_;								/*ǰ̽*/
+	unsigned int probe_pos_;
+	size_t probe_hash_;
+	int match_;									/*ǰ̽ļ¼һҪȽϵ-1ʾ¼Ƚ*/
+	Batch output_;
+};
+
+/*
+ۼfunctionsΪselectĸcount(id)colsΪõֶΡӵRecordManagerMinMaxAvgCountͬ
+avgΪӺԼ¼intֶͬTKey::operator/=charֶεavgΪմ
+*/
+class AggregateOperator
+{
+public:
+	AggregateOperator(BatchOperator* child, Table* tb, vector<string>& functions, vector<int>& cols);
+	//ؼ¼valuesΪۼĽ¼Ϊ0ʱvaluesû
+	int Run(vector<TKey>& values);
+private:
+	BatchOperator *child_;
+	Table *tb_;
+	vector<string> functions_;
+	vector<int> cols_;
+};
+
+/*ͶӰӸеЧ¼ǰһȡ˲Ҫһȡ˿ʱͣ*/
+class ProjectOperator
+{
+public:
+	ProjectOperator(BatchOperator* child, vector<int>& columns);
+	//һ¼ͬRecordView::ToTuple(&columns)columnsеֶΪȫ0û˷false
+	bool Next(vector<TKey>& tuple);
+private:
+	BatchOperator *child_;						/*ӣȡΪNULL*/
+	vector<int> columns_;
+	Batch *batch_;
+	unsigned int position_;
+};
+
+#endif
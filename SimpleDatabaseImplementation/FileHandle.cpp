@@ -56,8 +56,8 @@ BlockInfo* FileHandle::LRUAlgorithm()
 	FileInfo* fp = first_file_;
 	//ϵĿǰһ
 	BlockInfo* oldestbefore = NULL;
-	//ϵĿ
-	BlockInfo* oldest = fp->GetFirstBlock();
+	//ϵĿ飨first_file_ǲڱԴNULLʼң
+	BlockInfo* oldest = NULL;
 	//ҵϵĿ
 	while (fp != NULL)
 	{
@@ -65,7 +65,7 @@ BlockInfo* FileHandle::LRUAlgorithm()
 		BlockInfo* bp = fp->GetFirstBlock();
 		while (bp != NULL)
 		{
-			if (bp->get_age() > oldest->get_age())
+			if (oldest == NULL || bp->get_age() > oldest->get_age())
 			{
 				oldestbefore = bpbefore;
 				oldest = bp;
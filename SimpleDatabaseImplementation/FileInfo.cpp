@@ -9,6 +9,7 @@ FileInfo::FileInfo(void)
 	file_name_ = "";
 	block_amount_in_file_ = 0;
 	file_length_ = 0;
+	segment_blocks_ = 0;
 	first_block_ = 0;
 	next_ = 0;
 }
@@ -19,6 +20,7 @@ FileInfo::FileInfo(string db, int f_type, string f, int rec_amount, int rec_len,
 	file_name_ = f;
 	block_amount_in_file_ = rec_amount;
 	file_length_ = rec_len;
+	segment_blocks_ = 0;
 	first_block_ = first;
 	next_ = nxt;
 }
@@ -62,4 +64,13 @@ void FileInfo::IncreaseRecordAmount()
 void FileInfo::IncreaseRecordLength()
 {
 	file_length_ += 4096;
+}
+
+int FileInfo::get_segment_blocks()
+{
+	return segment_blocks_;
+}
+void FileInfo::set_segment_blocks(int segment_blocks)
+{
+	segment_blocks_ = segment_blocks;
 }
\ No newline at end of file
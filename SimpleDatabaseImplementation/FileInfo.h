@@ -30,6 +30,9 @@ public:
 	void IncreaseRecordAmount();
 	//ļܳ
 	void IncreaseRecordLength();
+	//ÿֶļĿ0ʾֶ
+	int get_segment_blocks();
+	void set_segment_blocks(int segment_blocks);
 private:
 	//ڵݿ
 	string db_name_;
@@ -40,7 +43,9 @@ private:
 	//ļеĿĿ
 	int block_amount_in_file_;
 	//ļܳǿ鳤ı
-	int file_length_;
+	long long file_length_;
+	//ÿֶļĿ0ʾֶ
+	int segment_blocks_;
 	//ļڿ׵ַָ
 	BlockInfo *first_block_;
 	//һļָ
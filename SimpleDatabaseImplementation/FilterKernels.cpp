@@ -0,0 +1,292 @@
+//飺ں
+//ãȽϡSSE4.2AVX2ʵ֣һʹʱCPUֵָ֧ѡһ
+#include "FilterKernels.h"
+#include "ConstValue.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FILTER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE42
+#define TARGET_AVX2
+#else
+/*ֻЩõӦָ򲻱ؼ-mavx2룬ûAVX2CPUϲ*/
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+/*ȽϷΪڡСڡ࣬!=>=<=ΪӦ==<>ȡNaNκȽ϶ȡ*/
+enum { CMP_EQ, CMP_LT, CMP_GT };
+
+static void Classify(int op, int& kind, bool& negate)
+{
+	switch (op)
+	{
+	case SIGN_EQ: kind = CMP_EQ; negate = false; break;
+	case SIGN_NE: kind = CMP_EQ; negate = true; break;
+	case SIGN_LT: kind = CMP_LT; negate = false; break;
+	case SIGN_GE: kind = CMP_LT; negate = true; break;
+	case SIGN_GT: kind = CMP_GT; negate = false; break;
+	default: kind = CMP_GT; negate = true; break;		/*SIGN_LE*/
+	}
+}
+
+template<class T>
+static inline T Load(const char* p)
+{
+	T v;
+	memcpy(&v, p, sizeof(T));
+	return v;
+}
+
+/*λͼеiλ0*/
+static inline void Clear(unsigned long long* bits, int i)
+{
+	bits[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+/*λͼдӵiλʼwidthλmaskжӦλΪ00iΪwidthı64λ*/
+static inline void Keep(unsigned long long* bits, int i, unsigned int mask, int width)
+{
+	unsigned long long drop = ~(unsigned long long)mask & ((1ULL << width) - 1);
+	bits[i >> 6] &= ~(drop << (i & 63));
+}
+
+/*Ƚϵfromn - 1ֵҲʵִʣ²һֵ*/
+template<class T>
+static void CompareScalar(const char* base, int stride, int from, int n, int op, T value, unsigned long long* bits)
+{
+	int kind;
+	bool negate;
+	Classify(op, kind, negate);
+	for (int i = from; i < n; i++)
+	{
+		T v = Load<T>(base + i * stride);
+		bool result = kind == CMP_EQ ? v == value : kind == CMP_LT ? v < value : v > value;
+		if (result == negate) Clear(bits, i);
+	}
+}
+
+static void IntScalar(const char* base, int stride, int n, int op, int value, unsigned long long* bits)
+{
+	CompareScalar<int>(base, stride, 0, n, op, value, bits);
+}
+
+static void FloatScalar(const char* base, int stride, int n, int op, float value, unsigned long long* bits)
+{
+	CompareScalar<float>(base, stride, 0, n, op, value, bits);
+}
+
+/*ֻȽǰcountֽڣvaluelenʱֶvalue'\0'Ҳ'\0'ֽ֮ڲӰ*/
+static int CompareCount(const char* value, int len)
+{
+	int count = 0;
+	while (count < len && value[count] != 0) count++;
+	return count < len ? count + 1 : len;
+}
+
+static void CharEqualFrom(const char* base, int stride, int from, int n, const char* value, int count, bool equal, unsigned long long* bits)
+{
+	for (int i = from; i < n; i++)
+	{
+		if ((memcmp(base + i * stride, value, count) == 0) != equal) Clear(bits, i);
+	}
+}
+
+static void CharEqualScalar(const char* base, int stride, int n, const char* value, int len, bool equal, const char* end, unsigned long long* bits)
+{
+	CharEqualFrom(base, stride, 0, n, value, CompareCount(value, len), equal, bits);
+}
+
+#ifdef FILTER_X86
+/*SSE4.2ÿαȽ4ֵҳеֵװ*/
+TARGET_SSE42 static void IntSse42(const char* base, int stride, int n, int op, int value, unsigned long long* bits)
+{
+	int kind;
+	bool negate;
+	Classify(op, kind, negate);
+	__m128i c = _mm_set1_epi32(value);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const char *p = base + i * stride;
+		__m128i v = stride == 4 ? _mm_loadu_si128((const __m128i*)p)
+			: _mm_setr_epi32(Load<int>(p), Load<int>(p + stride), Load<int>(p + 2 * stride), Load<int>(p + 3 * stride));
+		__m128i r = kind == CMP_EQ ? _mm_cmpeq_epi32(v, c) : kind == CMP_LT ? _mm_cmplt_epi32(v, c) : _mm_cmpgt_epi32(v, c);
+		unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(r));
+		Keep(bits, i, negate ? ~mask : mask, 4);
+	}
+	CompareScalar<int>(base, stride, i, n, op, value, bits);
+}
+
+TARGET_SSE42 static void FloatSse42(const char* base, int stride, int n, int op, float value, unsigned long long* bits)
+{
+	int kind;
+	bool negate;
+	Classify(op, kind, negate);
+	__m128 c = _mm_set1_ps(value);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const char *p = base + i * stride;
+		__m128 v = stride == 4 ? _mm_loadu_ps((const float*)p)
+			: _mm_setr_ps(Load<float>(p), Load<float>(p + stride), Load<float>(p + 2 * stride), Load<float>(p + 3 * stride));
+		__m128 r = kind == CMP_EQ ? _mm_cmpeq_ps(v, c) : kind == CMP_LT ? _mm_cmplt_ps(v, c) : _mm_cmpgt_ps(v, c);
+		unsigned int mask = _mm_movemask_ps(r);
+		Keep(bits, i, negate ? ~mask : mask, 4);
+	}
+	CompareScalar<float>(base, stride, i, n, op, value, bits);
+}
+
+/*ÿαȽ16ֽڣpcmpestriڳ֮вֽͬʱCF*/
+TARGET_SSE42 static void CharEqualSse42(const char* base, int stride, int n, const char* value, int len, bool equal, const char* end, unsigned long long* bits)
+{
+	int count = CompareCount(value, len), width = (count + 15) & ~15;
+	int i = 0;
+	/*¼ַ16ֽڶȡԽβȽ*/
+	for (; i < n && base + i * stride + width <= end; i++)
+	{
+		const char *p = base + i * stride;
+		bool eq = true;
+		for (int off = 0; eq && off < count; off += 16)
+		{
+			int l = min(16, count - off);
+			__m128i a = _mm_loadu_si128((const __m128i*)(p + off)), b = _mm_loadu_si128((const __m128i*)(value + off));
+			eq = !_mm_cmpestrc(b, l, a, l, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_EACH | _SIDD_NEGATIVE_POLARITY);
+		}
+		if (eq != equal) Clear(bits, i);
+	}
+	CharEqualFrom(base, stride, i, n, value, count, equal, bits);
+}
+
+/*AVX2ÿαȽ8ֵҳgather¼Ŷ*/
+TARGET_AVX2 static void IntAvx2(const char* base, int stride, int n, int op, int value, unsigned long long* bits)
+{
+	int kind;
+	bool negate;
+	Classify(op, kind, negate);
+	__m256i c = _mm256_set1_epi32(value);
+	__m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const char *p = base + i * stride;
+		__m256i v = stride == 4 ? _mm256_loadu_si256((const __m256i*)p) : _mm256_i32gather_epi32((const int*)p, index, 1);
+		__m256i r = kind == CMP_EQ ? _mm256_cmpeq_epi32(v, c) : kind == CMP_LT ? _mm256_cmpgt_epi32(c, v) : _mm256_cmpgt_epi32(v, c);
+		unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(r));
+		Keep(bits, i, negate ? ~mask : mask, 8);
+	}
+	CompareScalar<int>(base, stride, i, n, op, value, bits);
+}
+
+TARGET_AVX2 static void FloatAvx2(const char* base, int stride, int n, int op, float value, unsigned long long* bits)
+{
+	int kind;
+	bool negate;
+	Classify(op, kind, negate);
+	__m256 c = _mm256_set1_ps(value);
+	__m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const char *p = base + i * stride;
+		__m256 v = stride == 4 ? _mm256_loadu_ps((const float*)p) : _mm256_i32gather_ps((const float*)p, index, 1);
+		__m256 r = kind == CMP_EQ ? _mm256_cmp_ps(v, c, _CMP_EQ_OQ) : kind == CMP_LT ? _mm256_cmp_ps(v, c, _CMP_LT_OQ) : _mm256_cmp_ps(v, c, _CMP_GT_OQ);
+		unsigned int mask = _mm256_movemask_ps(r);
+		Keep(bits, i, negate ? ~mask : mask, 8);
+	}
+	CompareScalar<float>(base, stride, i, n, op, value, bits);
+}
+
+/*ÿαȽ32ֽڣcount֮ڵֽȫͬ*/
+TARGET_AVX2 static void CharEqualAvx2(const char* base, int stride, int n, const char* value, int len, bool equal, const char* end, unsigned long long* bits)
+{
+	int count = CompareCount(value, len), width = (count + 31) & ~31;
+	int i = 0;
+	for (; i < n && base + i * stride + width <= end; i++)
+	{
+		const char *p = base + i * stride;
+		bool eq = true;
+		for (int off = 0; eq && off < count; off += 32)
+		{
+			int l = min(32, count - off);
+			unsigned int need = l == 32 ? 0xFFFFFFFFu : (1u << l) - 1;
+			__m256i a = _mm256_loadu_si256((const __m256i*)(p + off)), b = _mm256_loadu_si256((const __m256i*)(value + off));
+			unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+			eq = (mask & need) == need;
+		}
+		if (eq != equal) Clear(bits, i);
+	}
+	CharEqualFrom(base, stride, i, n, value, count, equal, bits);
+}
+
+static bool SupportsSse42()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] >> 20) & 1;
+#else
+	return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+static bool SupportsAvx2()
+{
+#ifdef _MSC_VER
+	/*CPU֧֣ϵͳҪYMMĴOSXSAVEXCR0ĵ12λΪ1*/
+	int info[4];
+	__cpuid(info, 1);
+	if (!((info[2] >> 27) & 1) || !((info[2] >> 28) & 1) || (_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] >> 5) & 1;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+/*ǰCPUʹõһʵ*/
+struct KernelSet
+{
+	void(*int_kernel)(const char*, int, int, int, int, unsigned long long*);
+	void(*float_kernel)(const char*, int, int, int, float, unsigned long long*);
+	void(*char_kernel)(const char*, int, int, const char*, int, bool, const char*, unsigned long long*);
+};
+
+static KernelSet ChooseKernels()
+{
+#ifdef FILTER_X86
+	if (SupportsAvx2()) return KernelSet{ IntAvx2, FloatAvx2, CharEqualAvx2 };
+	if (SupportsSse42()) return KernelSet{ IntSse42, FloatSse42, CharEqualSse42 };
+#endif
+	return KernelSet{ IntScalar, FloatScalar, CharEqualScalar };
+}
+
+static KernelSet& Kernels()
+{
+	static KernelSet kernels = ChooseKernels();
+	return kernels;
+}
+
+void FilterKernels::Int(const char* base, int stride, int n, int op, int value, unsigned long long* bits)
+{
+	Kernels().int_kernel(base, stride, n, op, value, bits);
+}
+
+void FilterKernels::Float(const char* base, int stride, int n, int op, float value, unsigned long long* bits)
+{
+	Kernels().float_kernel(base, stride, n, op, value, bits);
+}
+
+void FilterKernels::CharEqual(const char* base, int stride, int n, const char* value, int len, bool equal, const char* end, unsigned long long* bits)
+{
+	Kernels().char_kernel(base, stride, n, value, len, equal, end, bits);
+}
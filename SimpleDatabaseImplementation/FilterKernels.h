@@ -0,0 +1,29 @@
+//飺ں
+//ãһĳֶεֵ볣һαȽ꣬дѡλͼCPUʱѡAVX2SSE4.2Ƚϵʵ
+#pragma once
+#ifndef _FILTERKERNELS_H_
+#define _FILTERKERNELS_H_
+
+/*
+ҳPAXҳĿܷ(4096 - 12) / ¼¼¼СΪ1һchar(1)ֶΣһ4084¼
+ѡλͼΪFILTER_WORDS64λ֣iλΪ1ʾi¼ܷһм¼
+*/
+#define FILTER_MAX_ROWS 4096
+#define FILTER_WORDS (FILTER_MAX_ROWS / 64)
+
+/*
+ֶεnֵbaseʼֵstrideֽڣҳstrideΪ¼ȣPAXҳΪֶγȣֵģ
+ֻλͼвλ0ԶͬһλͼεüΪand
+ȽϵĽTKeyͬopΪConstValue.hеSIGN_*<=Ϊڡ>=ΪСڡfloatֶΪNaNʱֻ!=<=>=
+*/
+class FilterKernels
+{
+public:
+	static void Int(const char* base, int stride, int n, int op, int value, unsigned long long* bits);
+	static void Float(const char* base, int stride, int n, int op, float value, unsigned long long* bits);
+	//char(len)ֶǷvalueͬstrncmp(ֶ, value, len) == 0equalΪfalseʱ󲻵
+	//valueΪ0lenĳ֮ٻҪ32ɶֽڣendΪĩβȡԽ
+	static void CharEqual(const char* base, int stride, int n, const char* value, int len, bool equal, const char* end, unsigned long long* bits);
+};
+
+#endif
@@ -0,0 +1,338 @@
+//飺ϣ
+//ãļĿʵչϣextendible hashingڵֵѯ
+#include <iostream>
+#include "HashIndex.h"
+#include "ConstValue.h"
+#include "Exceptions.h"
+#include "IndexHeader.h"
+using namespace std;
+
+#define HASH_DIR_ENTRIES 1024		/*ÿĿ¼Ŀ¼*/
+#define HASH_MAX_DEPTH 19			/*ͷ¼1022Ŀ¼飬ȫΪ19*/
+
+HashIndex::HashIndex(Index* idx, BufferManager* bm, CatalogManager* cm, string dbname)
+{
+	buffer_m_ = bm;
+	catalog_m_ = cm;
+	idx_ = idx;
+	db_name_ = dbname;
+	rid_len_ = idx_->get_rid_len();
+	entry_len_ = rid_len_ + idx_->get_key_len();
+	capacity_ = (4 * 1024 - 12) / entry_len_;
+	IndexHeader::Load(idx_, buffer_m_, db_name_);
+	if (idx_->get_root() == -1) InitIndex();
+}
+
+HashIndex::~HashIndex(void) {}
+
+/*ʼ0Ϊͷ飬1ΪĿ¼飬2ΪΨһͰȫֲȾΪ0*/
+void HashIndex::InitIndex()
+{
+	int header = idx_->IncreaseMaxCount();
+	int dir = idx_->IncreaseMaxCount();
+	int bucket = new_bucket_block(0);
+	char *p = get_block(header, true);
+	*((int*)(p + 0)) = 0;
+	*((int*)(p + 4)) = 1;
+	*((int*)(p + 8)) = dir;
+	idx_->set_root(header);
+	set_dir_entry(0, bucket);
+	idx_->set_key_count(0);
+	idx_->set_node_count(1);
+	idx_->set_level(0);
+	IndexHeader::Store(idx_, buffer_m_, db_name_);
+}
+
+char* HashIndex::get_block(int num, bool dirty)
+{
+	BlockInfo *bp = buffer_m_->GetFileBlock(db_name_, idx_->get_name(), FORMAT_INDEX, num);
+	if (dirty) bp->set_dirty(true);
+	return bp->get_data();
+}
+
+/*¿ļĩβ֮Ŀ飬еݲȷҪͷȫд*/
+int HashIndex::new_bucket_block(int local_depth)
+{
+	int num = idx_->get_rubbish();
+	if (num == -1) num = idx_->IncreaseMaxCount();
+	else idx_->set_rubbish(*((int*)(get_block(num) + 8)));
+	char *p = get_block(num, true);
+	*((int*)(p + 0)) = local_depth;
+	*((int*)(p + 4)) = 0;
+	*((int*)(p + 8)) = -1;
+	return num;
+}
+
+void HashIndex::free_block(int num)
+{
+	char *p = get_block(num, true);
+	*((int*)(p + 0)) = -1;
+	*((int*)(p + 4)) = 0;
+	*((int*)(p + 8)) = idx_->get_rubbish();
+	idx_->set_rubbish(num);
+	idx_->DecreaseNodeCount();
+}
+
+/*FNV-1aǱֽڣȵֵֶֽͬ*/
+unsigned int HashIndex::hash(char *key)
+{
+	unsigned int h = 2166136261u;
+	for (int i = 0; i < idx_->get_key_len(); i++)
+	{
+		h ^= (unsigned char)key[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+RID HashIndex::get_rid(char *entry)
+{
+	if (rid_len_ == 4) return *((int*)entry);
+	RID rid;
+	memcpy(&rid, entry, sizeof(RID));
+	return rid;
+}
+
+int HashIndex::get_dir_entry(int i)
+{
+	char *header = get_block(idx_->get_root());
+	int dir = *((int*)(header + 8 + 4 * (i / HASH_DIR_ENTRIES)));
+	char *p = get_block(dir);
+	return *((int*)(p + 4 * (i % HASH_DIR_ENTRIES)));
+}
+
+void HashIndex::set_dir_entry(int i, int bucket)
+{
+	char *header = get_block(idx_->get_root());
+	int dir = *((int*)(header + 8 + 4 * (i / HASH_DIR_ENTRIES)));
+	char *p = get_block(dir, true);
+	*((int*)(p + 4 * (i % HASH_DIR_ENTRIES))) = bucket;
+}
+
+/*Ŀ¼ӱµĺһĿ¼ǰһһһӦָͬͰ*/
+void HashIndex::double_directory()
+{
+	char *header = get_block(idx_->get_root(), true);
+	int depth = *((int*)(header + 0));
+	int size = 1 << depth;
+	if (size < HASH_DIR_ENTRIES)
+	{
+		char *p = get_block(*((int*)(header + 8)), true);
+		memcpy(p + 4 * size, p, 4 * size);
+	}
+	else
+	{
+		int pages = size / HASH_DIR_ENTRIES;
+		for (int i = 0; i < pages; i++)
+		{
+			int num = idx_->IncreaseMaxCount();
+			header = get_block(idx_->get_root(), true);
+			*((int*)(header + 8 + 4 * (pages + i))) = num;
+			char *src = get_block(*((int*)(header + 8 + 4 * i)));
+			char *dest = get_block(num, true);
+			memcpy(dest, src, 4 * 1024);
+		}
+		header = get_block(idx_->get_root(), true);
+		*((int*)(header + 4)) = 2 * pages;
+	}
+	*((int*)(header + 0)) = depth + 1;
+	idx_->set_level(depth + 1);
+}
+
+void HashIndex::append(int bucket, char *entry, vector<int> &spare)
+{
+	int num = bucket;
+	char *p = get_block(num);
+	while (*((int*)(p + 8)) != -1)
+	{
+		num = *((int*)(p + 8));
+		p = get_block(num);
+	}
+	if (*((int*)(p + 4)) == capacity_)
+	{
+		int next;
+		if (spare.empty()) next = new_bucket_block(*((int*)(get_block(bucket))));
+		else
+		{
+			next = spare.back();
+			spare.pop_back();
+			int ld = *((int*)(get_block(bucket)));
+			char *q = get_block(next, true);
+			*((int*)(q + 0)) = ld;
+			*((int*)(q + 4)) = 0;
+			*((int*)(q + 8)) = -1;
+		}
+		p = get_block(num, true);
+		*((int*)(p + 8)) = next;
+		num = next;
+	}
+	p = get_block(num, true);
+	int count = *((int*)(p + 4));
+	memcpy(p + 12 + count * entry_len_, entry, entry_len_);
+	*((int*)(p + 4)) = count + 1;
+}
+
+/*ͰֲΪldͰϣֵldλͰĿ¼еldλhͬldλΪ1ָͰ*/
+void HashIndex::split(int bucket, unsigned int h)
+{
+	int ld = *((int*)(get_block(bucket)));
+	int gd = *((int*)(get_block(idx_->get_root())));
+	if (ld == gd) double_directory();
+
+	/* ȡͰеԪأ·ʱʹ */
+	vector<char> entries;
+	vector<int> spare;
+	int num = bucket;
+	while (num != -1)
+	{
+		char *p = get_block(num);
+		int count = *((int*)(p + 4));
+		entries.insert(entries.end(), p + 12, p + 12 + count * entry_len_);
+		if (num != bucket) spare.push_back(num);
+		num = *((int*)(p + 8));
+	}
+	char *p = get_block(bucket, true);
+	*((int*)(p + 0)) = ld + 1;
+	*((int*)(p + 4)) = 0;
+	*((int*)(p + 8)) = -1;
+	int newbucket = new_bucket_block(ld + 1);
+	idx_->IncreaseNodeCount();
+
+	gd = *((int*)(get_block(idx_->get_root())));
+	unsigned int low = (h & ((1u << ld) - 1)) | (1u << ld);
+	for (unsigned int i = low; i < (1u << gd); i += (1u << (ld + 1)))
+		set_dir_entry(i, newbucket);
+
+	for (unsigned int i = 0; i < entries.size(); i += entry_len_)
+	{
+		char *entry = &entries[i];
+		append((hash(entry + rid_len_) >> ld) & 1 ? newbucket : bucket, entry, spare);
+	}
+	for (unsigned int i = 0; i < spare.size(); i++)
+		free_block(spare[i]);
+}
+
+void HashIndex::add(TKey& key, int block_num, int offset)
+{
+	if (rid_len_ == 4 && block_num > 0x7fff) throw BPlusTreeException();/*ļ¼ַֻ4ֽڣŲ¸Ŀ*/
+	unsigned int h = hash(key.get_key());
+	vector<char> entry(entry_len_);
+	RID rid = MAKE_RID(block_num, offset);
+	if (rid_len_ == 4) *((int*)(&entry[0])) = (int)rid;
+	else memcpy(&entry[0], &rid, sizeof(RID));
+	memcpy(&entry[rid_len_], key.get_key(), idx_->get_key_len());
+
+	while (true)
+	{
+		int gd = *((int*)(get_block(idx_->get_root())));
+		int bucket = get_dir_entry(h & ((1u << gd) - 1));
+
+		/* ҵͰһ飬δֱӷ */
+		int num = bucket;
+		char *p = get_block(num);
+		while (*((int*)(p + 8)) != -1)
+		{
+			num = *((int*)(p + 8));
+			p = get_block(num);
+		}
+		vector<int> spare;
+		if (*((int*)(p + 4)) < capacity_)
+		{
+			append(bucket, &entry[0], spare);
+			break;
+		}
+		/* ͰˣԪعϣֵhͬʱûã飻Ѻ */
+		bool same_hash = true;
+		for (num = bucket; num != -1 && same_hash; num = *((int*)(p + 8)))
+		{
+			p = get_block(num);
+			for (int i = 0; i < *((int*)(p + 4)) && same_hash; i++)
+				if (hash(p + 12 + i * entry_len_ + rid_len_) != h) same_hash = false;
+		}
+		int ld = *((int*)(get_block(bucket)));
+		if (same_hash || ld >= HASH_MAX_DEPTH)
+		{
+			append(bucket, &entry[0], spare);
+			idx_->IncreaseNodeCount();
+			break;
+		}
+		split(bucket, h);
+	}
+	idx_->IncreaseKeyCount();
+	IndexHeader::Store(idx_, buffer_m_, db_name_);
+}
+
+/*ɾԪغͰһԪƵλֳһⶼģһҲժ*/
+bool HashIndex::remove(TKey& key, int block_num, int offset)
+{
+	unsigned int h = hash(key.get_key());
+	int gd = *((int*)(get_block(idx_->get_root())));
+	int bucket = get_dir_entry(h & ((1u << gd) - 1));
+	RID rid = MAKE_RID(block_num, offset);
+
+	int found_block = -1, found_pos = -1;
+	int prev = -1, last = -1;
+	int num = bucket;
+	while (num != -1)
+	{
+		char *p = get_block(num);
+		int count = *((int*)(p + 4));
+		for (int i = 0; i < count && found_block == -1; i++)
+		{
+			char *e = p + 12 + i * entry_len_;
+			if (get_rid(e) == rid && memcmp(e + rid_len_, key.get_key(), idx_->get_key_len()) == 0)
+			{
+				found_block = num;
+				found_pos = i;
+			}
+		}
+		prev = last;
+		last = num;
+		num = *((int*)(p + 8));
+	}
+	if (found_block == -1) return false;
+
+	char *lp = get_block(last, true);
+	int count = *((int*)(lp + 4));
+	vector<char> moved(lp + 12 + (count - 1) * entry_len_, lp + 12 + count * entry_len_);
+	*((int*)(lp + 4)) = count - 1;
+	char *fp = get_block(found_block, true);
+	if (!(found_block == last && found_pos == count - 1))
+		memcpy(fp + 12 + found_pos * entry_len_, &moved[0], entry_len_);
+	if (count - 1 == 0 && last != bucket)
+	{
+		char *pp = get_block(prev, true);
+		*((int*)(pp + 8)) = -1;
+		free_block(last);
+	}
+	idx_->DecreaseKeyCount();
+	IndexHeader::Store(idx_, buffer_m_, db_name_);
+	return true;
+}
+
+vector<RID> HashIndex::search(TKey& key)
+{
+	vector<RID> ans;
+	unsigned int h = hash(key.get_key());
+	int gd = *((int*)(get_block(idx_->get_root())));
+	int num = get_dir_entry(h & ((1u << gd) - 1));
+	while (num != -1)
+	{
+		char *p = get_block(num);
+		int count = *((int*)(p + 4));
+		for (int i = 0; i < count; i++)
+		{
+			char *e = p + 12 + i * entry_len_;
+			if (memcmp(e + rid_len_, key.get_key(), idx_->get_key_len()) == 0)
+				ans.push_back(get_rid(e));
+		}
+		num = *((int*)(p + 8));
+	}
+	return ans;
+}
+
+void HashIndex::print()
+{
+	printf("*----------------------------------------------*\n");
+	printf("ϣ : %d, Ͱ: %d, ȫ: %d, ÿԪ: %d \n", idx_->get_key_count(), idx_->get_node_count(), idx_->get_level(), capacity_);
+}
@@ -0,0 +1,57 @@
+//飺ϣ
+//ãļĿʵչϣextendible hashingڵֵѯ
+#pragma once
+#ifndef _HASHINDEX_H_
+#define _HASHINDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "CatalogManager.h"
+#include "BufferManager.h"
+#include "ConstValue.h"
+
+using namespace std;
+
+/*
+ļ֣ÿ4K
+0Ϊͷ飺0-3ֽΪȫȣ4-7ֽΪĿ¼ΪĿ¼Ŀ
+Ŀ¼飺ÿ1024ͰţĿ¼iڵi/1024Ŀ¼ĵi%1024
+Ͱ飺0-3ֽΪֲȣ4-7ֽΪԪظ8-11ֽΪţΪ-1ΪԪ[¼ַrid_len][key_len]
+һͰһģͰʱȷѣԪعϣֵͬظʱŹ
+ɾժʱûϵ8-11ֽڴɿпͷΪrubbish_ͷУͰʱȡ
+*/
+class HashIndex
+{
+public:
+	HashIndex(Index* idx, BufferManager* bm, CatalogManager* cm, string dbname);
+	~HashIndex(void);
+
+	void add(TKey& key, int block_num, int offset);			/*ΪkeyֵΪ¼ַԪ*/
+	bool remove(TKey& key, int block_num, int offset);		/*ɾΪkeyֵΪü¼ַԪ*/
+	vector<RID> search(TKey& key);							/*ؼΪkeyԪصֵ*/
+	void print();
+
+private:
+	Index *idx_;											/*ָ룬root_Ϊͷţkey_count_ΪԪظ*/
+	BufferManager *buffer_m_;								/*ָ*/
+	CatalogManager *catalog_m_;								/*Ŀ¼ָ*/
+	string db_name_;										/*ùϣdb*/
+	int rid_len_;											/*¼ַֽΪ4*/
+	int entry_len_;											/*ÿԪصĳȣrid_len+key_len*/
+	int capacity_;											/*ÿܷŵԪظ*/
+
+	void InitIndex();										/*ʼͷ顢һĿ¼һͰ*/
+	char* get_block(int num, bool dirty = false);			/*ȡļnumݣҪ޸ʱdirtyΪtrueΪ*/
+	int new_bucket_block(int local_depth);					/*һյͰ飬ȡпеĿ*/
+	void free_block(int num);								/*ͰҵпͷϣͰһ*/
+	unsigned int hash(char *key);							/*FNV-1aϣ*/
+	RID get_rid(char *entry);								/*Ԫеļ¼ַ*/
+	int get_dir_entry(int i);								/*ȡĿ¼iͰţ*/
+	void set_dir_entry(int i, int bucket);					/*Ŀ¼i*/
+	void double_directory();								/*Ŀ¼ӱȫȼһ*/
+	void split(int bucket, unsigned int h);					/*ѹϣֵΪhԪڵͰ*/
+	void append(int bucket, char *entry, vector<int> &spare);	/*Ԫ׷ӵͰβ¿飨spareеĿ飩*/
+};
+
+#endif
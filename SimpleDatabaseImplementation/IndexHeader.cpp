@@ -0,0 +1,53 @@
+//飺ͷ
+//ãĸڵ㡢ɾ仯Ԫݴļ0У滺дأÿθдĿ¼ļ
+#include "IndexHeader.h"
+#include "ConstValue.h"
+#include "Exceptions.h"
+
+#include <cstring>
+
+using namespace std;
+
+/*½ʱдʼԪݡͷļлڣеݲȷ*/
+void IndexHeader::Create(Index* idx, BufferManager* bm, string db_name)
+{
+	if (idx->get_index_type() == INDEX_BTREE && idx->get_max_count() == 0) idx->IncreaseMaxCount();/*0ͷ飬ڵӵ1鿪ʼ*/
+	idx->set_prev_links(idx->get_index_type() == INDEX_BTREE);
+	BlockInfo *bp = bm->GetFileBlock(db_name, idx->get_name(), FORMAT_INDEX, 0);
+	memset(bp->get_data(), 0, 4 * 1024);
+	Store(idx, bm, db_name);
+}
+
+void IndexHeader::Load(Index* idx, BufferManager* bm, string db_name)
+{
+	if (!idx->has_header() || idx->is_header_loaded()) return;
+	BlockInfo *bp = bm->GetFileBlock(db_name, idx->get_name(), FORMAT_INDEX, 0);
+	int *meta = (int*)(bp->get_data() + INDEX_META_OFFSET);
+	if (meta[0] != INDEX_META_MAGIC) throw BPlusTreeException();/*ͷ*/
+	idx->set_root(meta[1]);
+	idx->set_leaf_head(meta[2]);
+	idx->set_key_count(meta[3]);
+	idx->set_node_count(meta[4]);
+	idx->set_level(meta[5]);
+	idx->set_max_count(meta[6]);
+	idx->set_rubbish(meta[7]);
+	idx->set_prev_links((meta[8] & INDEX_FLAG_PREV_LINKS) != 0);
+	idx->set_header_loaded(true);
+}
+
+void IndexHeader::Store(Index* idx, BufferManager* bm, string db_name)
+{
+	if (!idx->has_header()) return;
+	BlockInfo *bp = bm->GetFileBlock(db_name, idx->get_name(), FORMAT_INDEX, 0);
+	bp->set_dirty(true);
+	int *meta = (int*)(bp->get_data() + INDEX_META_OFFSET);
+	meta[0] = INDEX_META_MAGIC;
+	meta[1] = idx->get_root();
+	meta[2] = idx->get_leaf_head();
+	meta[3] = idx->get_key_count();
+	meta[4] = idx->get_node_count();
+	meta[5] = idx->get_level();
+	meta[6] = idx->get_max_count();
+	meta[7] = idx->get_rubbish();
+	meta[8] = idx->has_prev_links() ? INDEX_FLAG_PREV_LINKS : 0;
+}
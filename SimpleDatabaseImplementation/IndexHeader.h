@@ -0,0 +1,32 @@
+//飺ͷ
+//ãĸڵ㡢ɾ仯Ԫݴļ0У滺дأÿθдĿ¼ļ
+#pragma once
+#ifndef _INDEXHEADER_H_
+#define _INDEXHEADER_H_
+
+#include <string>
+
+#include "CatalogManager.h"
+#include "BufferManager.h"
+
+using namespace std;
+
+/*
+ͷΪļĵ0顣B+ĵ0ֻͷãϣĵ0鱾ͷ飨ȫĿ¼ֻõǰ2056ֽڣ
+ԪݷڿĩβINDEX_META_OFFSET0-3ֽΪINDEX_META_MAGICΪڵ㡢Ҷͷڵ㼶ѷпͷ
+ٺΪ־λINDEX_FLAG_PREV_LINKSʾB+ҶеһҶӿЧ֮ǰûиñ־vacuum indexʱϣ
+Ŀ¼еЩִֵֻDDLԼرݿ⣩ʱд룬ͷеΪ׼has_headerΪfalseȫĿ¼С
+*/
+#define INDEX_META_OFFSET (4 * 1024 - 64)
+#define INDEX_META_MAGIC 0x48584449
+#define INDEX_FLAG_PREV_LINKS 1
+
+class IndexHeader
+{
+public:
+	static void Create(Index* idx, BufferManager* bm, string db_name);		/*½ʱдʼԪݣB+ռõ0*/
+	static void Load(Index* idx, BufferManager* bm, string db_name);		/*Ŀ¼һõʱͷԪ*/
+	static void Store(Index* idx, BufferManager* bm, string db_name);	/*Ԫдͷ飨飩*/
+};
+
+#endif
@@ -2,11 +2,20 @@
 //Implemented by Xu Jing
 //ãĿ¼bufferʵûĴ
 #include "IndexManager.h"
+#include "HashIndex.h"
+#include "ArtIndex.h"
+#include "IndexHeader.h"
+#include "BloomFilter.h"
 #include "Exceptions.h"
 #include "RecordManager.h"
+#include "ConstValue.h"
 
 #include <string>
 #include <fstream>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <thread>
 using namespace std;
 
 IndexManager::IndexManager(CatalogManager *cm, BufferManager *bm, string dbname) :catalog_m_(cm), buffer_m_(bm), db_name_(dbname) {}
@@ -19,11 +28,37 @@ void IndexManager::CreateIndex(SQLCreateIndex& st)
 	string tb_name = st.get_tb_name();
 	Table *tb = catalog_m_->GetDB(db_name_)->GetTable(tb_name);
 	if (tb == NULL) throw TableNotExistException();
-	if (tb->GetIndexNum() != 0) throw OneIndexEachTableException();
 
-	/* ֻֻ֧ܶprimary key */
-	Attribute *attr = tb->GetAttribute(st.get_column_name());
-	if (attr->get_attr_type() != 1) throw IndexMustBeCreatedOnPrimaryKeyException();
+	/* ½B+ʹǰ׺ѹı䳤ڵ㣺ΪֶεĽձ룬charֶβ0key_lenΪļARTļ֮ͬ */
+	int index_type = st.get_index_type();
+	int node_format = index_type != INDEX_HASH ? NODE_FORMAT_COMPACT : NODE_FORMAT_FIXED;
+	vector<string> cols = st.get_column_names();
+	int key_len = 0;
+	for (auto col = cols.begin(); col != cols.end(); col++)
+	{
+		Attribute *attr = tb->GetAttribute(*col);
+		if (attr == NULL) throw AttributeNotExistException();
+		key_len += attr->get_length();
+		if (node_format == NODE_FORMAT_COMPACT && attr->get_data_type() == T_CHAR) key_len++;
+	}
+	/* includeֶֻǰ׺ѹʽҶԪУڼ֮󣩣B+֧ */
+	vector<string> includes = st.get_include_names();
+	if (!includes.empty() && node_format != NODE_FORMAT_COMPACT) throw SyntaxErrorException();
+	for (auto col = includes.begin(); col != includes.end(); col++)
+	{
+		Attribute *attr = tb->GetAttribute(*col);
+		if (attr == NULL) throw AttributeNotExistException();
+		key_len += attr->get_length();
+		if (attr->get_data_type() == T_CHAR) key_len++;
+	}
+
+	/* ֻϵĵΪΨһֶΣظֵ׷Ӽ¼ַʹB+ȻΨһ */
+	/* ϣļǸֶεı루ֵֽͬͬ¼ַţҪ׷ */
+	bool unique = cols.size() == 1 && tb->GetAttribute(cols[0])->get_attr_type() == 1;
+	int key_type = unique && node_format == NODE_FORMAT_FIXED && index_type == INDEX_BTREE ? tb->GetAttribute(cols[0])->get_data_type() : T_BINARY;
+	if (!unique && index_type != INDEX_HASH) key_len += sizeof(RID);
+	/* һڵҪŵ4ļ */
+	if (index_type == INDEX_BTREE && NODE_HEADER_COMPACT + 4 * (sizeof(RID) + 2 + key_len) > 4 * 1024) throw BPlusTreeException();
 
 	/* ļ */
 	string file_name = catalog_m_->get_path() + db_name_ + "/" + st.get_index_name() + ".index";
@@ -31,31 +66,639 @@ void IndexManager::CreateIndex(SQLCreateIndex& st)
 	ofs.close();
 
 	/* һӦб */
-	Index idx(st.get_index_name(), st.get_column_name(), attr->get_data_type(), attr->get_length(),
-		(4 * 1024 - 12) / (4 + attr->get_length()) / 2 - 1);
+	Index idx(st.get_index_name(), cols, key_type, key_len,
+		node_format == NODE_FORMAT_FIXED ? (4 * 1024 - 12) / (4 + key_len) / 2 - 1 : 0, unique, index_type);
+	idx.set_node_format(node_format);
+	idx.set_include_names(includes);
 	tb->AddIndex(idx);
+	Index *pidx = tb->GetIndex(tb->GetIndexNum() - 1);
+	if (index_type == INDEX_ART) ArtIndex::Open(db_name_, pidx->get_name(), file_name);	/*ARTڴУļֻſ*/
+	else IndexHeader::Create(pidx, buffer_m_, db_name_);				/*ڵ㡢ȴļͷ*/
 
-	/* ȡм¼B+ */
-	BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);	/*B+ָcatalog_m_Ϊcatalog_m_ݿ⣬бϢϢܹԾֲݽṹø*/
-	RecordManager *rm = new RecordManager(catalog_m_, buffer_m_, db_name_);
+	/* ̲߳жм¼ļźB+źļԵϽɣϣART˳ */
+	int threads = st.get_threads() > 0 ? st.get_threads() : (int)thread::hardware_concurrency();
+	vector<pair<TKey, RID> > entries = SortedEntries(tb, pidx, threads);
+	if (index_type == INDEX_BTREE)
+	{
+		BPlusTree tree(pidx, buffer_m_, catalog_m_, db_name_);
+		tree.bulk_load(entries);
+	}
+	else if (index_type == INDEX_ART)
+	{
+		ArtIndex *art = GetArt(tb, pidx);
+		for (auto e = entries.begin(); e != entries.end(); e++)
+			art->add(e->first, e->second);
+	}
+	else
+	{
+		HashIndex hash(pidx, buffer_m_, catalog_m_, db_name_);
+		for (auto e = entries.begin(); e != entries.end(); e++)
+			hash.add(e->first, RID_BLOCK(e->second), RID_OFFSET(e->second));
+	}
+	entries.clear();
+
+	buffer_m_->WriteToDisk();											/*ڵĻдش*/
+	catalog_m_->WriteArchiveFile();
+
+	if (index_type == INDEX_HASH)
+	{
+		HashIndex hash(pidx, buffer_m_, catalog_m_, db_name_);
+		hash.print();
+	}
+	else if (index_type == INDEX_ART) GetArt(tb, pidx)->print();
+	else
+	{
+		BPlusTree tree(pidx, buffer_m_, catalog_m_, db_name_);
+		tree.print();
+	}
+}
+
+/*ؿȡñпţֳthreadsΣÿ̶߳һοеļ¼
+  鲢ڵΣͬһֵĸι鲢нУֱֻʣһΡ鲢ȶģͬʱпǰļ¼ǰ*/
+vector<pair<TKey, RID> > IndexManager::SortedEntries(Table* tb, Index* idx, int threads)
+{
+	RecordManager rm(catalog_m_, buffer_m_, db_name_);
+	vector<int> blocks;
+	for (int block_num = tb->get_first_block_num(); block_num != -1;)
+	{
+		blocks.push_back(block_num);
+		block_num = rm.GetBlockInfo(tb, block_num)->GetNextBlockNum();
+	}
+	if (threads > (int)blocks.size()) threads = blocks.size();
+	if (threads < 1) threads = 1;
 
-	int col_idx = tb->GetAttributeIndex(st.get_column_name());
-	int block_num = tb->get_first_block_num();							/*ȡñĵһ*/
+	RecordLayout layout(tb);
+	typedef vector<pair<TKey, RID> > Run;
+	auto less_key = [](const pair<TKey, RID> &a, const pair<TKey, RID> &b) { return a.first < b.first; };
+	vector<Run> runs(threads);
+	auto extract = [&](int t)
+	{
+		vector<char> data(4 * 1024);
+		for (size_t b = blocks.size() * t / threads; b < blocks.size() * (t + 1) / threads; b++)
+		{
+			{
+				/*ʱֻܱ̻߳ڰ鸴Ƴ*/
+				lock_guard<recursive_mutex> guard(buffer_m_->get_mutex());
+				memcpy(&data[0], rm.GetBlockInfo(tb, blocks[b])->get_data(), data.size());
+			}
+			vector<int> offsets = rm.GetOffsets(tb, &data[0]);
+			for (auto j = offsets.begin(); j != offsets.end(); j++)
+			{
+				RecordView record(&layout, &data[0], *j);
+				runs[t].push_back(make_pair(BuildKey(tb, idx, record, blocks[b], *j), MAKE_RID(blocks[b], *j)));
+			}
+		}
+		stable_sort(runs[t].begin(), runs[t].end(), less_key);
+	};
+	vector<thread> workers;
+	for (int t = 1; t < threads; t++)
+		workers.push_back(thread(extract, t));
+	extract(0);
+	for (auto w = workers.begin(); w != workers.end(); w++)
+		w->join();
 
-	for (int i = 0; i < tb->get_block_count(); i++)						/*ѭп*/
+	while (runs.size() > 1)
 	{
-		BlockInfo *bp = rm->GetBlockInfo(tb, block_num);				/*ȡblock_numϢ*/
-		for (int j = 0; j < bp->GetRecordCount(); j++)					/*ѭblock_numм¼*/
+		vector<Run> merged((runs.size() + 1) / 2);
+		vector<thread> mergers;
+		for (size_t i = 0; i + 1 < runs.size(); i += 2)
 		{
-			vector<TKey> tkey_value = rm->GetRecord(tb, block_num, j);	/*ȡblock_numеĵjݼ¼*/
-			tree.add(tkey_value[col_idx], block_num, j);				/*col_idxԲB+*/
+			mergers.push_back(thread([&, i]()
+			{
+				merged[i / 2].reserve(runs[i].size() + runs[i + 1].size());
+				merge(runs[i].begin(), runs[i].end(), runs[i + 1].begin(), runs[i + 1].end(), back_inserter(merged[i / 2]), less_key);
+				Run().swap(runs[i]);
+				Run().swap(runs[i + 1]);
+			}));
+		}
+		if (runs.size() % 2 == 1) merged.back().swap(runs.back());
+		for (auto m = mergers.begin(); m != mergers.end(); m++)
+			m->join();
+		runs.swap(merged);
+	}
+	Run entries;
+	entries.swap(runs[0]);
+	return entries;
+}
+
+/*һ¼idxеļ*/
+TKey IndexManager::BuildKey(Table* tb, Index* idx, vector<TKey>& tuple, int block_num, int offset)
+{
+	vector<TKey*> fields;
+	for (auto value = tuple.begin(); value != tuple.end(); value++)
+		fields.push_back(&*value);
+	return EncodeKey(tb, idx, fields, block_num, offset);
+}
+
+TKey IndexManager::BuildKey(Table* tb, Index* idx, RecordView& record, int block_num, int offset)
+{
+	vector<string> cols = idx->get_attr_names(), includes = idx->get_include_names();
+	cols.insert(cols.end(), includes.begin(), includes.end());
+	vector<TKey> copies;
+	copies.reserve(cols.size());/*fieldsдcopiesԪصĵַ·*/
+	vector<TKey*> fields(tb->GetAttributeNum(), NULL);
+	for (auto col = cols.begin(); col != cols.end(); col++)
+	{
+		int i = tb->GetAttributeIndex(*col);
+		if (fields[i] != NULL) continue;
+		copies.push_back(record.GetKey(i));
+		fields[i] = &copies.back();
+	}
+	return EncodeKey(tb, idx, fields, block_num, offset);
+}
+
+TKey IndexManager::EncodeKey(Table* tb, Index* idx, vector<TKey*>& fields, int block_num, int offset)
+{
+	if (idx->get_key_type() != T_BINARY) return *fields[tb->GetAttributeIndex(idx->get_attr_name())];
+
+	/* ΨһB+ֶεıƴ + ˴ŵļ¼ֵַͬļ¼ַУϣǰ׺ѹʽΨһûм¼ַ */
+	bool compact = idx->get_node_format() == NODE_FORMAT_COMPACT;
+	vector<char> buf(idx->get_key_len());
+	char *p = &buf[0];
+	vector<string> cols = idx->get_attr_names();
+	for (auto col = cols.begin(); col != cols.end(); col++)
+	{
+		TKey &value = *fields[tb->GetAttributeIndex(*col)];
+		if (compact) p += value.EncodeCompact(p);
+		else
+		{
+			value.Encode(p);
+			p += value.get_length();
+		}
+	}
+	if (idx->get_index_type() != INDEX_HASH && !idx->is_unique())
+	{
+		RID rid = MAKE_RID(block_num, offset);
+		int rid_len = idx->get_rid_len();
+		for (int i = 0; i < rid_len; i++)
+			p[i] = (char)(rid >> (8 * (rid_len - 1 - i)));
+		p += rid_len;
+	}
+	/* includeֶεıǰĲѻͬǲӰ˳ */
+	vector<string> includes = idx->get_include_names();
+	for (auto col = includes.begin(); col != includes.end(); col++)
+		p += fields[tb->GetAttributeIndex(*col)]->EncodeCompact(p);
+	TKey key(T_BINARY, p - &buf[0]);
+	memcpy(key.get_key(), &buf[0], key.get_length());
+	return key;
+}
+
+/*idxҶǷcolumnsеֶΡֻǰ׺ѹʽB+ARTļԻԭֵֶ*/
+bool IndexManager::Covers(Table* tb, Index* idx, vector<int>& columns)
+{
+	if (idx->get_index_type() == INDEX_HASH || idx->get_node_format() != NODE_FORMAT_COMPACT) return false;
+	vector<string> cols = idx->get_attr_names(), includes = idx->get_include_names();
+	cols.insert(cols.end(), includes.begin(), includes.end());
+	for (auto i = columns.begin(); i != columns.end(); i++)
+	{
+		if (find(cols.begin(), cols.end(), tb->GetAttributes()[*i].get_attr_name()) == cols.end())
+			return false;
+	}
+	return true;
+}
+
+/*BuildKeyĲνֶΣֶΡΨһģ¼ַincludeֶ*/
+vector<TKey> IndexManager::DecodeKey(Table* tb, Index* idx, TKey& key)
+{
+	vector<TKey> tuple;
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (auto attr = attrs.begin(); attr != attrs.end(); attr++)
+	{
+		TKey value(attr->get_data_type(), attr->get_length());
+		memset(value.get_key(), 0, value.get_length());
+		tuple.push_back(value);
+	}
+	const char *p = key.get_key();
+	vector<string> cols = idx->get_attr_names();
+	for (auto col = cols.begin(); col != cols.end(); col++)
+		p += tuple[tb->GetAttributeIndex(*col)].DecodeCompact(p);
+	if (!idx->is_unique()) p += idx->get_rid_len();
+	vector<string> includes = idx->get_include_names();
+	for (auto col = includes.begin(); col != includes.end(); col++)
+		p += tuple[tb->GetAttributeIndex(*col)].DecodeCompact(p);
+	return tuple;
+}
+
+/*һ¼idx*/
+void IndexManager::InsertEntry(Table* tb, Index* idx, vector<TKey>& tuple, int block_num, int offset)
+{
+	TKey key = BuildKey(tb, idx, tuple, block_num, offset);
+	if (idx->get_index_type() == INDEX_HASH)
+	{
+		HashIndex hash(idx, buffer_m_, catalog_m_, db_name_);
+		hash.add(key, block_num, offset);
+	}
+	else if (idx->get_index_type() == INDEX_ART) GetArt(tb, idx)->add(key, MAKE_RID(block_num, offset));
+	else
+	{
+		BPlusTree tree(idx, buffer_m_, catalog_m_, db_name_);
+		tree.add(key, block_num, offset);
+	}
+}
+
+/*һ¼idxɾ*/
+void IndexManager::RemoveEntry(Table* tb, Index* idx, vector<TKey>& tuple, int block_num, int offset)
+{
+	TKey key = BuildKey(tb, idx, tuple, block_num, offset);
+	if (idx->get_index_type() == INDEX_HASH)
+	{
+		HashIndex hash(idx, buffer_m_, catalog_m_, db_name_);
+		hash.remove(key, block_num, offset);
+	}
+	else if (idx->get_index_type() == INDEX_ART) GetArt(tb, idx)->remove(key);
+	else
+	{
+		BPlusTree tree(idx, buffer_m_, catalog_m_, db_name_);
+		tree.remove(key);
+	}
+}
+
+/*B+ļĩβĿп飬˳֮ǰҶӵһҶӿ*/
+int IndexManager::VacuumIndex(Index* idx)
+{
+	if (idx->get_index_type() != INDEX_BTREE) return 0;
+	BPlusTree tree(idx, buffer_m_, catalog_m_, db_name_);
+	tree.link_prev_leaves();
+	return tree.vacuum();
+}
+
+/*һ¼ϵԼ¡*/
+void IndexManager::InsertEntries(Table* tb, vector<TKey>& tuple, int block_num, int offset)
+{
+	for (unsigned int i = 0; i < tb->GetIndexNum(); i++)
+		InsertEntry(tb, tb->GetIndex(i), tuple, block_num, offset);
+	if (tb->get_bloom_attr() != "")
+	{
+		BloomFilter bloom(tb, buffer_m_, db_name_);
+		bloom.Add(tuple[tb->GetAttributeIndex(tb->get_bloom_attr())]);
+	}
+}
+
+/*һ¼ӱϵԼ¡ɾ*/
+void IndexManager::RemoveEntries(Table* tb, vector<TKey>& tuple, int block_num, int offset)
+{
+	for (unsigned int i = 0; i < tb->GetIndexNum(); i++)
+		RemoveEntry(tb, tb->GetIndex(i), tuple, block_num, offset);
+	if (tb->get_bloom_attr() != "")
+	{
+		BloomFilter bloom(tb, buffer_m_, db_name_);
+		bloom.Remove(tuple[tb->GetAttributeIndex(tb->get_bloom_attr())]);
+	}
+}
+
+/*½¡ļлûйĿ飬ڻ㣬ټеÿ¼*/
+void IndexManager::CreateBloom(Table* tb, string attr_name, int blocks)
+{
+	string file_name = catalog_m_->get_path() + db_name_ + "/" + tb->get_tb_name() + ".bloom";
+	ofstream ofs(file_name.c_str(), ios::binary);
+	ofs.close();
+
+	tb->SetBloom(attr_name, blocks);
+	BloomFilter bloom(tb, buffer_m_, db_name_);
+	bloom.Clear();
+	int column = tb->GetAttributeIndex(attr_name);
+	RecordManager *rm = new RecordManager(catalog_m_, buffer_m_, db_name_);
+	RecordLayout layout(tb);
+	int block_num = tb->get_first_block_num();
+	while (block_num != -1)
+	{
+		BlockInfo *bp = rm->GetBlockInfo(tb, block_num);
+		vector<int> offsets = rm->GetOffsets(tb, bp->get_data());
+		for (auto j = offsets.begin(); j != offsets.end(); j++)
+		{
+			TKey value = RecordView(&layout, bp->get_data(), *j).GetKey(column);
+			bloom.Add(value);
 		}
 		block_num = bp->GetNextBlockNum();
 	}
 	delete rm;
 
-	buffer_m_->WriteToDisk();											/*B+ڵĻдش*/
+	buffer_m_->WriteToDisk();
 	catalog_m_->WriteArchiveFile();
+}
+
+/*ĵcolumnֶûв¡Ϊvalueܴ*/
+bool IndexManager::MayContain(Table* tb, int column, TKey& value)
+{
+	if (tb->get_bloom_attr() == "" || tb->GetAttributeIndex(tb->get_bloom_attr()) != column) return true;
+	BloomFilter bloom(tb, buffer_m_, db_name_);
+	return bloom.MayContain(value);
+}
 
-	tree.print();
+/*ڹֶεĵֵֶ=һֵһڣѯΪ*/
+bool IndexManager::BloomExcludes(Table* tb, vector<SQLWhere>& wheres)
+{
+	if (tb->get_bloom_attr() == "") return false;
+	int column = tb->GetAttributeIndex(tb->get_bloom_attr());
+	Attribute *attr = tb->GetAttribute(tb->get_bloom_attr());
+	for (auto where = wheres.begin(); where != wheres.end(); where++)
+	{
+		if (where->op_type != SIGN_EQ || where->key_2 != "" || tb->GetAttributeIndex(where->key_1) != column) continue;
+		TKey value(attr->get_data_type(), attr->get_length());
+		value.ReadValue(where->value);
+		if (!MayContain(tb, column, value)) return true;
+	}
+	return false;
+}
+
+/*ؽֶattr_nameϵΨһϣڴеARTҸ죬ȷ*/
+Index* IndexManager::GetUniqueIndex(Table* tb, string attr_name)
+{
+	Index *ans = NULL;
+	for (unsigned int i = 0; i < tb->GetIndexNum(); i++)
+	{
+		Index *idx = tb->GetIndex(i);
+		if (!idx->is_unique() || idx->get_attr_name() != attr_name) continue;
+		if (idx->get_index_type() != INDEX_BTREE) return idx;
+		ans = idx;
+	}
+	return ans;
+}
+
+/*ɱֽڹѯ߽磺ʽfillkey_lenǰ׺ѹʽļǱ䳤ģbytesΪǰ׺ļСbytes
+  СbytesӱļFF..FF½粻Ͻ粹FF*/
+static TKey MakeBound(string bytes, Index *idx, char fill)
+{
+	int len = idx->get_key_len();
+	if (idx->get_node_format() == NODE_FORMAT_COMPACT) len = fill == 0 ? bytes.size() : len + 1;
+	TKey key(T_BINARY, len);
+	memset(key.get_key(), fill, len);
+	memcpy(key.get_key(), bytes.data(), bytes.size());
+	return key;
+}
+
+/*ΨһidxǷֵֶvalue*/
+bool IndexManager::ContainsKey(Table* tb, Index* idx, TKey& value)
+{
+	if (idx->get_index_type() == INDEX_HASH)
+	{
+		HashIndex hash(idx, buffer_m_, catalog_m_, db_name_);
+		TKey key(T_BINARY, idx->get_key_len());
+		value.Encode(key.get_key());
+		return !hash.search(key).empty();
+	}
+	if (idx->get_key_type() != T_BINARY)
+	{
+		BPlusTree tree(idx, buffer_m_, catalog_m_, db_name_);
+		return tree.get_value(value) != -1;
+	}
+	vector<char> buf(idx->get_key_len());
+	string bytes(&buf[0], value.EncodeCompact(&buf[0]));
+	TKey key = MakeBound(bytes, idx, 0x00);
+	if (idx->get_include_names().empty())
+	{
+		if (idx->get_index_type() == INDEX_ART) return GetArt(tb, idx)->get_value(key) != -1;
+		BPlusTree tree(idx, buffer_m_, catalog_m_, db_name_);
+		return tree.get_value(key) != -1;
+	}
+	/* ļ󻹽includeֶΣԸֵΪǰ׺ļ */
+	TKey high = MakeBound(bytes, idx, (char)0xff);
+	return !Range(tb, idx, &key, true, &high, true, NULL, false, 1).empty();
+}
+
+/*Χɨ裬ͷɸB+ARTafterڷΧ֮ڣŶʱΪȺŵʼ߽*/
+vector<RID> IndexManager::Range(Table* tb, Index* idx, TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys, bool reverse, int limit, TKey *after)
+{
+	if (after != NULL && reverse)
+	{
+		high = after;
+		high_eq = false;
+	}
+	else if (after != NULL)
+	{
+		low = after;
+		low_eq = false;
+	}
+	if (idx->get_index_type() == INDEX_ART) return GetArt(tb, idx)->get_range(low, low_eq, high, high_eq, keys, reverse, limit);
+	BPlusTree tree(idx, buffer_m_, catalog_m_, db_name_);
+	if (reverse) return tree.get_range_reverse(low, low_eq, high, high_eq, keys, limit);
+	return tree.get_range(low, low_eq, high, high_eq, keys, limit);
+}
+
+/*еһõARTʱգЧʱм¼ؽ*/
+ArtIndex* IndexManager::GetArt(Table* tb, Index* idx)
+{
+	static mutex build_mutex;
+	lock_guard<mutex> guard(build_mutex);
+	ArtIndex *art = ArtIndex::Find(db_name_, idx->get_name());
+	if (art != NULL) return art;
+	art = ArtIndex::Open(db_name_, idx->get_name(), catalog_m_->get_path() + db_name_ + "/" + idx->get_name() + ".index");
+	if (art->LoadSnapshot()) return art;
+
+	RecordManager rm(catalog_m_, buffer_m_, db_name_);
+	RecordLayout layout(tb);
+	int block_num = tb->get_first_block_num();
+	while (block_num != -1)
+	{
+		BlockInfo *bp = rm.GetBlockInfo(tb, block_num);
+		vector<int> offsets = rm.GetOffsets(tb, bp->get_data());
+		for (auto j = offsets.begin(); j != offsets.end(); j++)
+		{
+			RecordView record(&layout, bp->get_data(), *j);
+			TKey key = BuildKey(tb, idx, record, block_num, *j);
+			art->add(key, MAKE_RID(block_num, *j));
+		}
+		block_num = bp->GetNextBlockNum();
+	}
+	return art;
+}
+
+/*wheresֶcolĵֵΧ*/
+int IndexManager::FindWhere(vector<SQLWhere>& wheres, string col, bool eq)
+{
+	for (unsigned int j = 0; j < wheres.size(); j++)
+	{
+		if (wheres[j].key_2 != "" || wheres[j].key_1 != col || wheres[j].op_type == SIGN_NE)
+			continue;
+		if ((wheres[j].op_type == SIGN_EQ) == eq)
+			return j;
+	}
+	return -1;
+}
+
+/*Ϊwhereѡʵӵһֶ𱻵ֵǵֶԽԽãٽһһֶεķΧ
+  Ψһϵĵֵѯ෵һ¼ͬȣϣֶֻζǵֵĲѯͬB+
+  ARTڴУͬҲB+
+  ܸǲѯֶεûر¼ͬʱ*/
+int IndexManager::ChooseIndex(Table* tb, vector<SQLWhere>& wheres, vector<int> &where_idxs, vector<int> *columns)
+{
+	int best = -1, best_score = 0;
+	for (unsigned int i = 0; i < tb->GetIndexNum(); i++)
+	{
+		Index *idx = tb->GetIndex(i);
+		vector<string> cols = idx->get_attr_names();
+		vector<int> used;
+		int score = 0;
+		while (used.size() < cols.size())
+		{
+			int j = FindWhere(wheres, cols[used.size()], true);
+			if (j == -1) break;
+			used.push_back(j);
+			score += 4;
+		}
+		if (used.size() < cols.size())
+		{
+			int j = FindWhere(wheres, cols[used.size()], false);
+			if (j != -1)
+			{
+				used.push_back(j);
+				score += 2;
+			}
+		}
+		else if (idx->is_unique()) score += 1;
+		if (idx->get_index_type() == INDEX_HASH)
+		{
+			if (used.size() != cols.size() || wheres[used.back()].op_type != SIGN_EQ) continue;
+			score += 1;
+		}
+		else if (idx->get_index_type() == INDEX_ART && !used.empty()) score += 1;
+		score *= 2;
+		if (columns != NULL && !used.empty() && Covers(tb, idx, *columns)) score += 1;
+
+		if (score > best_score)
+		{
+			best_score = score;
+			best = i;
+			where_idxs = used;
+		}
+	}
+	return best;
+}
+
+
+/*idx˳򷵻صļ¼ǷҲֶcolumnwhere_idxsеĵ̶ֵǰֶΣĵһֶξcolumn*/
+bool IndexManager::Orders(Index* idx, vector<SQLWhere>& wheres, vector<int>& where_idxs, string column)
+{
+	if (idx->get_index_type() == INDEX_HASH) return false;
+	vector<string> cols = idx->get_attr_names();
+	unsigned int eq_num = 0;
+	while (eq_num < where_idxs.size() && wheres[where_idxs[eq_num]].op_type == SIGN_EQ) eq_num++;
+	return eq_num < cols.size() && cols[eq_num] == column;
+}
+
+/*һֶΪcolumnܸcolumns*/
+int IndexManager::ChooseOrderIndex(Table* tb, string column, vector<int> *columns)
+{
+	int best = -1;
+	vector<SQLWhere> no_wheres;
+	vector<int> no_idxs;
+	for (unsigned int i = 0; i < tb->GetIndexNum(); i++)
+	{
+		Index *idx = tb->GetIndex(i);
+		if (!Orders(idx, no_wheres, no_idxs, column)) continue;
+		if (columns != NULL && Covers(tb, idx, *columns)) return i;
+		if (best == -1) best = i;
+	}
+	return best;
+}
+
+/*idxѯм¼ַΨһеֵǰ׺ΪPļλ[P00..00, PFF..FF]֮䣬
+  һֶεķΧvٰvıP֮>v  (Pv FF..FF, PFF..FF]<v  [P00..00, Pv00..00)*/
+vector<RID> IndexManager::SearchIndex(Table* tb, Index* idx, vector<SQLWhere>& wheres, vector<int>& where_idxs, vector<TKey> *keys, bool reverse, int limit, TKey *after)
+{
+	vector<string> cols = idx->get_attr_names();
+	/* û˳order by */
+	if (where_idxs.empty()) return Range(tb, idx, NULL, false, NULL, false, keys, reverse, limit, after);
+	/* ϣֶζǵֵֶ˳ƴֱӲ */
+	if (idx->get_index_type() == INDEX_HASH)
+	{
+		HashIndex hash(idx, buffer_m_, catalog_m_, db_name_);
+		TKey key(T_BINARY, idx->get_key_len());
+		int pos = 0;
+		for (unsigned int i = 0; i < cols.size(); i++)
+		{
+			Attribute *attr = tb->GetAttribute(cols[i]);
+			TKey value(attr->get_data_type(), attr->get_length());
+			value.ReadValue(wheres[where_idxs[i]].value);
+			value.Encode(key.get_key() + pos);
+			pos += attr->get_length();
+		}
+		return hash.search(key);
+	}
+
+	int eq_num = where_idxs.size();
+	SQLWhere *range = NULL;
+	if (wheres[where_idxs[eq_num - 1]].op_type != SIGN_EQ)
+	{
+		range = &wheres[where_idxs[eq_num - 1]];
+		eq_num--;
+	}
+
+	/* ʽΨһֻһֶΣֵֶ */
+	if (idx->get_key_type() != T_BINARY)
+	{
+		SQLWhere &where = wheres[where_idxs[0]];
+		Attribute *attr = tb->GetAttribute(idx->get_attr_name());
+		TKey value(attr->get_data_type(), attr->get_length());
+		value.ReadValue(where.value);
+		switch (where.op_type)
+		{
+		case SIGN_EQ: return Range(tb, idx, &value, true, &value, true, keys, reverse, limit, after);
+		case SIGN_GT: return Range(tb, idx, &value, false, NULL, false, keys, reverse, limit, after);
+		case SIGN_GE: return Range(tb, idx, &value, true, NULL, false, keys, reverse, limit, after);
+		case SIGN_LT: return Range(tb, idx, NULL, false, &value, false, keys, reverse, limit, after);
+		case SIGN_LE: return Range(tb, idx, NULL, false, &value, true, keys, reverse, limit, after);
+		default: return vector<RID>();
+		}
+	}
+
+	bool compact = idx->get_node_format() == NODE_FORMAT_COMPACT;
+	vector<char> buf(idx->get_key_len());
+	string prefix;
+	for (int i = 0; i < eq_num; i++)
+	{
+		Attribute *attr = tb->GetAttribute(cols[i]);
+		TKey value(attr->get_data_type(), attr->get_length());
+		value.ReadValue(wheres[where_idxs[i]].value);
+		if (compact) prefix.append(&buf[0], value.EncodeCompact(&buf[0]));
+		else
+		{
+			value.Encode(&buf[0]);
+			prefix.append(&buf[0], attr->get_length());
+		}
+	}
+	TKey low = MakeBound(prefix, idx, 0x00), high = MakeBound(prefix, idx, (char)0xff);
+	if (range == NULL) return Range(tb, idx, &low, true, &high, true, keys, reverse, limit, after);
+
+	Attribute *attr = tb->GetAttribute(cols[eq_num]);
+	TKey value(attr->get_data_type(), attr->get_length());
+	value.ReadValue(range->value);
+	string bound = prefix;
+	if (compact) bound.append(&buf[0], value.EncodeCompact(&buf[0]));
+	else
+	{
+		value.Encode(&buf[0]);
+		bound.append(&buf[0], attr->get_length());
+	}
+	TKey bound_low = MakeBound(bound, idx, 0x00), bound_high = MakeBound(bound, idx, (char)0xff);
+	switch (range->op_type)
+	{
+	case SIGN_GT: return Range(tb, idx, &bound_high, false, &high, true, keys, reverse, limit, after);
+	case SIGN_GE: return Range(tb, idx, &bound_low, true, &high, true, keys, reverse, limit, after);
+	case SIGN_LT: return Range(tb, idx, &low, true, &bound_low, false, keys, reverse, limit, after);
+	case SIGN_LE: return Range(tb, idx, &low, true, &bound_high, true, keys, reverse, limit, after);
+	default: return vector<RID>();
+	}
+}
+
+IndexCursor::IndexCursor(IndexManager* im, Table* tb, Index* idx, vector<SQLWhere>& wheres, vector<int>& where_idxs, bool reverse, int limit)
+	: im_(im), tb_(tb), idx_(idx), wheres_(wheres), where_idxs_(where_idxs), reverse_(reverse), remaining_(limit), done_(false) {}
+
+Table* IndexCursor::get_table() { return tb_; }
+Index* IndexCursor::get_index() { return idx_; }
+
+/*ϣֻһβм¼ַûһҶӵľB+ɨʱҪ˳ΧҲһζ*/
+bool IndexCursor::Fetch(int n, vector<RID>& rids, vector<TKey> *keys)
+{
+	if (done_ || remaining_ == 0) return false;
+	if (idx_->get_index_type() == INDEX_HASH || (reverse_ && idx_->get_index_type() == INDEX_BTREE && !idx_->has_prev_links())) n = -1;
+	if (remaining_ >= 0 && (n < 0 || n > remaining_)) n = remaining_;
+	vector<TKey> found;
+	vector<RID> values = im_->SearchIndex(tb_, idx_, wheres_, where_idxs_, &found, reverse_, n, last_.empty() ? NULL : &last_[0]);
+	if (n < 0 || (int)values.size() < n || idx_->get_index_type() == INDEX_HASH) done_ = true;
+	if (remaining_ >= 0) remaining_ -= values.size();
+	if (!found.empty()) last_.assign(1, found.back());
+	rids.insert(rids.end(), values.begin(), values.end());
+	if (keys != NULL) keys->insert(keys->end(), found.begin(), found.end());
+	return !values.empty() || !done_;
 }
\ No newline at end of file
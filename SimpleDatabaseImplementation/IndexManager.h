@@ -11,6 +11,8 @@
 #include "CatalogManager.h"
 #include "BufferManager.h"
 #include "BPlusTree.h"
+#include "ArtIndex.h"
+#include "RecordView.h"
 
 using namespace std;
 
@@ -20,10 +22,84 @@ public:
 	IndexManager(CatalogManager *cm, BufferManager *bm, string dbname);
 	~IndexManager(void);
 	void CreateIndex(SQLCreateIndex& st);
+	//̶߳м¼idxеļ¼ַź򷵻أthreadsΪ߳
+	vector<pair<TKey, RID> > SortedEntries(Table* tb, Index* idx, int threads);
+	//һ¼idxеļΨһΪֵֶΨһΪֶαƴ+¼ַٽincludeֶεı
+	TKey BuildKey(Table* tb, Index* idx, vector<TKey>& tuple, int block_num, int offset);
+	//ͬϣ¼Ϊеͼֻõֶ
+	TKey BuildKey(Table* tb, Index* idx, RecordView& record, int block_num, int offset);
+	//idxҶǷcolumnsеֶΣе±ֻ꣩شѯ
+	bool Covers(Table* tb, Index* idx, vector<int>& columns);
+	//ǰ׺ѹʽеļԭ¼еֶΣûеֶ0
+	vector<TKey> DecodeKey(Table* tb, Index* idx, TKey& key);
+	//һ¼ϵԼ¡
+	void InsertEntries(Table* tb, vector<TKey>& tuple, int block_num, int offset);
+	//һ¼ӱϵԼ¡ɾ
+	void RemoveEntries(Table* tb, vector<TKey>& tuple, int block_num, int offset);
+	//ؽֶattr_nameϵΨһû򷵻NULL
+	Index* GetUniqueIndex(Table* tb, string attr_name);
+	//ΨһidxǷֵֶvalueͻ
+	bool ContainsKey(Table* tb, Index* idx, TKey& value);
+	//Ϊwhereѡʵڱбеλãûпʱ-1
+	//where_idxsΪǰ׺ֶεĵֵܻһһֶεķΧ
+	//columnsΪNULLʱΪѯõֶΣͬʱѡܸЩֶε
+	int ChooseIndex(Table* tb, vector<SQLWhere>& wheres, vector<int> &where_idxs, vector<int> *columns = NULL);
+	//idxѯwhere_idxsм¼ַConstValue.hеRIDkeysΪNULLʱͬʱضӦļB+ART
+	//˳УreverseΪtrueʱӴСlimit>=0ʱ෵limitwhere_idxsΪʱ˳򷵻
+	//afterΪNULLʱֻذ˳ڼafter֮ģϣ֧֣
+	vector<RID> SearchIndex(Table* tb, Index* idx, vector<SQLWhere>& wheres, vector<int>& where_idxs, vector<TKey> *keys = NULL, bool reverse = false, int limit = -1, TKey *after = NULL);
+	//SearchIndexصļ¼Ƿֶcolumnwhere_idxs֮ĵһֶξcolumn
+	bool Orders(Index* idx, vector<SQLWhere>& wheres, vector<int>& where_idxs, string column);
+	//ûпwhereʱΪorder byѡһֶΪcolumnû򷵻-1
+	int ChooseOrderIndex(Table* tb, string column, vector<int> *columns = NULL);
+	//ڱֶ½¡еļ¼
+	void CreateBloom(Table* tb, string attr_name, int blocks);
+	//ĵcolumnֶûв¡Ϊvalueܴʱtrue
+	bool MayContain(Table* tb, int column, TKey& value);
+	//wheresڲ¡ֶεĵֵҹжֵڣѯһΪ
+	bool BloomExcludes(Table* tb, vector<SQLWhere>& wheres);
+	//B+ļĩβĿп飬ػյĿļɵ߽ض̵idxmax_count飻ϣͷſ飬0
+	//֮ǰB+ûһҶӿţͬʱϣ֮ɨ
+	int VacuumIndex(Index* idx);
 private:
+	//һ¼idx / idxɾͷɸB+ϣ
+	void InsertEntry(Table* tb, Index* idx, vector<TKey>& tuple, int block_num, int offset);
+	void RemoveEntry(Table* tb, Index* idx, vector<TKey>& tuple, int block_num, int offset);
+	//Χɨ裬ͬBPlusTree::get_rangereverseΪtrueʱafterͬSearchIndexͷɸB+ART
+	vector<RID> Range(Table* tb, Index* idx, TKey *low, bool low_eq, TKey *high, bool high_eq, vector<TKey> *keys, bool reverse = false, int limit = -1, TKey *after = NULL);
+	//BuildKeyʵ֣fieldsΪ¼иֶεָ루òֶοΪNULL
+	TKey EncodeKey(Table* tb, Index* idx, vector<TKey*>& fields, int block_num, int offset);
+	//ڴеARTеһõʱɿնɱеļ¼ؽ
+	ArtIndex* GetArt(Table* tb, Index* idx);
+	//wheresֶcolĵֵeqΪtrueΧeqΪfalseҲ-1
+	int FindWhere(vector<SQLWhere>& wheres, string col, bool eq);
+
 	CatalogManager* catalog_m_;
 	BufferManager* buffer_m_;
 	string db_name_;
 };
 
+//ɨα꣺SearchIndex˳ļ¼ַÿһһһ֮½
+//һζΧ߲ҪʱͲٶҶӡB+ARTеļͬΨһļм¼ַ
+class IndexCursor
+{
+public:
+	//ͬSearchIndexlimit>=0ʱһlimit
+	IndexCursor(IndexManager* im, Table* tb, Index* idx, vector<SQLWhere>& wheres, vector<int>& where_idxs, bool reverse = false, int limit = -1);
+	//ٶnn<0ʱʣµģ׷ӵridskeysΪNULLʱ֮Ѿ˷false
+	bool Fetch(int n, vector<RID>& rids, vector<TKey> *keys = NULL);
+	Table* get_table();
+	Index* get_index();
+private:
+	IndexManager *im_;
+	Table *tb_;
+	Index *idx_;
+	vector<SQLWhere> wheres_;
+	vector<int> where_idxs_;
+	bool reverse_;
+	int remaining_;								/*ܶĸ-1Ϊ*/
+	vector<TKey> last_;							/*һһûʱΪ*/
+	bool done_;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+//飺дŵļ¼ҳPAX
+//ã¼ĸֶηֱڿڸֶεСҳУдһ¼ҪÿСҳͬһ
+#include "PaxPage.h"
+
+#include <cstring>
+
+using namespace std;
+
+int PaxPage::Capacity(Table* tb) { return (4096 - PAX_HEADER) / tb->get_record_length(); }
+
+char* PaxPage::Column(Table* tb, char *data, int col)
+{
+	int before = 0;
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (int i = 0; i < col; i++)
+		before += attrs[i].get_length();
+	return data + PAX_HEADER + Capacity(tb) * before;
+}
+
+void PaxPage::Put(Table* tb, char *data, int row, vector<TKey>& tuple)
+{
+	char *minipage = data + PAX_HEADER;
+	int capacity = Capacity(tb);
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (unsigned int i = 0; i < attrs.size(); i++)
+	{
+		int len = attrs[i].get_length();
+		memcpy(minipage + row * len, tuple[i].get_key(), len);
+		minipage += capacity * len;
+	}
+}
+
+void PaxPage::Move(Table* tb, char *data, int from, int to)
+{
+	char *minipage = data + PAX_HEADER;
+	int capacity = Capacity(tb);
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (auto attr = attrs.begin(); attr != attrs.end(); attr++)
+	{
+		int len = attr->get_length();
+		memcpy(minipage + to * len, minipage + from * len, len);
+		minipage += capacity * len;
+	}
+}
+
+void PaxPage::SetField(Table* tb, char *data, int row, int col, TKey& value)
+{
+	int len = tb->GetAttributes()[col].get_length();
+	memcpy(Column(tb, data, col) + row * len, value.get_key(), len);
+}
@@ -0,0 +1,31 @@
+//飺дŵļ¼ҳPAX
+//ãڰֶηֳСҳminipageÿСҳǸֶڱм¼ֵɵĶ飬ֻõһֶεɨۼֶֻεСҳ
+#pragma once
+#ifndef _PAXPAGE_H_
+#define _PAXPAGE_H_
+
+#include <vector>
+
+#include "CatalogManager.h"
+#include "SQLStatement.h"
+
+using namespace std;
+
+/*
+ҳ0-11ֽ붨ҳͬһ顢һ顢¼ܷŵļ¼Ҳ붨ҳͬ(4096 - 12) / ¼ȡ
+ΪֶεСҳiֶεСҳ 12 +  * (ǰiֶεĳ֮) ʼk¼ĸֶСҳĵk
+¼ַĿƫƾкţ붨ҳһɾʱѿһ¼Ƶɾλá
+*/
+#define PAX_HEADER 12
+
+class PaxPage
+{
+public:
+	static int Capacity(Table* tb);										/*ÿܷŵļ¼*/
+	static char* Column(Table* tb, char *data, int col);				/*colֶεСҳ*/
+	static void Put(Table* tb, char *data, int row, vector<TKey>& tuple);	/*Ѽ¼дrow*/
+	static void Move(Table* tb, char *data, int from, int to);			/*ѵfromиƵto*/
+	static void SetField(Table* tb, char *data, int row, int col, TKey& value);	/*޸ĵrowеĵcolֶΣֶεĶȡRecordView*/
+};
+
+#endif
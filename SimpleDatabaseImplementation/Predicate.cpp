@@ -0,0 +1,213 @@
+//飺where
+//ãֶȽػıȽϽڵ㣬ȽϵĽTKeyıȽͬ<=Ϊڡ>=ΪСڡ
+#include "Predicate.h"
+#include "Exceptions.h"
+#include "ConstValue.h"
+#include "FilterKernels.h"
+
+#include <cstring>
+
+using namespace std;
+
+/*Ƚ㣬aΪ¼ֶΣbΪsignΪں˵*/
+struct OpEQ { enum { sign = SIGN_EQ }; template<class T> static bool Test(T a, T b) { return a == b; } };
+struct OpNE { enum { sign = SIGN_NE }; template<class T> static bool Test(T a, T b) { return !(a == b); } };
+struct OpLT { enum { sign = SIGN_LT }; template<class T> static bool Test(T a, T b) { return a < b; } };
+struct OpGT { enum { sign = SIGN_GT }; template<class T> static bool Test(T a, T b) { return a > b; } };
+struct OpLE { enum { sign = SIGN_LE }; template<class T> static bool Test(T a, T b) { return !(a > b); } };
+struct OpGE { enum { sign = SIGN_GE }; template<class T> static bool Test(T a, T b) { return !(a < b); } };
+
+template<class Op>
+class IntPredicate : public Predicate
+{
+public:
+	IntPredicate(int col, TKey& value) : col_(col) { value_ = *((int*)value.get_key()); }
+	bool Evaluate(RecordView& record) { return Op::Test(record.GetInt(col_), value_); }
+	bool Filter(RecordLayout* layout, char* data, int n, unsigned long long* bits)
+	{
+		FilterKernels::Int(layout->Column(data, col_), layout->get_stride(col_), n, Op::sign, value_, bits);
+		return true;
+	}
+private:
+	int col_;
+	int value_;
+};
+
+template<class Op>
+class FloatPredicate : public Predicate
+{
+public:
+	FloatPredicate(int col, TKey& value) : col_(col) { value_ = *((float*)value.get_key()); }
+	bool Evaluate(RecordView& record) { return Op::Test(record.GetFloat(col_), value_); }
+	bool Filter(RecordLayout* layout, char* data, int n, unsigned long long* bits)
+	{
+		FilterKernels::Float(layout->Column(data, col_), layout->get_stride(col_), n, Op::sign, value_, bits);
+		return true;
+	}
+private:
+	int col_;
+	float value_;
+};
+
+/*charֶΰstrncmpĽ0Ƚϣֻ=!=ֵ*/
+template<class Op>
+class CharPredicate : public Predicate
+{
+public:
+	CharPredicate(int col, TKey& value) : col_(col), value_(value), padded_(value.get_length() + 32, 0)
+	{
+		memcpy(&padded_[0], value.get_key(), value.get_length());
+	}
+	bool Evaluate(RecordView& record) { return Op::Test(record.CompareChars(col_, value_), 0); }
+	bool Filter(RecordLayout* layout, char* data, int n, unsigned long long* bits)
+	{
+		if (Op::sign != SIGN_EQ && Op::sign != SIGN_NE) return false;
+		FilterKernels::CharEqual(layout->Column(data, col_), layout->get_stride(col_), n, &padded_[0],
+			layout->get_length(col_), Op::sign == SIGN_EQ, data + layout->get_data_size(), bits);
+		return true;
+	}
+private:
+	int col_;
+	TKey value_;
+	vector<char> padded_;					/*֮320ں˿ζȡ*/
+};
+
+/*ֶ op ֶΣұߵֶθƳͱȽϣͬSatisfyWhere*/
+class ColumnPredicate : public Predicate
+{
+public:
+	ColumnPredicate(int col, int col_2, int op) : col_(col), col_2_(col_2), op_(op) {}
+	bool Evaluate(RecordView& record)
+	{
+		TKey value = record.GetKey(col_2_);
+		switch (op_)
+		{
+		case SIGN_EQ: return record.Equal(col_, value);
+		case SIGN_NE: return !record.Equal(col_, value);
+		case SIGN_LT: return record.Less(col_, value);
+		case SIGN_GT: return record.Greater(col_, value);
+		case SIGN_LE: return !record.Greater(col_, value);
+		case SIGN_GE: return !record.Less(col_, value);
+		default: return false;
+		}
+	}
+private:
+	int col_;
+	int col_2_;
+	int op_;
+};
+
+template<template<class> class Node>
+static Predicate* MakePredicate(int op, int col, TKey& value)
+{
+	switch (op)
+	{
+	case SIGN_EQ: return new Node<OpEQ>(col, value);
+	case SIGN_NE: return new Node<OpNE>(col, value);
+	case SIGN_LT: return new Node<OpLT>(col, value);
+	case SIGN_GT: return new Node<OpGT>(col, value);
+	case SIGN_LE: return new Node<OpLE>(col, value);
+	case SIGN_GE: return new Node<OpGE>(col, value);
+	default: return NULL;
+	}
+}
+
+/*ֶԴǰ׺t.age*/
+static int BindColumn(Table* tb, string name)
+{
+	int col = tb->GetAttributeIndex(name);
+	if (col == -1 && name.find('.') != string::npos) col = tb->GetAttributeIndex(name.substr(name.find('.') + 1));
+	if (col == -1) throw AttributeNotExistException();
+	return col;
+}
+
+/*ʶûнڵ㣬ͬSatisfyWhere*/
+class FalsePredicate : public Predicate
+{
+public:
+	bool Evaluate(RecordView& record) { return false; }
+	bool Filter(RecordLayout* layout, char* data, int n, unsigned long long* bits)
+	{
+		memset(bits, 0, FILTER_WORDS * sizeof(unsigned long long));
+		return true;
+	}
+};
+
+WherePredicate::WherePredicate(Table* tb, vector<SQLWhere>& wheres)
+{
+	/*Ȱֶɽڵ㣺ֶβʱûҪͷŵĽڵ*/
+	vector<int> cols, cols_2;
+	for (auto where = wheres.begin(); where != wheres.end(); where++)
+	{
+		cols.push_back(BindColumn(tb, where->key_1));
+		cols_2.push_back(where->key_2 != "" ? BindColumn(tb, where->key_2) : -1);
+	}
+	for (unsigned int i = 0; i < wheres.size(); i++)
+	{
+		int col = cols[i], op = wheres[i].op_type;
+		Predicate *term;
+		if (cols_2[i] != -1) term = new ColumnPredicate(col, cols_2[i], op);
+		else
+		{
+			Attribute &attr = tb->GetAttributes()[col];
+			TKey value(attr.get_data_type(), attr.get_length());
+			value.ReadValue(wheres[i].value.c_str());
+			if (attr.get_data_type() == T_INT) term = MakePredicate<IntPredicate>(op, col, value);
+			else if (attr.get_data_type() == T_FLOAT) term = MakePredicate<FloatPredicate>(op, col, value);
+			else term = MakePredicate<CharPredicate>(op, col, value);
+		}
+		terms_.push_back(term != NULL ? term : new FalsePredicate());
+	}
+}
+
+WherePredicate::~WherePredicate()
+{
+	for (auto term = terms_.begin(); term != terms_.end(); term++)
+		delete *term;
+}
+
+bool WherePredicate::Evaluate(RecordView& record)
+{
+	for (auto term = terms_.begin(); term != terms_.end(); term++)
+	{
+		if (!(*term)->Evaluate(record)) return false;
+	}
+	return true;
+}
+
+void WherePredicate::Filter(RecordLayout* layout, char* data, vector<int>& offsets)
+{
+	if (terms_.empty() || offsets.empty()) return;
+	vector<int> result;
+	if (layout->get_format() == PAGE_FORMAT_SLOTTED)
+	{
+		for (auto j = offsets.begin(); j != offsets.end(); j++)
+		{
+			RecordView record(layout, data, *j);
+			if (Evaluate(record)) result.push_back(*j);
+		}
+		offsets.swap(result);
+		return;
+	}
+	/*ҳPAXҳoffsetsΪ0n - 1Ϊѡһ*/
+	int n = offsets.back() + 1;
+	unsigned long long bits[FILTER_WORDS];
+	memset(bits, 0, sizeof(bits));
+	for (auto j = offsets.begin(); j != offsets.end(); j++)
+		bits[*j >> 6] |= 1ULL << (*j & 63);
+	vector<Predicate*> rest;
+	for (auto term = terms_.begin(); term != terms_.end(); term++)
+	{
+		if (!(*term)->Filter(layout, data, n, bits)) rest.push_back(*term);
+	}
+	for (int i = 0; i < n; i++)
+	{
+		if (!((bits[i >> 6] >> (i & 63)) & 1)) continue;
+		bool ok = true;
+		RecordView record(layout, data, i);
+		for (auto term = rest.begin(); ok && term != rest.end(); term++)
+			ok = (*term)->Evaluate(record);
+		if (ok) result.push_back(i);
+	}
+	offsets.swap(result);
+}
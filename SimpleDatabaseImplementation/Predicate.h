@@ -0,0 +1,44 @@
+//飺where
+//ãÿ俪ʼʱwhere󶨵һΣֶΪֶ±ֶֻ꣬һΣ
+//      ֶٰͣȽ㣩ɶӦıȽϽڵ㣬ɨʱֱڿбȽϼ¼ֶ
+#pragma once
+#ifndef _PREDICATE_H_
+#define _PREDICATE_H_
+
+#include <vector>
+
+#include "CatalogManager.h"
+#include "SQLStatement.h"
+#include "RecordView.h"
+
+using namespace std;
+
+/*һȽֶ op ֶ op ֶ*/
+class Predicate
+{
+public:
+	virtual ~Predicate() {}
+	virtual bool Evaluate(RecordView& record) = 0;
+	//ڶҳPAXҳlayoutΪĲ֣dataǰn¼һֵλͼbitsвλ0FilterKernels.h
+	//ֵfalseɵж
+	virtual bool Filter(RecordLayout* layout, char* data, int n, unsigned long long* bits) { return false; }
+};
+
+/*andӵwhereÿRecordManager::SatisfyWhereͬ*/
+class WherePredicate
+{
+public:
+	//󶨣whereеֶڱвʱ׳AttributeNotExistException
+	WherePredicate(Table* tb, vector<SQLWhere>& wheres);
+	~WherePredicate();
+	bool Evaluate(RecordView& record);
+	//offsetsΪdataм¼ĿƫƣRecordManager::GetOffsetsѡȥļ¼
+	//ҳPAXҳùںȽֶ볣ֻʣµļ¼ж
+	void Filter(RecordLayout* layout, char* data, vector<int>& offsets);
+private:
+	WherePredicate(const WherePredicate&);
+	WherePredicate& operator=(const WherePredicate&);
+	vector<Predicate*> terms_;
+};
+
+#endif
@@ -124,6 +124,10 @@ void  QueryParser::GetSqlType()
 		{
 			sql_type_ = 23;
 		}
+		else if (sql_vector_[1] == "bloom")/*sqlΪ½¡ Code:24*/
+		{
+			sql_type_ = 24;
+		}
 		else
 		{
 			sql_type_ = -1;
@@ -176,6 +180,10 @@ void  QueryParser::GetSqlType()
 		{
 			sql_type_ = 43;
 		}
+		else if (sql_vector_[1] == "bloom") /*sqlΪɾ¡ Code:44*/
+		{
+			sql_type_ = 44;
+		}
 		else
 		{
 			sql_type_ = -1;
@@ -216,6 +224,14 @@ void  QueryParser::GetSqlType()
 	{
 		sql_type_ = 91;
 	}
+	else if (sql_vector_[0] == "vacuum")  /*sqlΪп Code:101*/
+	{
+		sql_type_ = 101;
+	}
+	else if (sql_vector_[0] == "set")  /*sqlΪ޸ Code:111*/
+	{
+		sql_type_ = 111;
+	}
 	else
 	{
 		sql_type_ = -1;
@@ -257,6 +273,13 @@ void QueryParser::InvokeAPI(bool &flag)
 			delete si;
 		}
 		break;
+		case 24:
+		{
+			SQLCreateBloom *scb = new SQLCreateBloom(sql_vector_);
+			api->CreateBloom(*scb);
+			delete scb;
+		}
+		break;
 		case 31:
 		{
 			api->ShowDatabases();
@@ -288,6 +311,13 @@ void QueryParser::InvokeAPI(bool &flag)
 			delete sdi;
 		}
 		break;
+		case 44:
+		{
+			SQLDropBloom *sdb = new SQLDropBloom(sql_vector_);
+			api->DropBloom(*sdb);
+			delete sdb;
+		}
+		break;
 		case 51:
 		{
 			SQLInsert *si = new SQLInsert(sql_vector_);
@@ -331,6 +361,20 @@ void QueryParser::InvokeAPI(bool &flag)
 			delete suse;
 		}
 		break;
+		case 101:
+		{
+			SQLVacuumIndex *svi = new SQLVacuumIndex(sql_vector_);
+			api->VacuumIndex(*svi);
+			delete svi;
+		}
+		break;
+		case 111:
+		{
+			SQLSet *sset = new SQLSet(sql_vector_);
+			api->Set(*sset);
+			delete sset;
+		}
+		break;
 		default:
 			break;
 		}
@@ -344,8 +388,6 @@ void QueryParser::InvokeAPI(bool &flag)
 	catch (TableAlreadyExistsException& e) { cerr << "Error:ݱѴ!" << endl; }
 	catch (IndexAlreadyExistsException& e) { cerr << "Error:Ѵ!" << endl; }
 	catch (IndexNotExistException& e) { cerr << "Error:!" << endl; }
-	catch (OneIndexEachTableException& e) { cerr << "Error: ÿһֻһ!" << endl; }
 	catch (BPlusTreeException& e) { cerr << "Error: B++!" << endl; }
-	catch (IndexMustBeCreatedOnPrimaryKeyException& e) { cerr << "Error: 뽨!" << endl; }
 	catch (PrimaryKeyConflictException& e) { cerr << "Error: ͻ!" << endl; }
 }
\ No newline at end of file
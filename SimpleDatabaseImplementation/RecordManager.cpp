@@ -3,12 +3,20 @@
 //¼=sum(),ıǴӴС(block->preNum=block->getNum()+1)
 #include "RecordManager.h"
 #include "BPlusTree.h"
+#include "IndexManager.h"
 #include "ConstValue.h"
+#include "SlottedPage.h"
+#include "PaxPage.h"
+#include "RecordView.h"
+#include "Predicate.h"
+#include "Executor.h"
 #include<iostream>
 #include <iomanip>
+#include <algorithm>
+#include <functional>
 using std::cout;
 
-RecordManager::RecordManager(CatalogManager *cm, BufferManager *bm, string dbname) :catalog_m_(cm), buffer_m_(bm), db_name_(dbname) {}
+RecordManager::RecordManager(CatalogManager *cm, BufferManager *bm, string dbname) :catalog_m_(cm), buffer_m_(bm), db_name_(dbname), parallel_workers_(1) {}
 
 RecordManager::~RecordManager(void) {}
 
@@ -39,9 +47,6 @@ void RecordManager::Insert(SQLInsert& st, bool&flag)
 	Table *tb = catalog_m_->GetDB(db_name_)->GetTable(tb_name);
 	if (tb == NULL) throw TableNotExistException();
 
-	//һ飨4Kͷ12 bytesװٸ¼tuple
-	int max_count = (4096 - 12) / (tb->get_record_length());
-
 	vector<TKey> tkey_values;
 
 	int primary_key_index = -1;
@@ -60,14 +65,15 @@ void RecordManager::Insert(SQLInsert& st, bool&flag)
 		if (tb->GetAttributes()[i].get_attr_type() == 1)
 			primary_key_index = i;
 	}
-	//
-	if (primary_key_index != -1)
+	IndexManager im(catalog_m_, buffer_m_, db_name_);
+	//ϵĲ¡ܶ϶ֵ
+	if (primary_key_index != -1 && im.MayContain(tb, primary_key_index, tkey_values[primary_key_index]))
 	{
-		//
-		if (tb->GetIndexNum() != 0)
+		Index *pk_index = im.GetUniqueIndex(tb, tb->GetAttributes()[primary_key_index].get_attr_name());
+		//
+		if (pk_index != NULL)
 		{
-			BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-			if (tree.get_value(tkey_values[primary_key_index]) != -1)
+			if (im.ContainsKey(tb, pk_index, tkey_values[primary_key_index]))
 				throw PrimaryKeyConflictException();
 		}
 		//
@@ -75,112 +81,95 @@ void RecordManager::Insert(SQLInsert& st, bool&flag)
 		{
 			//õñʼ 
 			int block_num = tb->get_first_block_num();
+			RecordLayout layout(tb);
 			//еĿ飬Ƿᷢͻ
-			for (int i = 0; i < tb->get_block_count(); i++)
+			while (block_num != -1)
 			{
 				//õÿŶӦĿϢ
 				BlockInfo *bp = GetBlockInfo(tb, block_num);
-				for (int j = 0; j < bp->GetRecordCount(); j++)
+				vector<int> offsets = GetOffsets(tb, bp->get_data());
+				for (auto j = offsets.begin(); j != offsets.end(); j++)
 				{
-					//õڵĵj¼
-					vector<TKey> tuple = GetRecord(tb, block_num, j);
+					//ڿֱӱȽϵj¼
+					RecordView record(&layout, bp->get_data(), *j);
 					//ֵͻ
-					if (tuple[primary_key_index] == tkey_values[primary_key_index])
+					if (record.Equal(primary_key_index, tkey_values[primary_key_index]))
 						throw PrimaryKeyConflictException();
 				}
 				block_num = bp->GetNextBlockNum();
 			}
 		}
 	}
-	char *content;
+	//ǰĿϢжǷҪдĿ¼
+	int old_first_block = tb->get_first_block_num(), old_first_rubbish = tb->get_first_rubbish_num(), old_block_count = tb->get_block_count();
+	RID rid = InsertRecord(tb, tkey_values);
+	//Ѽ¼ϵ
+	im.InsertEntries(tb, tkey_values, RID_BLOCK(rid), RID_OFFSET(rid));
+	//bufferдش
+	buffer_m_->WriteToDisk();
+	//Ŀ¼Ϣдش
+	if (CatalogChanged(tb, old_first_block, old_first_rubbish, old_block_count))
+		catalog_m_->WriteArchiveFile();
+	//ǷҪɹϢ
+	if (flag)
+		cout << "ɹ" << endl;
+}
+//һ¼дУ޸
+RID RecordManager::InsertRecord(Table* tb, vector<TKey>& tkey_values)
+{
 	//ÿʼ
 	int use_block = tb->get_first_block_num();
 	//ʼ
 	int first_rubbish_block = tb->get_first_rubbish_num();
 	//¼һʹõĿ
 	int last_use_block;
-	int blocknum, offset;
+	int blocknum;
+	BlockInfo *bp;
 	//޿ÿ
 	while (use_block != -1)
 	{
 		last_use_block = use_block;
-		BlockInfo *bp = GetBlockInfo(tb, use_block);
-		//
-		if (bp->GetRecordCount() == max_count)
+		bp = GetBlockInfo(tb, use_block);
+		//ˣŲ¼
+		if (!Fits(tb, bp, tkey_values))
 		{
 			use_block = bp->GetNextBlockNum();
 			continue;
 		}
-		//δrecordβ¼
-		content = bp->GetContentAdress() + bp->GetRecordCount() * tb->get_record_length();
-		//һtupleҲǴӿĿλòһtuple
-		for (auto iter = tkey_values.begin(); iter != tkey_values.end(); iter++)
-		{
-			//Ƹcontent
-			memcpy(content, iter->get_key(), iter->get_length());
-			content += iter->get_length();
-		}
-		bp->SetRecordCount(1 + bp->GetRecordCount());
-		//¼Ŀ
-		blocknum = use_block;
-		//¼ƫ
-		offset = bp->GetRecordCount() - 1;
+		//δѼ¼дÿ
+		int offset = PutRecord(tb, bp, tkey_values);
 		//¿Ϣ
 		buffer_m_->WriteBlock(bp);
-
-		//
-		if (tb->GetIndexNum() != 0)
-		{
-			BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-			for (auto i = 0; i < tb->GetAttributes().size(); i++)
-			{
-				if (tb->GetIndex(0)->get_attr_name() == tb->GetIndex(i)->get_attr_name())
-				{
-					tree.add(tkey_values[i], blocknum, offset);
-					break;
-				}
-			}
-		}
-		//ºĽдش
-		buffer_m_->WriteToDisk();
-		//Ŀ¼Ϣдش
-		catalog_m_->WriteArchiveFile();
-		if (flag)
-			cout << "ɹ" << endl;
-		return;
+		return MAKE_RID(use_block, offset);
 	}
 	//޿ÿ鵫飨ѾյĿտ飩嵽
 	if (first_rubbish_block != -1)
 	{
 		//õһ
-		BlockInfo *bp = GetBlockInfo(tb, first_rubbish_block);
-		content = bp->GetContentAdress();
-		//recordcontent
-		for (auto iter = tkey_values.begin(); iter != tkey_values.end(); iter++)
-		{
-			memcpy(content, iter->get_key(), iter->get_length());
-			content += iter->get_length();
-		}
-		//ļ¼Ϊ1
-		bp->SetRecordCount(1);
-		//õwhileѭ֮ǰblocknextBlockNumΪ-1
-		BlockInfo *last_use_block_p = GetBlockInfo(tb, last_use_block);
-		//first_rubbish_blockĺ
-		last_use_block_p->SetNextBlockNum(first_rubbish_block);
+		bp = GetBlockInfo(tb, first_rubbish_block);
 		//ָһλ
 		tb->set_first_rubbish_num(bp->GetNextBlockNum());
-		//ÿǰһΪlast_use_block
-		bp->SetPrevBlockNum(last_use_block);
+		//ÿΪգÿΪ
+		if (tb->get_first_block_num() == -1)
+		{
+			tb->set_first_block_num(first_rubbish_block);
+			bp->SetPrevBlockNum(-1);
+		}
+		else
+		{
+			//õwhileѭ֮ǰblocknextBlockNumΪ-1
+			BlockInfo *last_use_block_p = GetBlockInfo(tb, last_use_block);
+			//first_rubbish_blockĺ
+			last_use_block_p->SetNextBlockNum(first_rubbish_block);
+			buffer_m_->WriteBlock(last_use_block_p);
+			//ÿǰһΪlast_use_block
+			bp->SetPrevBlockNum(last_use_block);
+		}
 
 		//ÿĺ޿ÿ
 		bp->SetNextBlockNum(-1);
 		//²ĿΪfirst_rubbish_block
 		blocknum = first_rubbish_block;
-		//ƫΪ0ΪǸÿĵһ¼
-		offset = 0;
-		//bplast_use_block_pΪ飬ȴдش
-		buffer_m_->WriteBlock(bp);
-		buffer_m_->WriteBlock(last_use_block_p);
 	}
 	else//ǰ޿ÿҲ鹩룬Ҫһ¿
 	{
@@ -196,71 +185,78 @@ void RecordManager::Insert(SQLInsert& st, bool&flag)
 		//õһÿı
 		tb->set_first_block_num(tb->get_block_count());
 		//һ¿
-		BlockInfo *bp = GetBlockInfo(tb, tb->get_first_block_num());
+		bp = GetBlockInfo(tb, tb->get_first_block_num());
 		//ǰ޿
 		bp->SetPrevBlockNum(-1);
 		//next_block棬prev_numҪԼnum
 		bp->SetNextBlockNum(next_block);
-		//¼1Ѵ¼浽bp
-		bp->SetRecordCount(1);
-		content = bp->GetContentAdress();
-		for (auto iter = tkey_values.begin(); iter != tkey_values.end(); iter++)
-		{
-			memcpy(content, iter->get_key(), iter->get_length());
-			content += iter->get_length();
-		}
 		//²Ŀ
 		blocknum = tb->get_block_count();
-		//ƫΪ0
-		offset = 0;
-		//Ϊ
-		buffer_m_->WriteBlock(bp);
 		//Ŀ1
 		tb->IncreaseBlockCount();
 	}
-	//index,Ѽ¼嵽index
-	if (tb->GetIndexNum() != 0)
+	//տеļ¼Ŀ¼ҳҪղĿ¼д¼Ǹÿĵһ¼
+	if (tb->get_page_format() == PAGE_FORMAT_SLOTTED) SlottedPage::Init(bp->get_data());
+	else bp->SetRecordCount(0);
+	int offset = PutRecord(tb, bp, tkey_values);
+	//Ϊ飬ȴдش
+	buffer_m_->WriteBlock(bp);
+	return MAKE_RID(blocknum, offset);
+}
+//ҳPAXҳм¼δﵽɣĿ¼ҳֽ
+bool RecordManager::Fits(Table* tb, BlockInfo* bp, vector<TKey>& tuple)
+{
+	if (tb->get_page_format() == PAGE_FORMAT_SLOTTED)
 	{
-		BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-		for (auto i = 0; i < tb->GetAttributes().size(); i++)
-		{
-			if (tb->GetIndex(0)->get_attr_name() == tb->GetIndex(i)->get_attr_name())
-			{
-				tree.add(tkey_values[i], blocknum, offset);
-				break;
-			}
-		}
+		vector<char> rec(SlottedPage::MaxLength(tb));
+		return SlottedPage::Fits(bp->get_data(), SlottedPage::Encode(tb, tuple, &rec[0]));
 	}
-	//bufferдش
-	buffer_m_->WriteToDisk();
-	catalog_m_->WriteArchiveFile();
-	//ǷҪɹϢ
-	if (flag)
-		cout << "ɹ" << endl;
+	//һ飨4Kͷ12 bytesװٸ¼tuple
+	int max_count = (4096 - 12) / (tb->get_record_length());
+	return bp->GetRecordCount() < max_count;
+}
+//ҳѼ¼ڿһ¼֮PAXҳѸֶνڸСҳһ֮󣻴Ŀ¼ҳղۻ²
+int RecordManager::PutRecord(Table* tb, BlockInfo* bp, vector<TKey>& tuple)
+{
+	if (tb->get_page_format() == PAGE_FORMAT_SLOTTED)
+	{
+		vector<char> rec(SlottedPage::MaxLength(tb));
+		int len = SlottedPage::Encode(tb, tuple, &rec[0]);
+		return SlottedPage::Put(bp->get_data(), &rec[0], len);
+	}
+	if (tb->get_page_format() == PAGE_FORMAT_PAX)
+	{
+		PaxPage::Put(tb, bp->get_data(), bp->GetRecordCount(), tuple);
+		bp->SetRecordCount(1 + bp->GetRecordCount());
+		return bp->GetRecordCount() - 1;
+	}
+	char *content = bp->GetContentAdress() + bp->GetRecordCount() * tb->get_record_length();
+	//һtupleҲǴӿĿλòһtuple
+	for (auto iter = tuple.begin(); iter != tuple.end(); iter++)
+	{
+		//Ƹcontent
+		memcpy(content, iter->get_key(), iter->get_length());
+		content += iter->get_length();
+	}
+	bp->SetRecordCount(1 + bp->GetRecordCount());
+	return bp->GetRecordCount() - 1;
 }
 //Select  ֧ͬA=B ѯ
-vector<vector<TKey>> RecordManager::Select(SQLSelect& st)
+//selectֶΣۼʱattribute_locΪۼõֶΣΪѡֶΣ*ΪֶΣֶβʱӡʾfalse
+bool RecordManager::ResolveSelected(Table* tb, vector<string>& selected, bool& isAggregateFunction, vector<int>& attribute_loc)
 {
-	string searchType = "ͨѯ";
-	Table *tb = catalog_m_->GetDB(db_name_)->GetTable(st.get_tb_name());
-
-	//ɸѡֶε±꼯
-	vector<int> attribute_loc;
-	vector<vector<TKey> > tuples;
-	vector<vector<TKey>>result;
-	bool isAggregateFunction = false;
+	isAggregateFunction = false;
 	//ۼõ
 	vector<string> aggregateFunctionAttributes;
-	vector<string> check = st.get_select_attribute();
-	if (check.size() > 0)
+	if (selected.size() > 0)
 	{
-		if ((check[0].find("count(") != string::npos) || (check[0].find("avg(") != string::npos)
-			|| (check[0].find("max(") != string::npos) || (check[0].find("min(") != string::npos))
+		if ((selected[0].find("count(") != string::npos) || (selected[0].find("avg(") != string::npos)
+			|| (selected[0].find("max(") != string::npos) || (selected[0].find("min(") != string::npos))
 		{
 			isAggregateFunction = true;
-			for (int i = 0; i < st.get_select_attribute().size(); i++)
+			for (int i = 0; i < selected.size(); i++)
 			{
-				string s = st.get_select_attribute()[i];
+				string s = selected[i];
 				int pos_1 = s.find("(");
 				int pos_2 = s.find(")");
 				aggregateFunctionAttributes.push_back(s.substr(pos_1 + 1, pos_2 - pos_1 - 1));
@@ -283,14 +279,14 @@ vector<vector<TKey>> RecordManager::Select(SQLSelect& st)
 				if (exits == false)
 				{
 					cout << "ۼõֶڸñвڣ" << endl;
-					return result;
+					return false;
 				}
 			}
 		}
 	}
 	if (!isAggregateFunction)
 	{
-		for (auto i = st.get_select_attribute().begin(); i != st.get_select_attribute().end(); i++)
+		for (auto i = selected.begin(); i != selected.end(); i++)
 		{
 			bool exits = false;
 			int loc = 0;
@@ -311,100 +307,130 @@ vector<vector<TKey>> RecordManager::Select(SQLSelect& st)
 			if (exits == false)
 			{
 				cout << "ѯֶڸñвڣ" << endl;
-				return result;
+				return false;
 			}
 		}
 	}
-	bool has_index = false;
-	int index_idx;
-	int where_idx;
+	return true;
+}
+
+void RecordManager::Select(SQLSelect& st)
+{
+	string searchType = "ͨѯ";
+	Table *tb = catalog_m_->GetDB(db_name_)->GetTable(st.get_tb_name());
 
-	//index,indexǷڲѯ
-	if (tb->GetIndexNum() != 0)
+	//ɸѡֶε±꼯
+	vector<int> attribute_loc;
+	bool isAggregateFunction = false;
+	if (!ResolveSelected(tb, st.get_select_attribute(), isAggregateFunction, attribute_loc)) return;
+	//ѯõֶΣѡֶwhereеֶ
+	vector<int> columns = attribute_loc;
+	for (auto where = st.GetWheres().begin(); where != st.GetWheres().end(); where++)
+	{
+		int loc = tb->GetAttributeIndex(where->key_1);
+		if (loc != -1) columns.push_back(loc);
+		loc = where->key_2 == "" ? -1 : tb->GetAttributeIndex(where->key_2);
+		if (loc != -1) columns.push_back(loc);
+	}
+	//ֶ
+	int order_col = -1;
+	if (st.get_order_by() != "")
 	{
-		for (auto i = 0; i < tb->GetIndexNum(); i++)
+		order_col = tb->GetAttributeIndex(st.get_order_by());
+		if (order_col == -1)
 		{
-			Index *idx = tb->GetIndex(i);
-			for (auto j = 0; j < st.GetWheres().size(); j++)
-			{
-				if (idx->get_attr_name() == st.GetWheres()[j].key_1 && st.GetWheres()[j].op_type != SIGN_NE)//xj:forB+tree,pre:== SIGN_EQ
-				{
-					has_index = true;
-					index_idx = i;
-					where_idx = j;
-				}
-			}
+			cout << "ֶڸñвڣ" << endl;
+			return;
 		}
+		columns.push_back(order_col);
 	}
-	//ѯûindex,block
-	if (!has_index)
+	//limit n offset mǰm󷵻nɨֻǰn + m
+	int limit = isAggregateFunction ? -1 : st.get_limit();
+	int offset = isAggregateFunction ? 0 : st.get_offset();
+	int fetch = limit >= 0 ? limit + offset : -1;
+	//Ƿڲѯindex
+	IndexManager im(catalog_m_, buffer_m_, db_name_);
+	vector<int> where_idxs;
+	int index_idx = im.ChooseIndex(tb, st.GetWheres(), where_idxs, &columns);
+
+	//order by˳򷵻ؼ¼ֶǵֵ֮ĵһֶʱ򣬽ʱɨ
+	//ûпwherelimitʱһֶΪֶε˳fetchͣ
+	bool ordered = false;
+	if (order_col != -1 && !isAggregateFunction)
 	{
-		int block_num = tb->get_first_block_num();
-		for (int i = 0; i < tb->get_block_count(); i++)
+		if (index_idx != -1) ordered = im.Orders(tb->GetIndex(index_idx), st.GetWheres(), where_idxs, st.get_order_by());
+		else if (fetch >= 0 && (index_idx = im.ChooseOrderIndex(tb, st.get_order_by(), &columns)) != -1) ordered = true;
+	}
+	bool reverse = ordered && st.is_order_desc();
+	//whereʱصļ¼Ҷֻfetch
+	int index_limit = (order_col == -1 || ordered) && where_idxs.size() == st.GetWheres().size() ? fetch : -1;
+	//whereֻһΣɨʱֱڿбȽϣ볣Ƚϵһֵ
+	WherePredicate predicate(tb, st.GetWheres());
+	//Ҷӣ˳ɨ衢صļ¼ַ¼ɸļԭ¼¡϶Ϊʱû
+	//αҶӣȡ˾Ͳٶ
+	BatchOperator *source = NULL;
+	IndexCursor cursor(&im, tb, index_idx == -1 ? NULL : tb->GetIndex(index_idx), st.GetWheres(), where_idxs, reverse, index_limit);
+
+	//¡϶ֵеֵڣΪգض¼
+	if (im.BloomExcludes(tb, st.GetWheres()))
+	{
+		searchType = "¡ж";
+	}
+	//ѯûindex,blockڿжwhereֻļ¼вѯõֶθƽ
+	else if (index_idx == -1)
+	{
+		int workers = min(parallel_workers_, tb->get_block_count());
+		//鰴ŷָ߳ɨ
+		if (workers > 1)
 		{
-			BlockInfo *bp = GetBlockInfo(tb, block_num);
-			for (int j = 0; j < bp->GetRecordCount(); j++)
-			{
-				vector<TKey> tuple = GetRecord(tb, block_num, j);
-				bool sats = true;
-				for (auto k = 0; k < st.GetWheres().size(); k++)
-				{
-					SQLWhere where = st.GetWheres()[k];
-					if (!SatisfyWhere(tb, tuple, where)) sats = false;
-				}
-				if (sats) tuples.push_back(tuple);
-			}
-			block_num = bp->GetNextBlockNum();
+			searchType = "ɨ";
+			source = new ParallelScan(this, tb, columns, &predicate, workers);
+		}
+		else
+		{
+			//PAXһֶεֵģۼֻθõֶ
+			if (isAggregateFunction && tb->get_page_format() == PAGE_FORMAT_PAX) searchType = "ɨ";
+			source = new TableScan(this, tb, columns, &predicate);
 		}
 	}
+	//ҶвѯõֶΣֱɼԭֶΣ¼ɨ裩
+	else if (im.Covers(tb, tb->GetIndex(index_idx), columns))
+	{
+		searchType = "ڸĲѯ";
+		source = new KeyScan(&im, &cursor, &predicate, ordered ? fetch : -1);
+	}
 	//indexڸУB+
 	else
 	{
-		BPlusTree tree(tb->GetIndex(index_idx), buffer_m_, catalog_m_, db_name_);
-
-		//Ϊtkey
-		int type = tb->GetIndex(index_idx)->get_key_type();
-		int length = tb->GetIndex(index_idx)->get_key_len();
-		string value = st.GetWheres()[where_idx].value;
-		TKey dest_key(type, length);
-		dest_key.ReadValue(value);
-
+		if (tb->GetIndex(index_idx)->get_index_type() == INDEX_HASH) searchType = "ڹϣĵֵѯ";
+		else if (where_idxs.empty())
+			searchType = tb->GetIndex(index_idx)->get_index_type() == INDEX_ART ? "ARTɨ" : "B+ɨ";
+		else if (tb->GetIndex(index_idx)->get_index_type() == INDEX_ART)
+			searchType = st.GetWheres()[where_idxs.back()].op_type == SIGN_EQ ? "ARTĵֵѯ" : "ARTķΧѯ";
+		else searchType = st.GetWheres()[where_idxs.back()].op_type == SIGN_EQ ? "B+ĵֵѯ" : "B+ķΧѯ";
 		//xujing:ֵѯ뷶Χѯ ֧
-		vector<int> blocknumList = tree.get_value(dest_key, st.GetWheres()[where_idx].op_type, searchType);
-		//int blocknum = tree.get_value(dest_key);
-		//õѯ
-		for (auto bnum = blocknumList.begin(); bnum != blocknumList.end(); bnum++)
-		{
-			int blocknum = (*bnum);
-			if (blocknum != -1)
-			{
-				int blockoffset = blocknum;
-				//ȡ16λǰ2ֽڣ
-				blocknum = blocknum >> 16;
-				//ȡ16λ2ֽڣƫ
-				blocknum = blocknum && 0xffff;
-				//õݿźͿλõblockoffsettuple
-				blockoffset = blockoffset & 0xffff;
-
-				vector<TKey> tuple = GetRecord(tb, blocknum, blockoffset);
-				bool sats = true;
-				for (auto k = 0; k < st.GetWheres().size(); k++)
-				{
-					SQLWhere where = st.GetWheres()[k];
-					if (!SatisfyWhere(tb, tuple, where)) sats = false;
-				}
-				if (sats) tuples.push_back(tuple);
-			}
-		}
+		//16λƫλţ˳ļ¼Ѿʱfetchͣ
+		source = new RidScan(this, &cursor, columns, &predicate, ordered ? fetch : -1);
 	}
-	if (tuples.size() == 0)
+	//ûаֶηؼ¼ʱڴ
+	int sort_col = order_col != -1 && !ordered && !isAggregateFunction ? order_col : -1;
+	//ʱ׳쳣ҲҪͷӣɨͣ¸̣߳ͬJoinSelect
+	try
 	{
-		cout << "ձEmpty table" << endl;
-		return result;
+		Output(source, tb, st.get_select_attribute(), isAggregateFunction, attribute_loc, columns, sort_col, st.is_order_desc(), offset, limit, searchType);
 	}
-	string sline = "";
-
+	catch (...)
+	{
+		delete source;
+		throw;
+	}
+	delete source;
+}
 
+//ӡͷѡֶۼʱΪselectĸطָ
+string RecordManager::PrintHeader(Table* tb, vector<string>& selected, bool isAggregateFunction, vector<int>& attribute_loc)
+{
+	string sline = "";
 	//ӡ
 	for (int i = 0; i < attribute_loc.size(); i++)
 	{
@@ -422,93 +448,99 @@ vector<vector<TKey>> RecordManager::Select(SQLSelect& st)
 	}
 	else
 	{
-		for (int i = 0; i < st.get_select_attribute().size(); i++)
+		for (int i = 0; i < selected.size(); i++)
 		{
-			cout << "| " << setw(9) << left << st.get_select_attribute()[i];
+			cout << "| " << setw(9) << left << selected[i];
 		}
 	}
 	cout << "|" << endl;
 	cout << sline << endl;
+	return sline;
+}
 
-	//xujing:ۼʹ
-	int index = 2;//1:2
-				  //TKey min = Min(tuples, index);//testMin
-				  //TKey min = Max(tuples, index);//testMax
-				  //TKey* min = Avg(tuples, index);//testAvg:varcharʱkey_=
-	int min = Count(tuples, index);//testCount
-	if (!isAggregateFunction)
-	{ //ӡ					
-		for (auto tuple = tuples.begin(); tuple != tuples.end(); tuple++)
-		{
-			vector<TKey> reuslt_tuple;
-			for (int i = 0; i < attribute_loc.size(); i++)
-			{
-				//ֻӡѡֶ
-				auto val = tuple->begin() + attribute_loc[i];
-				reuslt_tuple.push_back(*val);
-				cout << "| " << setw(10) << (*val);
-			}
-
-			result.push_back(reuslt_tuple);
-			cout << "|" << endl;
-			cout << sline << endl;
-		}
+//ӡһ¼ѡֶ
+void RecordManager::PrintRow(vector<TKey>& tuple, vector<int>& attribute_loc, string& sline)
+{
+	for (int i = 0; i < attribute_loc.size(); i++)
+	{
+		cout << "| " << setw(10) << tuple[attribute_loc[i]];
 	}
-	else
+	cout << "|" << endl;
+	cout << sline << endl;
+}
+
+//ִsourceΪӡSelectJoinSelectãȡʱÿõһ¼ʹӡ
+//ڴֻиӵǰһǰoffsetӡlimitͲȡɨ֮ͣ
+void RecordManager::Output(BatchOperator* source, Table* tb, vector<string>& selected, bool isAggregateFunction, vector<int>& attribute_loc,
+	vector<int>& columns, int sort_col, bool desc, int offset, int limit, string searchType)
+{
+	//ۼֱƼ¼
+	if (isAggregateFunction)
 	{
-		/*for (int i = 0; i < attribute_loc.size(); i++)
+		vector<TKey> values;
+		if (AggregateOperator(source, tb, selected, attribute_loc).Run(values) == 0)
 		{
-		vector<TKey> reuslt_tuple;
-		for (auto tuple = tuples.begin(); tuple != tuples.end(); tuple++)
+			cout << "ձEmpty table" << endl;
+			return;
+		}
+		string sline = PrintHeader(tb, selected, isAggregateFunction, attribute_loc);
+		for (int i = 0; i < selected.size(); i++)
 		{
-		auto val = tuple->begin() + attribute_loc[i];
-		reuslt_tuple.push_back(*val);
+			cout << "| " << setw(9) << left << values[i];
 		}
-		result.push_back(reuslt_tuple);
-		}*/
-		for (int i = 0; i < st.get_select_attribute().size(); i++)
+		cout << "|" << endl;
+		cout << sline << endl;
+	}
+	else
+	{
+		ProjectOperator project(source, columns);
+		vector<TKey> tuple;
+		string sline;
+		int count = 0;
+		//Ҫڴʱֻȡм¼
+		if (sort_col != -1)
 		{
-			string s = st.get_select_attribute()[i];
-			s.assign(s.substr(0, 3));
-			if (s == "cou")
+			vector<vector<TKey> > tuples;
+			while (project.Next(tuple)) tuples.push_back(tuple);
+			stable_sort(tuples.begin(), tuples.end(), [sort_col, desc](const vector<TKey>& a, const vector<TKey>& b)
 			{
-				cout << "| " << setw(9) << left << Count(tuples, attribute_loc[i]);
-			}
-			else if (s == "min")
-			{
-				TKey tmp = Min(tuples, attribute_loc[i]);
-				cout << "| " << setw(9) << left << tmp;
-			}
-			else if (s == "max")
+				return desc ? b[sort_col] < a[sort_col] : a[sort_col] < b[sort_col];
+			});
+			tuples.erase(tuples.begin(), tuples.begin() + min((unsigned int)offset, (unsigned int)tuples.size()));
+			if (limit >= 0 && tuples.size() > (unsigned int)limit) tuples.resize(limit);
+			for (auto t = tuples.begin(); t != tuples.end(); t++, count++)
 			{
-				TKey tmp = Max(tuples, attribute_loc[i]);
-				cout << "| " << setw(9) << left << tmp;
+				if (count == 0) sline = PrintHeader(tb, selected, isAggregateFunction, attribute_loc);
+				PrintRow(*t, attribute_loc, sline);
 			}
-			else/* (s == "avg")*/
+		}
+		else
+		{
+			for (int skipped = 0; skipped < offset && project.Next(tuple); skipped++);
+			for (; (limit < 0 || count < limit) && project.Next(tuple); count++)
 			{
-				TKey *tmp = Avg(tuples, attribute_loc[i]);
-				cout << "| " << setw(9) << left << (*tmp);
+				if (count == 0) sline = PrintHeader(tb, selected, isAggregateFunction, attribute_loc);
+				PrintRow(tuple, attribute_loc, sline);
 			}
 		}
-		cout << "|" << endl;
-		cout << sline << endl;
+		if (count == 0)
+		{
+			cout << "ձEmpty table" << endl;
+			return;
+		}
+		cout << "| Result | " << setw(10) << count;
 	}
-	//xujing:ۼ
-	if (!isAggregateFunction)
-		cout << "| Result | " << setw(10) << min;//(*min);
-
 	cout << "| ѯʽ | " << setw(10) << searchType << endl;
+}
 
-	//ӡ
-	/*if (tb->GetIndexNum() != 0)
-	{
-	BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-	tree.print();
-	}*/
-	return result;
+/*whereС.ֶı*/
+static string TableOf(string key)
+{
+	return key.substr(0, key.find('.'));
 }
 
-//Joinѯʵ
+//Joinѯʵ֣˳ɨ裬ֻ漰һűɨʱжϣ˳ӣеֵʱùϣӣǶѭӣ
+//ߵıӽж
 void RecordManager::JoinSelect(SQLJoinSelect & st)
 {
 	int table_count = st.get_table_names().size();
@@ -548,303 +580,170 @@ void RecordManager::JoinSelect(SQLJoinSelect & st)
 				throw AttributeNotExistException();
 		}
 	}
+	vector<SQLWhere> conditions = st.get_wheres();
+	for (int i = 0; i < conditions.size(); i++)
+	{
+		if (conditions[i].op_type < SIGN_EQ || conditions[i].op_type > SIGN_GE)
+			throw SyntaxErrorException();
+	}
 
-	//±ֶ
-	vector<string> attribute_names;
-	//±ֶͼ
-	vector<string> attr_types;
-	//±tuple
-	vector<vector<string>> new_tuples;
-	//join֮ǰļ
-	vector<Table> old_tables;
-	//ббԣӶһŴ
+	//joined[i]Ϊǰi + 1űӵĽֶӣֶΪ.ֶֻڴУдĿ¼
+	vector<Table*> tables;
+	vector<Table> joined(table_count);
 	for (int i = 0; i < table_count; i++)
 	{
 		Table *tb = catalog_m_->GetDB(db_name_)->GetTable(st.get_table_names()[i]);
+		tables.push_back(tb);
+		if (i > 0) joined[i] = joined[i - 1];
+		joined[i].set_table_name("JOINED_TABLE");
 		vector<Attribute> atts = tb->GetAttributes();
 		for (auto it = atts.begin(); it != atts.end(); it++)
 		{
-			attribute_names.push_back(tb->get_tb_name() + "." + it->get_attr_name());
-			if (it->get_data_type() == 0)
-				attr_types.push_back("int");
-			else if (it->get_data_type() == 1)
-				attr_types.push_back("float");
-			else//char or varchar
-			{
-				attr_types.push_back("varchar(" + intToString(it->get_length()) + ")");
-			}
+			Attribute attr = *it;
+			attr.set_attribute_name(tb->get_tb_name() + "." + it->get_attr_name());
+			joined[i].AddAttribute(attr);
 		}
-		old_tables.push_back((*tb));
+		joined[i].set_record_length((i > 0 ? joined[i - 1].get_record_length() : 0) + tb->get_record_length());
 	}
-	string table_name_afer_join = "JOINED_TABLE";
-	QueryParser query_parser;
+	Table *result_table = &joined[table_count - 1];
+	vector<int> attribute_loc;
+	bool isAggregateFunction = false;
+	if (!ResolveSelected(result_table, selected_attributes, isAggregateFunction, attribute_loc)) return;
 
-	string create_new_table_sql_ = "create table JOINED_TABLE(";
-	int k;
-	for (k = 0; k <(attribute_names.size() - 1); k++)
+	//õıӽһ㣺ֻõһűɨűʱжϣ֮ж
+	vector<vector<SQLWhere> > scan_wheres(table_count), join_wheres(table_count);
+	for (auto where = conditions.begin(); where != conditions.end(); where++)
 	{
-		create_new_table_sql_ += attribute_names[k] + " " + attr_types[k] + ",";
+		int first = -1, last = -1;
+		for (int i = 0; i < table_count; i++)
+		{
+			if (TableOf(where->key_1) == tables[i]->get_tb_name() || (where->key_2 != "" && TableOf(where->key_2) == tables[i]->get_tb_name()))
+			{
+				if (first == -1) first = i;
+				last = i;
+			}
+		}
+		if (last == -1) throw AttributeNotExistException();
+		if (first == last && (where->key_2 == "" || TableOf(where->key_1) == TableOf(where->key_2))) scan_wheres[last].push_back(*where);
+		else join_wheres[last].push_back(*where);
 	}
-	create_new_table_sql_ += attribute_names[k] + " " + attr_types[k] + ");";
-	bool flag = true;
-	query_parser.ExecuteSQL("use " + db_name_ + ";", flag);
-	//һ±
-	query_parser.ExecuteSQL(create_new_table_sql_, flag);
 
-	//catalog_m_->WriteArchiveFile();˾вɼӣΪһѾcatalog.дĻḲǸµݣ
-	catalog_m_->ReadArchiveFile();//ֻѸºĿ¼
-
-								  //ݵ±У֮±ִselectҪA=B,to be continued...
-	int i = 0;
-	if (old_tables.size() == 2)
+	//һΪǰıһΪűֶΣͬĵֵɹϣ̽ʱж
+	vector<vector<JoinKey> > join_keys(table_count);
+	for (int i = 1; i < table_count; i++)
 	{
-		/*vector<vector<TKey>> vt1=Select((*seleAll));*/
-		//һűTuples
-		vector<vector<TKey>> vt1;
-		int block_num_1 = old_tables[i].get_first_block_num();
-		for (int x = 0; x <old_tables[i].get_block_count(); x++)
+		int left_count = joined[i - 1].GetAttributeNum();
+		vector<SQLWhere> rest;
+		for (auto where = join_wheres[i].begin(); where != join_wheres[i].end(); where++)
 		{
-			BlockInfo *bp = GetBlockInfo(&old_tables[i], block_num_1);
-			for (int j = 0; j < bp->GetRecordCount(); j++)
+			int col_1 = joined[i].GetAttributeIndex(where->key_1);
+			int col_2 = where->key_2 != "" ? joined[i].GetAttributeIndex(where->key_2) : -1;
+			if (where->op_type == SIGN_EQ && col_1 != -1 && col_2 != -1 && (col_1 < left_count) != (col_2 < left_count)
+				&& joined[i].GetAttributes()[col_1].get_data_type() == joined[i].GetAttributes()[col_2].get_data_type())
 			{
-				vector<TKey> tuple = GetRecord(&old_tables[i], block_num_1, j);
-				vt1.push_back(tuple);
+				JoinKey key;
+				key.left = min(col_1, col_2);
+				key.right = max(col_1, col_2);
+				key.key_1_left = col_1 < left_count;
+				join_keys[i].push_back(key);
 			}
-			block_num_1 = bp->GetNextBlockNum();
+			else rest.push_back(*where);
 		}
+		join_wheres[i].swap(rest);
+	}
 
-		//ڶűTuples
-		vector<vector<TKey>> vt2;
-		int block_num_2 = old_tables[i + 1].get_first_block_num();
-		for (int x = 0; x <old_tables[i + 1].get_block_count(); x++)
+	string searchType = "Ƕѭ";
+	vector<WherePredicate*> predicates;
+	vector<BatchOperator*> operators;
+	BatchOperator *root = NULL;
+	try
+	{
+		for (int i = 0; i < table_count; i++)
 		{
-			BlockInfo *bp = GetBlockInfo(&old_tables[i + 1], block_num_2);
-			for (int j = 0; j < bp->GetRecordCount(); j++)
+			vector<int> all_columns;
+			for (unsigned int col = 0; col < tables[i]->GetAttributeNum(); col++)
+				all_columns.push_back(col);
+			predicates.push_back(new WherePredicate(tables[i], scan_wheres[i]));
+			operators.push_back(new TableScan(this, tables[i], all_columns, predicates.back()));
+			if (i == 0) root = operators.back();
+			else if (!join_keys[i].empty())
 			{
-				vector<TKey> tuple = GetRecord(&old_tables[i + 1], block_num_2, j);
-				vt2.push_back(tuple);
+				searchType = "ϣ";
+				operators.push_back(new HashJoin(root, operators.back(), &joined[i], join_keys[i]));
+				root = operators.back();
 			}
-			block_num_2 = bp->GetNextBlockNum();
-		}
-		int p = vt1.size();
-		string tmp;
-		for (int j = 0; j < p; j++)
-		{//һű
-			vector<TKey> tmp_key = vt1[j];
-			tmp = "";
-			for (int k = 0; k < tmp_key.size(); k++)
-			{//һű
-				if (tmp_key[k].get_key_type() == T_INT)
-				{
-					int a;
-					memcpy(&a, tmp_key[k].get_key(), tmp_key[k].get_length());
-					tmp += intToString(a) + ",";
-				}
-				else if (tmp_key[k].get_key_type() == T_FLOAT)
-				{
-					float a;
-					memcpy(&a, tmp_key[k].get_key(), tmp_key[k].get_length());
-					string copy = floatToString(a);
-					tmp += copy + ",";
-				}
-				else//T_CHAR
-				{
-					string copy(tmp_key[k].get_key());
-					copy = "'" + copy + "'";
-					tmp += copy + ",";
-				}
+			else
+			{
+				operators.push_back(new NestedLoopJoin(root, operators.back(), &joined[i]));
+				root = operators.back();
 			}
-			string tmp_1 = tmp;
-			int q = vt2.size();
-			for (int y = 0; y < q; y++)
-			{//ڶű
-				tmp_1 = tmp;
-				vector<TKey> tmp_key_1 = vt2[y];
-				for (int k = 0; k < tmp_key_1.size(); k++)
-				{//ڶű
-					if (tmp_key_1[k].get_key_type() == T_INT)
-					{
-						int a;
-						memcpy(&a, tmp_key_1[k].get_key(), tmp_key_1[k].get_length());
-						if (k == (tmp_key_1.size() - 1))
-							tmp_1 += intToString(a);
-						else
-							tmp_1 += intToString(a) + ",";
-					}
-					else if (tmp_key_1[k].get_key_type() == T_FLOAT)
-					{
-						float a;
-						memcpy(&a, tmp_key_1[k].get_key(), tmp_key_1[k].get_length());
-						string copy = floatToString(a);
-						if (k == (tmp_key_1.size() - 1))
-							tmp_1 += copy;
-						else
-							tmp_1 += copy + ",";
-					}
-					else//T_CHAR
-					{
-						string copy(tmp_key_1[k].get_key());
-						copy = "'" + copy + "'";
-						if (k == (tmp_key_1.size() - 1))
-							tmp_1 += copy;
-						else
-							tmp_1 += copy + ",";
-					}
-				}
-				string insertStatement = "insert into JOINED_TABLE values(" + tmp_1 + ")";
-				bool output_info_flag = false;//ɹϢ
-				query_parser.ExecuteSQL(insertStatement, output_info_flag);
-				catalog_m_->ReadArchiveFile();
+			if (!join_wheres[i].empty())
+			{
+				predicates.push_back(new WherePredicate(&joined[i], join_wheres[i]));
+				operators.push_back(new FilterOperator(root, predicates.back()));
+				root = operators.back();
 			}
 		}
+		vector<int> columns = attribute_loc;
+		Output(root, result_table, selected_attributes, isAggregateFunction, attribute_loc, columns, -1, false, 0, -1, searchType);
 	}
-	//select ԣؽ󣬽JOIEND_TABLEɾ
-	string select_from_joined_table = "select ";
-	string selectAttr = "";
-	for (int i = 0; i < selected_attributes.size(); i++)
-		selectAttr += selected_attributes[i] + ",";
-	//Ƴһ
-	selectAttr.assign(selectAttr.substr(0, selectAttr.length() - 1));
-	vector<SQLWhere> conditions = st.get_wheres();
-	if (conditions.size() == 0)
-	{
-		select_from_joined_table += selectAttr + " from JOINED_TABLE;";
-	}
-	else
+	catch (...)
 	{
-		select_from_joined_table += selectAttr + " from JOINED_TABLE where ";
-
-		for (int i = 0; i < conditions.size(); i++)
-		{
-			string op;
-			switch (conditions[i].op_type)
-			{
-			case SIGN_EQ:op = "="; break;
-			case SIGN_GE:op = ">="; break;
-			case SIGN_GT:op = ">"; break;
-			case SIGN_LE:op = "<="; break;
-			case SIGN_LT:op = "<"; break;
-			case SIGN_NE:op = "!="; break;
-			default:break;
-			}
-			if (op == "")
-				throw SyntaxErrorException();
-			string tmp = "";
-			if (conditions[i].data_type == T_CHAR)
-				tmp = conditions[i].key_1 + op + "'" + conditions[i].value + "'";
-			else tmp = conditions[i].key_1 + op + conditions[i].value + conditions[i].key_2;
-			select_from_joined_table += tmp + " and ";
-		}
-		select_from_joined_table.assign(select_from_joined_table.substr(0, select_from_joined_table.length() - 5) + ";");
+		for (auto op = operators.begin(); op != operators.end(); op++) delete *op;
+		for (auto p = predicates.begin(); p != predicates.end(); p++) delete *p;
+		throw;
 	}
-	query_parser.ExecuteSQL(select_from_joined_table, flag);
-	query_parser.ExecuteSQL("drop table JOINED_TABLE;", flag);
-	catalog_m_->ReadArchiveFile();
+	for (auto op = operators.begin(); op != operators.end(); op++) delete *op;
+	for (auto p = predicates.begin(); p != predicates.end(); p++) delete *p;
 }
 
 void RecordManager::Delete(SQLDelete& st)
 {
 	Table *tb = catalog_m_->GetDB(db_name_)->GetTable(st.get_tb_name());
-	bool has_index = false;
-	int index_idx = -2;
-	int where_idx;
+	IndexManager im(catalog_m_, buffer_m_, db_name_);
+	//ɾļ¼ַ
+	vector<RID> rids;
+	vector<int> where_idxs;
+	int index_idx = im.ChooseIndex(tb, st.GetWheres(), where_idxs);
 
-	//Ƿindex
-	if (tb->GetIndexNum() != 0)
-	{
-		index_idx = -1;
-		for (auto i = 0; i < tb->GetIndexNum(); i++)
-		{
-			Index *idx = tb->GetIndex(i);
-			for (auto j = 0; j < st.GetWheres().size(); j++)
-			{
-				if (idx->get_attr_name() == st.GetWheres()[j].key_1 && st.GetWheres()[j].op_type == SIGN_EQ)
-				{
-					has_index = true;
-					index_idx = i;
-					where_idx = j;
-				}
-			}
-		}
-	}
-	//indexɾУ
-	if (!has_index)
+	RecordLayout layout(tb);
+	//whereֻһΣɨʱֱڿбȽϣ볣Ƚϵһֵ
+	WherePredicate predicate(tb, st.GetWheres());
+
+	//ûindexɾ
+	if (index_idx == -1)
 	{
 		int block_num = tb->get_first_block_num();
-		for (int i = 0; i < tb->get_block_count(); i++)
+		while (block_num != -1)
 		{
 			BlockInfo *bp = GetBlockInfo(tb, block_num);
-			int count_ = bp->GetRecordCount();
-			for (int j = 0; j < count_; j++)
-			{
-				vector<TKey> tuple = GetRecord(tb, block_num, j);
-				bool sats = true;
-				for (int k = 0; k < st.GetWheres().size(); k++)
-				{
-					SQLWhere where = st.GetWheres()[k];
-					if (!SatisfyWhere(tb, tuple, where)) sats = false;
-				}
-				if (sats)
-				{
-					//ɾü¼
-					DeleteRecord(tb, block_num, j);
-					if (tb->GetIndexNum() != 0)
-					{
-						for (index_idx = 0; index_idx < tb->GetIndexNum(); index_idx++)
-						{
-							BPlusTree tree(tb->GetIndex(index_idx), buffer_m_, catalog_m_, db_name_);
-							int idx = -1;
-							for (int i = 0; i < tb->GetAttributeNum(); i++)
-							{
-								if (tb->GetAttributes()[i].get_attr_name() == tb->GetIndex(index_idx)->get_attr_name())
-									idx = i;
-							}
-							tree.remove(tuple[idx]);
-						}
-
-					}
-				}
-			}
+			vector<int> offsets = GetOffsets(tb, bp->get_data());
+			predicate.Filter(&layout, bp->get_data(), offsets);
+			for (auto j = offsets.begin(); j != offsets.end(); j++)
+				rids.push_back(MAKE_RID(block_num, *j));
 			block_num = bp->GetNextBlockNum();
 		}
 	}
-	//indexɾ
+	//indexɾҳѡ¼
 	else
 	{
-		BPlusTree tree(tb->GetIndex(index_idx), buffer_m_, catalog_m_, db_name_);
-
-		//Ϊsearchtkey
-		int type = tb->GetIndex(index_idx)->get_key_type();
-		int length = tb->GetIndex(index_idx)->get_key_len();
-		string value = st.GetWheres()[where_idx].value;
-		TKey dest_key(type, length);
-		dest_key.ReadValue(value);
-
-		int blocknum = tree.get_value(dest_key);
-
-		if (blocknum != -1)
+		vector<RID> candidates = im.SearchIndex(tb, tb->GetIndex(index_idx), st.GetWheres(), where_idxs);
+		for (auto rid = candidates.begin(); rid != candidates.end(); rid++)
 		{
-			int blockoffset = blocknum;
-			blocknum = blocknum >> 16;
-			blocknum = blocknum && 0xffff;
-			blockoffset = blockoffset & 0xffff;
-
-			vector<TKey> tuple = GetRecord(tb, blocknum, blockoffset);
-			bool sats = true;
-			for (int k = 0; k < st.GetWheres().size(); k++)
-			{
-				SQLWhere where = st.GetWheres()[k];
-				if (!SatisfyWhere(tb, tuple, where)) sats = false;
-			}
-			if (sats)
-			{
-				//ü¼ɾ
-				DeleteRecord(tb, blocknum, blockoffset);
-				tree.remove(dest_key);
-			}
+			RecordView record(&layout, GetBlockInfo(tb, RID_BLOCK(*rid))->get_data(), RID_OFFSET(*rid));
+			if (predicate.Evaluate(record)) rids.push_back(*rid);
 		}
 	}
+	//DeleteRecordѿһ¼Ƶɾλã԰ַӴСɾ֤δɾļ¼ַ
+	sort(rids.begin(), rids.end(), greater<RID>());
+	int old_first_block = tb->get_first_block_num(), old_first_rubbish = tb->get_first_rubbish_num(), old_block_count = tb->get_block_count();
+	for (auto rid = rids.begin(); rid != rids.end(); rid++)
+		DeleteRecord(tb, RID_BLOCK(*rid), RID_OFFSET(*rid));
+
 	buffer_m_->WriteToDisk();
+	//Ķ׿ܸı䣬Ŀ¼Ϣдش
+	if (CatalogChanged(tb, old_first_block, old_first_rubbish, old_block_count))
+		catalog_m_->WriteArchiveFile();
 	cout << "ɾɹ" << endl;
 }
 
@@ -874,81 +773,76 @@ void RecordManager::Update(SQLUpdate& st)
 
 		if (index == primary_key_index) affect_index = i;
 	}
-	if (affect_index != -1)
+	IndexManager im(catalog_m_, buffer_m_, db_name_);
+	RecordLayout layout(tb);
+	//whereֻһΣɨʱֱڿбȽϣ볣Ƚϵһֵ
+	WherePredicate predicate(tb, st.GetWheres());
+	if (affect_index != -1 && im.MayContain(tb, primary_key_index, tuple[affect_index]))
 	{
-		if (tb->GetIndexNum() != 0)
+		Index *pk_index = im.GetUniqueIndex(tb, tb->GetAttributes()[primary_key_index].get_attr_name());
+		if (pk_index != NULL)
 		{
-			BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-			if (tree.get_value(tuple[affect_index]) != -1)
+			if (im.ContainsKey(tb, pk_index, tuple[affect_index]))
 				throw PrimaryKeyConflictException();
 		}
 		else
 		{
 			int block_num = tb->get_first_block_num();
-			for (int i = 0; i < tb->get_block_count(); i++)
+			while (block_num != -1)
 			{
 				BlockInfo *bp = GetBlockInfo(tb, block_num);
 
-				for (int j = 0; j < bp->GetRecordCount(); j++)
+				vector<int> offsets = GetOffsets(tb, bp->get_data());
+				for (auto j = offsets.begin(); j != offsets.end(); j++)
 				{
-					vector<TKey> tp = GetRecord(tb, block_num, j);
-					if (tp[primary_key_index] == tuple[affect_index])
+					RecordView record(&layout, bp->get_data(), *j);
+					if (record.Equal(primary_key_index, tuple[affect_index]))
 						throw PrimaryKeyConflictException();
 				}
 				block_num = bp->GetNextBlockNum();
 			}
 		}
 	}
+	//ҳļ¼£Ŀ¼ҳб䳤Ųµļ¼Ƶ
+	vector<RID> rids;
 	int block_num = tb->get_first_block_num();
-	for (int i = 0; i < tb->get_block_count(); i++)
+	while (block_num != -1)
 	{
 		BlockInfo *bp = GetBlockInfo(tb, block_num);
-
-		for (int j = 0; j < bp->GetRecordCount(); j++)
-		{
-			vector<TKey> tp = GetRecord(tb, block_num, j);
-			bool sats = true;
-			for (int k = 0; k < st.GetWheres().size(); k++)
-			{
-				SQLWhere where = st.GetWheres()[k];
-				if (!SatisfyWhere(tb, tp, where)) sats = false;
-			}
-			if (sats)
-			{
-				/* remove from index. */
-				if (tb->GetIndexNum() != 0)
-				{
-					BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-					int idx = -1;
-					for (int i = 0; i < tb->GetAttributeNum(); i++)
-					{
-						if (tb->GetAttributes()[i].get_attr_name() == tb->GetIndex(0)->get_attr_name())
-							idx = i;
-					}
-					tree.remove(tuple[idx]);
-				}
-				UpdateRecord(tb, block_num, j, indices, tuple);
-
-				tp = GetRecord(tb, block_num, j);
-				/* add index for new key. */
-				if (tb->GetIndexNum() != 0)
-				{
-					BPlusTree tree(tb->GetIndex(0), buffer_m_, catalog_m_, db_name_);
-					int idx = -1;
-					for (int i = 0; i < tb->GetAttributeNum(); i++)
-					{
-						if (tb->GetAttributes()[i].get_attr_name() == tb->GetIndex(0)->get_attr_name())
-							idx = i;
-					}
-					tree.add(tp[idx], block_num, j);
-				}
-			}
-		}
+		vector<int> offsets = GetOffsets(tb, bp->get_data());
+		predicate.Filter(&layout, bp->get_data(), offsets);
+		for (auto j = offsets.begin(); j != offsets.end(); j++)
+			rids.push_back(MAKE_RID(block_num, *j));
 		block_num = bp->GetNextBlockNum();
 	}
+	int old_first_block = tb->get_first_block_num(), old_first_rubbish = tb->get_first_rubbish_num(), old_block_count = tb->get_block_count();
+	for (auto rid = rids.begin(); rid != rids.end(); rid++)
+	{
+		vector<TKey> tp = GetRecord(tb, RID_BLOCK(*rid), RID_OFFSET(*rid));
+		/* remove old keys from all indexes. */
+		im.RemoveEntries(tb, tp, RID_BLOCK(*rid), RID_OFFSET(*rid));
+		RID updated = UpdateRecord(tb, RID_BLOCK(*rid), RID_OFFSET(*rid), indices, tuple);
+
+		tp = GetRecord(tb, RID_BLOCK(updated), RID_OFFSET(updated));
+		/* add new keys to all indexes. */
+		im.InsertEntries(tb, tp, RID_BLOCK(updated), RID_OFFSET(updated));
+	}
 	buffer_m_->WriteToDisk();
+	if (CatalogChanged(tb, old_first_block, old_first_rubbish, old_block_count))
+		catalog_m_->WriteArchiveFile();
 	cout << "³ɹ" << endl;
 }
+//ĿϢǰͬоڵ㡢ȲͷУʱҪдĿ¼
+bool RecordManager::CatalogChanged(Table* tbl, int first_block, int first_rubbish, int block_count)
+{
+	if (tbl->get_first_block_num() != first_block || tbl->get_first_rubbish_num() != first_rubbish || tbl->get_block_count() != block_count)
+		return true;
+	for (unsigned int i = 0; i < tbl->GetIndexNum(); i++)
+	{
+		if (!tbl->GetIndex(i)->has_header()) return true;
+	}
+	return false;
+}
 //ݱĿõϢ
 BlockInfo* RecordManager::GetBlockInfo(Table* tbl, int block_num)
 {
@@ -956,37 +850,87 @@ BlockInfo* RecordManager::GetBlockInfo(Table* tbl, int block_num)
 	BlockInfo* block = buffer_m_->GetFileBlock(db_name_, tbl->get_tb_name(), 0, block_num);
 	return block;
 }
+
+void RecordManager::CopyBlock(Table* tbl, int block_num, char* data)
+{
+	lock_guard<recursive_mutex> guard(buffer_m_->get_mutex());
+	memcpy(data, GetBlockInfo(tbl, block_num)->get_data(), 4 * 1024);
+}
+
+void RecordManager::set_parallel_workers(int workers)
+{
+	parallel_workers_ = workers;
+}
 //tb1ĵblock_numĵoffsettuple
 vector<TKey> RecordManager::GetRecord(Table* tbl, int block_num, int offset)
 {
-	vector<TKey> keys;
 	BlockInfo *bp = GetBlockInfo(tbl, block_num);
-	char *content = bp->get_data() + 12 + offset * tbl->get_record_length();
-
-	for (int i = 0; i < tbl->GetAttributeNum(); ++i)
+	return DecodeRecord(tbl, bp->get_data(), offset);
+}
+//dataпƫΪoffsetļ¼
+vector<TKey> RecordManager::DecodeRecord(Table* tbl, char* data, int offset)
+{
+	RecordLayout layout(tbl);
+	return RecordView(&layout, data, offset).ToTuple();
+}
+//dataм¼Ŀƫ
+vector<int> RecordManager::GetOffsets(Table* tbl, char* data)
+{
+	vector<int> offsets;
+	if (tbl->get_page_format() == PAGE_FORMAT_SLOTTED)
 	{
-		int value_type = tbl->GetAttributes()[i].get_data_type();
-		int length = tbl->GetAttributes()[i].get_length();
-		//һֵͺԳ
-		TKey tmp(value_type, length);
-		//contentָlengthֽڸƸtmpkey
-		memcpy(tmp.get_key(), content, length);
-		//cout << "RecordManager::GetRecord::memcpy :" << content << " to " << tmp.get_key() << endl;
-		keys.push_back(tmp);
-		content += length;
+		for (int slot = 0; slot < SlottedPage::SlotCount(data); slot++)
+		{
+			if (SlottedPage::IsUsed(data, slot)) offsets.push_back(slot);
+		}
 	}
-	return keys;
+	else
+	{
+		for (int j = 0; j < *((int*)(data + 8)); j++)
+			offsets.push_back(j);
+	}
+	return offsets;
 }
 //ɾtb1block_numĵoffsettuple
 void RecordManager::DeleteRecord(Table* tbl, int block_num, int offset)
 {
 	BlockInfo *bp = GetBlockInfo(tbl, block_num);
-	char *content = bp->get_data() + offset * tbl->get_record_length() + 12;
-	char *replace = bp->get_data() + (bp->GetRecordCount() - 1) * (tbl->get_record_length()) + 12;
-	//Ѵɾ¼Ƶÿβ
-	memcpy(content, replace, tbl->get_record_length());
-	//¼һ
-	bp->DecreaseRecordCount();
+	int last = bp->GetRecordCount() - 1;
+	//Ѵɾ¼ɾҳPAXҳпβļ¼ᱻƵɾλãеĵַҲҪ֮
+	if (tbl->GetIndexNum() != 0)
+	{
+		IndexManager im(catalog_m_, buffer_m_, db_name_);
+		vector<TKey> tuple = GetRecord(tbl, block_num, offset);
+		im.RemoveEntries(tbl, tuple, block_num, offset);
+		if (tbl->get_page_format() != PAGE_FORMAT_SLOTTED && offset != last)
+		{
+			vector<TKey> moved = GetRecord(tbl, block_num, last);
+			im.RemoveEntries(tbl, moved, block_num, last);
+			im.InsertEntries(tbl, moved, block_num, offset);
+		}
+	}
+	RemoveFromBlock(tbl, block_num, offset);
+}
+//Ѽ¼ӿȥ޸
+void RecordManager::RemoveFromBlock(Table* tbl, int block_num, int offset)
+{
+	BlockInfo *bp = GetBlockInfo(tbl, block_num);
+	//Ŀ¼ҳֻѲÿգ¼ĲۺŲ
+	if (tbl->get_page_format() == PAGE_FORMAT_SLOTTED) SlottedPage::Remove(bp->get_data(), offset);
+	else if (tbl->get_page_format() == PAGE_FORMAT_PAX)
+	{
+		PaxPage::Move(tbl, bp->get_data(), bp->GetRecordCount() - 1, offset);
+		bp->DecreaseRecordCount();
+	}
+	else
+	{
+		char *content = bp->get_data() + offset * tbl->get_record_length() + 12;
+		char *replace = bp->get_data() + (bp->GetRecordCount() - 1) * (tbl->get_record_length()) + 12;
+		//Ѵɾ¼Ƶÿβ
+		memcpy(content, replace, tbl->get_record_length());
+		//¼һ
+		bp->DecreaseRecordCount();
+	}
 	//ɾ󣬸ÿ¼Ϊ0ӵ
 	if (bp->GetRecordCount() == 0)
 	{
@@ -998,6 +942,8 @@ void RecordManager::DeleteRecord(Table* tbl, int block_num, int offset)
 			pbp->SetNextBlockNum(nextnum);
 			buffer_m_->WriteBlock(pbp);
 		}
+		else//ǰǿÿĶף׺
+			tbl->set_first_block_num(nextnum);
 		if (nextnum != -1)
 		{//һpreviousΪǰprevious
 			BlockInfo *nbp = GetBlockInfo(tbl, nextnum);
@@ -1005,27 +951,41 @@ void RecordManager::DeleteRecord(Table* tbl, int block_num, int offset)
 			//bpΪdirty޸Ĺ
 			buffer_m_->WriteBlock(nbp);
 		}
-		//õпÿĵһָ
-		BlockInfo *firstrubbish = GetBlockInfo(tbl, tbl->get_first_block_num());
-
-		bp->SetNextBlockNum(-1);
+		//ճĿĶ
 		bp->SetPrevBlockNum(-1);
-		if (firstrubbish != NULL)
-		{
-			//ŵfirstrubbish֮ǰҲǰճĿڿÿĶ׵ǰ
-			firstrubbish->SetPrevBlockNum(block_num);
-			bp->SetNextBlockNum(firstrubbish->get_block_num());
-		}
-		//µΪ
+		bp->SetNextBlockNum(tbl->get_first_rubbish_num());
 		tbl->set_first_rubbish_num(block_num);
 	}
 	//bpΪdirty޸Ĺ
 	buffer_m_->WriteBlock(bp);
 }
 
-void RecordManager::UpdateRecord(Table* tbl, int block_num, int offset, vector<int>& indices, vector<TKey>& values)
+RID RecordManager::UpdateRecord(Table* tbl, int block_num, int offset, vector<int>& indices, vector<TKey>& values)
 {
 	BlockInfo *bp = GetBlockInfo(tbl, block_num);
+	if (tbl->get_page_format() == PAGE_FORMAT_SLOTTED)
+	{
+		vector<TKey> tuple = GetRecord(tbl, block_num, offset);
+		for (unsigned int i = 0; i < indices.size(); i++)
+			tuple[indices[i]] = values[i];
+		vector<char> rec(SlottedPage::MaxLength(tbl));
+		int len = SlottedPage::Encode(tbl, tuple, &rec[0]);
+		//䳤ԭŲʱѼ¼Ƶ
+		if (!SlottedPage::Replace(bp->get_data(), offset, &rec[0], len))
+		{
+			RemoveFromBlock(tbl, block_num, offset);
+			return InsertRecord(tbl, tuple);
+		}
+		buffer_m_->WriteBlock(bp);
+		return MAKE_RID(block_num, offset);
+	}
+	if (tbl->get_page_format() == PAGE_FORMAT_PAX)
+	{
+		for (unsigned int i = 0; i < indices.size(); i++)
+			PaxPage::SetField(tbl, bp->get_data(), offset, indices[i], values[i]);
+		buffer_m_->WriteBlock(bp);
+		return MAKE_RID(block_num, offset);
+	}
 	char *content = bp->get_data() + offset * tbl->get_record_length() + 12;
 
 	for (int i = 0; i < tbl->GetAttributeNum(); i++)
@@ -1036,6 +996,7 @@ void RecordManager::UpdateRecord(Table* tbl, int block_num, int offset, vector<i
 		content += tbl->GetAttributes()[i].get_length();
 	}
 	buffer_m_->WriteBlock(bp);
+	return MAKE_RID(block_num, offset);
 }
 
 
@@ -1128,7 +1089,6 @@ bool RecordManager::SatisfyWhere(Table* tbl, vector<TKey> keys, SQLWhere where)
 	}
 }
 
-
 /**********************                  ۼʵ                      ********************************/
 /*tupleвûбͷϢsqlۼʱۼǱĵڼУindex*/
 TKey RecordManager::Min(vector<vector<TKey> > tuples, int MinIndex)
@@ -1205,4 +1165,4 @@ TKey* RecordManager::Avg(vector<vector<TKey>> tuples, int MinIndex)
 	if (temp != nullptr)
 		(*temp) /= j;
 	return (temp);
-}
\ No newline at end of file
+}
@@ -13,6 +13,9 @@
 #include "CatalogManager.h"
 #include "Exceptions.h"
 #include "BlockInfo.h"
+#include "RecordView.h"
+
+class BatchOperator;
 //һݿкܶԿǶΣκţÿ飨ԿҳŴҳţļϴ洢ģ¼Ǵڿڵģ¼ͨڣҳڣƫõ
 using namespace std;
 //¼tuple
@@ -24,20 +27,32 @@ public:
 	string intToString(int x);
 	string floatToString(float x);
 	void Insert(SQLInsert& st, bool &flag);
-	vector<vector<TKey>> Select(SQLSelect& st);
+	void Select(SQLSelect& st);
 	void JoinSelect(SQLJoinSelect& st);
 	void Delete(SQLDelete& st);
 	void Update(SQLUpdate& st);
 	//رпΪblock_numĿ
 	BlockInfo* GetBlockInfo(Table* tbl, int block_num);
+	//ѱпΪblock_numĿ鸴Ƶdataʱܱ̻߳ڻڸƣ߳̿ͬʱ
+	void CopyBlock(Table* tbl, int block_num, char* data);
+	//ȫɨ߳1ʱòɨ
+	void set_parallel_workers(int workers);
 	//tb1block_numĵoffsettuple
 	vector<TKey> GetRecord(Table* tbl, int block_num, int offset);
+	//dataƳĿ飩пƫΪoffsetļ¼RecordView::ToTuple
+	vector<TKey> DecodeRecord(Table* tbl, char* data, int offset);
+	//dataм¼ĿƫƣҳΪ0¼-1Ŀ¼ҳΪзǿյĲ
+	vector<int> GetOffsets(Table* tbl, char* data);
+	//һ¼деһŵĿ飨ûûյĿտ¿飩޸ؼ¼ַ
+	RID InsertRecord(Table* tbl, vector<TKey>& tuple);
 	//ɾڵblock_numĵoffset¼
 	void DeleteRecord(Table* tbl, int block_num, int offset);
-	//ͼϺkeyϸ±ڵblock_numĵoffset¼
-	void UpdateRecord(Table* tbl, int block_num, int offset, vector<int>& indices/*ͼ*/, vector<TKey>& values/*ÿͶӦļֵ*/);
+	//ͼϺkeyϸ±ڵblock_numĵoffset¼ظºļ¼ַĿ¼ҳм¼䳤ԭŲʱƵ飬ַ֮ı
+	RID UpdateRecord(Table* tbl, int block_num, int offset, vector<int>& indices/*ͼ*/, vector<TKey>& values/*ÿͶӦļֵ*/);
 	//ڱtb1ĳмֵǷwhereӾ
 	bool SatisfyWhere(Table* tbl, vector<TKey> keys, SQLWhere where);
+	//Ŀ׿顢տ顢ǰͬԪԴĿ¼еľʱҪдĿ¼
+	bool CatalogChanged(Table* tbl, int first_block, int first_rubbish, int block_count);
 
 	/**********************                  ۼʵ                      ********************************/
 	//xj0616	aggregation
@@ -46,8 +61,25 @@ public:
 	TKey* RecordManager::Avg(vector<vector<TKey> > tuples, int MinIndex);
 	int RecordManager::Count(vector<vector<TKey> > tuples, int Index);
 private:
+	//selectֶΣۼʱattribute_locΪۼõֶΣΪѡֶΣֶβʱӡʾfalse
+	bool ResolveSelected(Table* tb, vector<string>& selected, bool& isAggregateFunction, vector<int>& attribute_loc);
+	//ִsourceΪsourceΪNULLʱΪգӡۼֵͶӰֶcolumnsȡߴӡ
+	//sort_colΪ-1ʱȡм¼ֶdescΪ򣩣ǰoffsetlimit>=0ʱֻӡ֮limit
+	void Output(BatchOperator* source, Table* tb, vector<string>& selected, bool isAggregateFunction, vector<int>& attribute_loc,
+		vector<int>& columns, int sort_col, bool desc, int offset, int limit, string searchType);
+	//ӡͷطָߣӡһ¼ѡֶ
+	string PrintHeader(Table* tb, vector<string>& selected, bool isAggregateFunction, vector<int>& attribute_loc);
+	void PrintRow(vector<TKey>& tuple, vector<int>& attribute_loc, string& sline);
+	//ܷٷ¼¼tuple
+	bool Fits(Table* tbl, BlockInfo* bp, vector<TKey>& tuple);
+	//Ѽ¼tupleдУĿƫ
+	int PutRecord(Table* tbl, BlockInfo* bp, vector<TKey>& tuple);
+	//Ѽ¼ӿȥҵտϣ޸
+	void RemoveFromBlock(Table* tbl, int block_num, int offset);
+
 	CatalogManager* catalog_m_;
 	BufferManager* buffer_m_;
 	string db_name_;
+	int parallel_workers_;
 };
 #endif
\ No newline at end of file
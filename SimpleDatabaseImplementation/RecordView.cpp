@@ -0,0 +1,171 @@
+//飺¼ͼ
+//ãҳʽֶڿеλãڿԭضȡȽֶ
+#include "RecordView.h"
+#include "SlottedPage.h"
+#include "PaxPage.h"
+#include "ConstValue.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+RecordLayout::RecordLayout(Table* tb)
+{
+	format_ = tb->get_page_format();
+	Init(tb, PAX_HEADER, format_ == PAGE_FORMAT_PAX ? PaxPage::Capacity(tb) : 0);
+	data_size_ = 4096;
+}
+
+RecordLayout::RecordLayout(Table* tb, int capacity)
+{
+	format_ = PAGE_FORMAT_PAX;
+	Init(tb, 0, capacity);
+	data_size_ = capacity * record_length_;
+}
+
+void RecordLayout::Init(Table* tb, int header, int capacity)
+{
+	record_length_ = tb->get_record_length();
+	int offset = 0;
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (auto attr = attrs.begin(); attr != attrs.end(); attr++)
+	{
+		types_.push_back(attr->get_data_type());
+		lengths_.push_back(attr->get_length());
+		offsets_.push_back(format_ == PAGE_FORMAT_PAX ? header + capacity * offset : offset);
+		offset += attr->get_length();
+	}
+}
+
+int RecordLayout::get_format() { return format_; }
+int RecordLayout::get_column_count() { return types_.size(); }
+int RecordLayout::get_type(int col) { return types_[col]; }
+int RecordLayout::get_length(int col) { return lengths_[col]; }
+int RecordLayout::get_offset(int col) { return offsets_[col]; }
+int RecordLayout::get_record_length() { return record_length_; }
+char* RecordLayout::Column(char* data, int col) { return format_ == PAGE_FORMAT_PAX ? data + offsets_[col] : data + 12 + offsets_[col]; }
+int RecordLayout::get_stride(int col) { return format_ == PAGE_FORMAT_PAX ? lengths_[col] : record_length_; }
+int RecordLayout::get_data_size() { return data_size_; }
+
+RecordView::RecordView(RecordLayout* layout, char* data, int offset)
+{
+	layout_ = layout;
+	data_ = data;
+	offset_ = offset;
+	if (layout->get_format() == PAGE_FORMAT_SLOTTED) record_ = SlottedPage::Record(data, offset);
+	else record_ = data + 12 + offset * layout->get_record_length();
+}
+
+const char* RecordView::Field(int col)
+{
+	switch (layout_->get_format())
+	{
+	case PAGE_FORMAT_PAX:
+		return data_ + layout_->get_offset(col) + offset_ * layout_->get_length(col);
+	case PAGE_FORMAT_SLOTTED:
+	{
+		/*ǰֶΣintfloatΪ4ֽڣcharΪ[2][ַ]*/
+		char *p = record_;
+		for (int i = 0; i < col; i++)
+			p += layout_->get_type(i) == T_CHAR ? 2 + *((unsigned short*)p) : 4;
+		return layout_->get_type(col) == T_CHAR ? p + 2 : p;
+	}
+	default:
+		return record_ + layout_->get_offset(col);
+	}
+}
+
+int RecordView::FieldLength(int col)
+{
+	if (layout_->get_format() == PAGE_FORMAT_SLOTTED && layout_->get_type(col) == T_CHAR)
+		return *((unsigned short*)(Field(col) - 2));
+	return layout_->get_length(col);
+}
+
+int RecordView::GetInt(int col)
+{
+	int v;
+	memcpy(&v, Field(col), 4);
+	return v;
+}
+
+float RecordView::GetFloat(int col)
+{
+	float v;
+	memcpy(&v, Field(col), 4);
+	return v;
+}
+
+TKey RecordView::GetKey(int col)
+{
+	TKey key(layout_->get_type(col), layout_->get_length(col));
+	int len = FieldLength(col);
+	if (len < key.get_length()) memset(key.get_key() + len, 0, key.get_length() - len);
+	memcpy(key.get_key(), Field(col), min(len, key.get_length()));
+	return key;
+}
+
+vector<TKey> RecordView::ToTuple(vector<int> *columns)
+{
+	vector<TKey> tuple;
+	for (int i = 0; i < layout_->get_column_count(); i++)
+	{
+		if (columns == NULL || find(columns->begin(), columns->end(), i) != columns->end())
+			tuple.push_back(GetKey(i));
+		else
+		{
+			TKey key(layout_->get_type(i), layout_->get_length(i));
+			memset(key.get_key(), 0, key.get_length());
+			tuple.push_back(key);
+		}
+	}
+	return tuple;
+}
+
+/*ͬstrncmp(ֶ, value, ֶγ)Ŀ¼ҳֶεʵַ֮'\0'*/
+int RecordView::CompareChars(int col, TKey& value)
+{
+	const unsigned char *a = (const unsigned char*)Field(col), *b = (const unsigned char*)value.get_key();
+	int alen = FieldLength(col), blen = value.get_length(), n = layout_->get_length(col);
+	for (int i = 0; i < n; i++)
+	{
+		unsigned char ca = i < alen ? a[i] : 0, cb = i < blen ? b[i] : 0;
+		if (ca != cb) return ca < cb ? -1 : 1;
+		if (ca == 0) return 0;
+	}
+	return 0;
+}
+
+bool RecordView::Less(int col, TKey& value)
+{
+	switch (value.get_key_type())
+	{
+	case T_INT: return GetInt(col) < *((int*)value.get_key());
+	case T_FLOAT: return GetFloat(col) < *((float*)value.get_key());
+	case T_CHAR: return CompareChars(col, value) < 0;
+	default: return GetKey(col) < value;
+	}
+}
+
+bool RecordView::Greater(int col, TKey& value)
+{
+	switch (value.get_key_type())
+	{
+	case T_INT: return GetInt(col) > *((int*)value.get_key());
+	case T_FLOAT: return GetFloat(col) > *((float*)value.get_key());
+	case T_CHAR: return CompareChars(col, value) > 0;
+	default: return GetKey(col) > value;
+	}
+}
+
+bool RecordView::Equal(int col, TKey& value)
+{
+	switch (value.get_key_type())
+	{
+	case T_INT: return GetInt(col) == *((int*)value.get_key());
+	case T_FLOAT: return GetFloat(col) == *((float*)value.get_key());
+	case T_CHAR: return CompareChars(col, value) == 0;
+	default: return GetKey(col) == value;
+	}
+}
@@ -0,0 +1,68 @@
+//飺¼ͼ
+//ãֱڿжȡһ¼ֶΣɨʱذÿ¼Ƴvector<TKey>ֻнҪڿ鱻ʹʱŸƳ
+#pragma once
+#ifndef _RECORDVIEW_H_
+#define _RECORDVIEW_H_
+
+#include <vector>
+
+#include "CatalogManager.h"
+#include "SQLStatement.h"
+
+using namespace std;
+
+/*
+ĸֶڿеλҳĸʽÿֻһΣ
+ҳΪֶڼ¼ڵƫƣ¼12 + к * ¼ȿʼPAXҳΪֶСҳڿڣڣƫƣ
+Ŀ¼ҳм¼Ǳ䳤ģֶελҪӼ¼ĿͷǰֶΣSlottedPage.h
+*/
+class RecordLayout
+{
+public:
+	RecordLayout(Table* tb);
+	//һ¼Executor.hͬPAXҳûпͷÿֶεСҳcapacityֵ
+	RecordLayout(Table* tb, int capacity);
+	int get_format();
+	int get_column_count();
+	int get_type(int col);
+	int get_length(int col);
+	int get_offset(int col);					/*ҳֶڼ¼ڵƫƣPAXҳֶСҳڿڵƫ*/
+	int get_record_length();
+	//ҳPAXҳdataе0¼ֶcolԼ¼ĸֶֽ
+	char* Column(char* data, int col);
+	int get_stride(int col);
+	int get_data_size();						/*Ϊ4096ֽڣΪcapacity * ¼*/
+private:
+	void Init(Table* tb, int header, int capacity);
+	int data_size_;
+	int format_;
+	int record_length_;
+	vector<int> types_;
+	vector<int> lengths_;
+	vector<int> offsets_;
+};
+
+/*dataƳĿ飩пƫΪoffsetļ¼鱻޸ĺͼʧЧ*/
+class RecordView
+{
+public:
+	RecordView(RecordLayout* layout, char* data, int offset);
+	const char* Field(int col);					/*ֶεֽڣĿ¼ҳcharֶβǰ׺*/
+	int FieldLength(int col);					/*ֶڿеֻֽдĿ¼ҳеcharֶΪʵʳ*/
+	int GetInt(int col);
+	float GetFloat(int col);
+	TKey GetKey(int col);						/*ֶθƳTKeyDecodeRecordõͬ*/
+	vector<TKey> ToTuple(vector<int> *columns = NULL);	/*¼columnsΪNULLʱֻеֶΣֶΪȫ0*/
+	//ֶvalueȽϣTKeyıȽͬvalueͱȽϣcharֶγstrncmp
+	bool Less(int col, TKey& value);
+	bool Greater(int col, TKey& value);
+	bool Equal(int col, TKey& value);
+	int CompareChars(int col, TKey& value);		/*charֶvalueȽϣͬstrncmp(ֶ, value, ֶγ)*/
+private:
+	RecordLayout *layout_;
+	char *data_;
+	char *record_;								/*ҳĿ¼ҳм¼ֽ*/
+	int offset_;
+};
+
+#endif
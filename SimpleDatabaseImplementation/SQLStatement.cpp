@@ -1,8 +1,10 @@
 //Implemented by Jin XinSQLJoinSelect is implemented by Lai ZhengMin
 #include"SQLStatement.h"
+#include "SlottedPage.h"
 
 #include <iomanip>
 #include <iostream>
+#include <climits>
 #include <boost/algorithm/string.hpp>
 using namespace std;
 
@@ -83,14 +85,36 @@ void SQLCreateDatabase::set_database_name(string dbname)
 	database_name_ = dbname;
 }
 
+/*ȡsegment_size_*/
+int SQLCreateDatabase::get_segment_size()
+{
+	return segment_size_;
+}
+
 /*sqlȡdatabase*/
 void SQLCreateDatabase::Parse(vector<string> sql_vector)
 {
 	sql_type_ = 21;
+	segment_size_ = 0;
 	if (sql_vector.size() <= 2) throw SyntaxErrorException();
 	else
 	{
 		database_name_ = sql_vector[2];
+		if (sql_vector.size() > 3)
+		{
+			//ѡsegment n.records.indexļÿn MBΪһ
+			if (sql_vector.size() != 5 || boost::algorithm::to_lower_copy(sql_vector[3]) != "segment") throw SyntaxErrorException();
+			try
+			{
+				segment_size_ = stoi(sql_vector[4]);
+			}
+			catch (...)
+			{
+				throw SyntaxErrorException();
+			}
+			//εĿҪŵýint
+			if (segment_size_ <= 0 || segment_size_ > 1024 * 1024) throw SyntaxErrorException();
+		}
 	}
 }
 #pragma endregion	
@@ -121,7 +145,13 @@ void SQLCreateTable::SetAttributes(vector<Attribute> attr)
 {
 	attributes_ = attr;
 }
-/*sqlȡtable֡tableԡcreate table student (name char(100), id int, primary key(id));*/
+/*ȡ¼ҳĸʽ*/
+int SQLCreateTable::get_page_format()
+{
+	return page_format_;
+}
+/*sqlȡtable֡tableԡcreate table student (name char(100), id int, primary key(id));
+  Ŀ¼ı䳤¼ҳcreate table student (name varchar(255), id int, primary key(id)) using slotted;*/
 void SQLCreateTable::Parse(vector<string> sql_vector)
 {
 	sql_type_ = 22;
@@ -169,9 +199,29 @@ void SQLCreateTable::Parse(vector<string> sql_vector)
 			if (if_arrt_exist == false) throw SyntaxErrorException();/*primary key ֶ֮ǰֶв򷵻ش*/
 			pos++;
 			if (sql_vector[pos] != ")") throw SyntaxErrorException();/*ʽΪ primary key(id) 򷵻ش*/
+			pos++;
 			if_primary_key = true;
 		}
 	}
+	pos++;/*ĩβ*/
+
+	page_format_ = PAGE_FORMAT_FIXED;
+	if (sql_vector.size() > pos)/*create table t1(...) using slotted/pax/fixed*/
+	{
+		if (boost::algorithm::to_lower_copy(sql_vector[pos]) != "using" || sql_vector.size() != pos + 2) throw SyntaxErrorException();
+		string format = boost::algorithm::to_lower_copy(sql_vector[pos + 1]);
+		if (format == "slotted") page_format_ = PAGE_FORMAT_SLOTTED;
+		else if (format == "pax") page_format_ = PAGE_FORMAT_PAX;
+		else if (format != "fixed") throw SyntaxErrorException();
+	}
+	/*Ŀ¼ҳУһļ¼ҳͷһҲҪŵ*/
+	if (page_format_ == PAGE_FORMAT_SLOTTED)
+	{
+		int max_len = 0;
+		for (auto att = attributes_.begin(); att != attributes_.end(); att++)
+			max_len += att->get_data_type() == T_CHAR ? att->get_length() + 2 : 4;
+		if (SLOTTED_HEADER + SLOT_SIZE + max_len > 4 * 1024) throw SyntaxErrorException();
+	}
 }
 #pragma endregion
 
@@ -194,13 +244,31 @@ string SQLCreateIndex::get_index_name()
 	return index_name_;
 }
 
-/*ȡֶε*/
-string SQLCreateIndex::get_column_name()
+/*ȡֶ*/
+vector<string> SQLCreateIndex::get_column_names()
 {
-	return col_name_;
+	return col_names_;
+}
+
+/*ȡ*/
+int SQLCreateIndex::get_index_type()
+{
+	return index_type_;
+}
+
+vector<string> SQLCreateIndex::get_include_names()
+{
+	return include_names_;
 }
 
-/*sqlȡtableֶ֡֡ε 磺create index i1 on student(id); */
+/*ȡ߳*/
+int SQLCreateIndex::get_threads()
+{
+	return threads_;
+}
+
+/*sqlȡtableֶ֡֡ε 磺create index i1 on student(id); create index i2 on student(name, age); create index i3 on student(id) using hash;
+  create index i4 on student(id) include (name); create index i5 on student(age) using art; create index i6 on student(name) threads 4;*/
 void SQLCreateIndex::Parse(vector<string> sql_vector)
 {
 	sql_type_ = 23;
@@ -219,11 +287,102 @@ void SQLCreateIndex::Parse(vector<string> sql_vector)
 	if (boost::algorithm::to_lower_copy(sql_vector[pos]) != "(") throw SyntaxErrorException();/*sqlΪcreate index i1 on t1( 򷵻ش*/
 	pos++;
 
-	col_name_ = sql_vector[pos];/*ȡֶ*/
+	col_names_.clear();
+	while (true)/*ȡֶֶԶŷָ*/
+	{
+		if (sql_vector.size() <= pos + 1) throw SyntaxErrorException();
+		col_names_.push_back(sql_vector[pos]);
+		pos++;
+		if (sql_vector[pos] == ")") break;/*create index i1 on t1(id)*/
+		if (sql_vector[pos] != ",") throw SyntaxErrorException();/*create index i1 on t1(a, b)*/
+		pos++;
+	}
 	pos++;
 
-	if (boost::algorithm::to_lower_copy(sql_vector[pos]) != ")") throw SyntaxErrorException();/*sqlΪcreate index i1 on t1(id) 򷵻ش*/
-	pos++;
+	include_names_.clear();
+	if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "include")/*create index i1 on t1(id) include (a, b)*/
+	{
+		pos++;
+		if (sql_vector.size() <= pos || sql_vector[pos] != "(") throw SyntaxErrorException();
+		pos++;
+		while (true)
+		{
+			if (sql_vector.size() <= pos + 1) throw SyntaxErrorException();
+			include_names_.push_back(sql_vector[pos]);
+			pos++;
+			if (sql_vector[pos] == ")") break;
+			if (sql_vector[pos] != ",") throw SyntaxErrorException();
+			pos++;
+		}
+		pos++;
+	}
+
+	index_type_ = INDEX_BTREE;
+	if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "using")/*create index i1 on t1(id) using hash/btree/art*/
+	{
+		if (sql_vector.size() <= pos + 1) throw SyntaxErrorException();
+		pos++;
+		string type = boost::algorithm::to_lower_copy(sql_vector[pos]);
+		if (type == "hash") index_type_ = INDEX_HASH;
+		else if (type == "art") index_type_ = INDEX_ART;
+		else if (type != "btree") throw SyntaxErrorException();
+		pos++;
+	}
+
+	threads_ = 0;
+	if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "threads")/*create index i1 on t1(id) threads 4*/
+	{
+		if (sql_vector.size() <= pos + 1) throw SyntaxErrorException();
+		threads_ = atoi(sql_vector[pos + 1].c_str());
+		if (threads_ <= 0) throw SyntaxErrorException();
+		pos += 2;
+	}
+	if (sql_vector.size() > pos) throw SyntaxErrorException();
+	/*ϣͰֻжļ¼ֶַܸ*/
+	if (index_type_ == INDEX_HASH && !include_names_.empty()) throw SyntaxErrorException();
+}
+#pragma endregion
+
+#pragma region class ʵ֣SQLCreateBloom
+/*SQLCreateBloomĹ캯*/
+SQLCreateBloom::SQLCreateBloom(vector<string> sql_vector)
+{
+	Parse(sql_vector);
+}
+
+/*ȡtable*/
+string SQLCreateBloom::get_tb_name()
+{
+	return table_name_;
+}
+
+/*ȡ¡ڵֶ*/
+string SQLCreateBloom::get_column_name()
+{
+	return col_name_;
+}
+
+/*ȡĿ*/
+int SQLCreateBloom::get_blocks()
+{
+	return blocks_;
+}
+
+/*sqlcreate bloom on student ( id ) [blocks 64]*/
+void SQLCreateBloom::Parse(vector<string> sql_vector)
+{
+	sql_type_ = 24;
+	if (sql_vector.size() != 7 && sql_vector.size() != 9) throw SyntaxErrorException();
+	if (boost::algorithm::to_lower_copy(sql_vector[2]) != "on" || sql_vector[4] != "(" || sql_vector[6] != ")") throw SyntaxErrorException();
+	table_name_ = sql_vector[3];
+	col_name_ = sql_vector[5];
+	blocks_ = 0;
+	if (sql_vector.size() == 9)
+	{
+		if (boost::algorithm::to_lower_copy(sql_vector[7]) != "blocks") throw SyntaxErrorException();
+		blocks_ = atoi(sql_vector[8].c_str());
+		if (blocks_ <= 0) throw SyntaxErrorException();
+	}
 }
 #pragma endregion
 
@@ -314,6 +473,82 @@ void SQLDropIndex::Parse(vector<string> sql_vector)
 }
 #pragma endregion
 
+#pragma region class ʵ֣SQLVacuumIndex
+/*SQLVacuumIndexĹ캯*/
+SQLVacuumIndex::SQLVacuumIndex(vector<string> sql_vector)
+{
+	Parse(sql_vector);
+}
+
+/*ȡindex*/
+string SQLVacuumIndex::get_index_name()
+{
+	return index_name_;
+}
+
+/*sqlȡindex vacuum index i1;*/
+void SQLVacuumIndex::Parse(vector<string> sql_vector)
+{
+	sql_type_ = 101;
+	if (sql_vector.size() != 3) throw SyntaxErrorException();
+	boost::algorithm::to_lower(sql_vector[1]);
+	if (sql_vector[1] != "index") throw SyntaxErrorException();
+	index_name_ = sql_vector[2];
+}
+#pragma endregion
+
+#pragma region class ʵ֣SQLSet
+/*SQLSetĹ캯*/
+SQLSet::SQLSet(vector<string> sql_vector)
+{
+	Parse(sql_vector);
+}
+
+/*ȡvariable_*/
+string SQLSet::get_variable()
+{
+	return variable_;
+}
+
+/*ȡvalue_*/
+int SQLSet::get_value()
+{
+	return value_;
+}
+
+/*sqlset max_parallel_workers = 4*/
+void SQLSet::Parse(vector<string> sql_vector)
+{
+	sql_type_ = 111;
+	if (sql_vector.size() != 4 || sql_vector[2] != "=") throw SyntaxErrorException();
+	if (sql_vector[3].empty() || sql_vector[3].find_first_not_of("0123456789") != string::npos) throw SyntaxErrorException();
+	variable_ = boost::algorithm::to_lower_copy(sql_vector[1]);
+	value_ = sql_vector[3].size() > 9 ? INT_MAX : atoi(sql_vector[3].c_str());/*λ̫ʱintֵʹƷΧ*/
+}
+#pragma endregion
+
+#pragma region class ʵ֣SQLDropBloom
+/*SQLDropBloomĹ캯*/
+SQLDropBloom::SQLDropBloom(vector<string> sql_vector)
+{
+	Parse(sql_vector);
+}
+
+/*ȡtable*/
+string SQLDropBloom::get_tb_name()
+{
+	return table_name_;
+}
+
+/*sqldrop bloom on student*/
+void SQLDropBloom::Parse(vector<string> sql_vector)
+{
+	sql_type_ = 44;
+	if (sql_vector.size() != 4 || boost::algorithm::to_lower_copy(sql_vector[2]) != "on") throw SyntaxErrorException();
+	table_name_ = sql_vector[3];
+}
+#pragma endregion
+
 #pragma region class ʵ֣SQLUse
 /*SQLUseĹ캯*/
 SQLUse::SQLUse(vector<string> sql_vector)
@@ -441,10 +676,37 @@ vector<string>& SQLSelect::get_select_attribute()
 	return select_attribute_;
 }
 
-/*sqlȡtableֺSQLWhereֵ */
+/*ȡorder_by_*/
+string SQLSelect::get_order_by()
+{
+	return order_by_;
+}
+
+/*ȡorder_desc_*/
+bool SQLSelect::is_order_desc()
+{
+	return order_desc_;
+}
+
+/*ȡlimit_*/
+int SQLSelect::get_limit()
+{
+	return limit_;
+}
+
+/*ȡoffset_*/
+int SQLSelect::get_offset()
+{
+	return offset_;
+}
+
+/*sqlȡtableֺSQLWhereֵwhere֮ɽorder by ֶ [asc|desc]limit n [offset m] */
 void SQLSelect::Parse(vector<string> sql_vector)
 {
 	sql_type_ = 61;
+	order_desc_ = false;
+	limit_ = -1;
+	offset_ = 0;
 	unsigned int pos = 1;
 	if (sql_vector.size() <= 1) throw SyntaxErrorException();/*select*/
 	if (sql_vector[pos] == "*")
@@ -487,11 +749,44 @@ void SQLSelect::Parse(vector<string> sql_vector)
 	table_name_ = sql_vector[pos];/*ȡtable*/
 	pos++;
 
-	if (sql_vector.size() == pos) return;
-	if (boost::algorithm::to_lower_copy(sql_vector[pos]) != "where")
-		throw SyntaxErrorException();/*select * from student where*/
-	pos++;
+	if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "where")/*select * from student where*/
+	{
+		pos++;
+		ParseWheres(sql_vector, pos);
+	}
+	if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "order")/*order by id [asc|desc]*/
+	{
+		if (sql_vector.size() <= pos + 2 || boost::algorithm::to_lower_copy(sql_vector[pos + 1]) != "by") throw SyntaxErrorException();
+		order_by_ = sql_vector[pos + 2];
+		pos += 3;
+		if (sql_vector.size() > pos)
+		{
+			string dir = boost::algorithm::to_lower_copy(sql_vector[pos]);
+			if (dir == "asc" || dir == "desc")
+			{
+				order_desc_ = dir == "desc";
+				pos++;
+			}
+		}
+	}
+	if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "limit")/*limit 10*/
+	{
+		if (sql_vector.size() <= pos + 1 || sql_vector[pos + 1].find_first_not_of("0123456789") != string::npos) throw SyntaxErrorException();
+		limit_ = atoi(sql_vector[pos + 1].c_str());
+		pos += 2;
+		if (sql_vector.size() > pos && boost::algorithm::to_lower_copy(sql_vector[pos]) == "offset")/*offset 20*/
+		{
+			if (sql_vector.size() <= pos + 1 || sql_vector[pos + 1].find_first_not_of("0123456789") != string::npos) throw SyntaxErrorException();
+			offset_ = atoi(sql_vector[pos + 1].c_str());
+			pos += 2;
+		}
+	}
+	if (sql_vector.size() != pos) throw SyntaxErrorException();
+}
 
+/*where֮andӵorderlimitΪֹ*/
+void SQLSelect::ParseWheres(vector<string>& sql_vector, unsigned int& pos)
+{
 	while (true)
 	{
 		SQLWhere sql_where;
@@ -512,6 +807,9 @@ void SQLSelect::Parse(vector<string> sql_vector)
 		bool f = true;
 		if ((k = sql_vector[pos].find('.')) == string::npos)
 			f = false;
+		/*С0.5-1.5ַtable.attr*/
+		else if (string("0123456789+-.\'\"").find(sql_vector[pos][0]) != string::npos)
+			f = false;
 		//table.attr
 		if (f)
 		{
@@ -536,7 +834,9 @@ void SQLSelect::Parse(vector<string> sql_vector)
 
 		wheres_.push_back(sql_where);
 		if (sql_vector.size() == pos) break; /*where 䵽˽*/
-		if (boost::algorithm::to_lower_copy(sql_vector[pos]) != "and")
+		string next = boost::algorithm::to_lower_copy(sql_vector[pos]);
+		if (next == "order" || next == "limit") break;
+		if (next != "and")
 			throw SyntaxErrorException();/*select student.id from student join takes where student.id=takes.id and student.name ='Tom'*/
 		pos++;
 	}
@@ -896,7 +1196,7 @@ void SQLUpdate::Parse(vector<string> sql_vector)
 TKey::TKey(int keytype, int length)
 {
 	key_type_ = keytype;
-	if (keytype == 2) length_ = length; //char(100)
+	if (keytype == T_CHAR || keytype == T_BINARY) length_ = length; //char(100)
 	else length_ = 4;
 	key_ = new char[length_];
 }
@@ -909,6 +1209,20 @@ TKey::TKey(const TKey& t1)
 	memcpy(key_, t1.key_, length_);
 }
 
+TKey& TKey::operator=(const TKey& t1)
+{
+	if (this != &t1)
+	{
+		char *key = new char[t1.length_];
+		memcpy(key, t1.key_, t1.length_);
+		delete[]key_;
+		key_ = key;
+		key_type_ = t1.key_type_;
+		length_ = t1.length_;
+	}
+	return *this;
+}
+
 TKey::~TKey()
 {
 	if (key_ != NULL)
@@ -932,6 +1246,9 @@ void TKey::ReadValue(const char *content)
 	}
 	break;
 	case 2:
+		strncpy(key_, content, length_);
+		break;
+	case 3:
 		memcpy(key_, content, length_);
 		break;
 	}
@@ -954,7 +1271,7 @@ void TKey::ReadValue(string content)
 	}
 	break;
 	case 2:
-		memcpy(key_, content.c_str(), length_);
+		strncpy(key_, content.c_str(), length_);
 		break;
 	}
 }
@@ -963,6 +1280,93 @@ int TKey::get_key_type() { return key_type_; }
 char* TKey::get_key() { return key_; }
 int TKey::get_length() { return length_; }
 
+/*룺intתλ󰴴˴ţfloatΪʱתλΪʱȫȡ󰴴˴ţchar'\0'֮0*/
+void TKey::Encode(char *dest)
+{
+	switch (key_type_)
+	{
+	case 0:
+	{
+		unsigned int u;
+		memcpy(&u, key_, 4);
+		u ^= 0x80000000u;
+		for (int i = 0; i < 4; i++)
+			dest[i] = (char)(u >> (24 - 8 * i));
+	}
+	break;
+	case 1:
+	{
+		unsigned int u;
+		memcpy(&u, key_, 4);
+		if (u & 0x80000000u) u = ~u;
+		else u ^= 0x80000000u;
+		for (int i = 0; i < 4; i++)
+			dest[i] = (char)(u >> (24 - 8 * i));
+	}
+	break;
+	case 2:
+	{
+		int len = strnlen(key_, length_);
+		memcpy(dest, key_, len);
+		memset(dest + len, 0, length_ - len);
+	}
+	break;
+	default:
+		memcpy(dest, key_, length_);
+		break;
+	}
+}
+
+/*'\0'κַС"ab\0""abc\0"֮ǰƴںֶβӰǰֶε˳*/
+int TKey::EncodeCompact(char *dest)
+{
+	if (key_type_ != T_CHAR)
+	{
+		Encode(dest);
+		return length_;
+	}
+	int len = strnlen(key_, length_);
+	memcpy(dest, key_, len);
+	dest[len] = 0;
+	return len + 1;
+}
+
+int TKey::DecodeCompact(const char *src)
+{
+	switch (key_type_)
+	{
+	case 0:
+	case 1:
+	{
+		unsigned int u = 0;
+		for (int i = 0; i < 4; i++)
+			u = (u << 8) | (unsigned char)src[i];
+		if (key_type_ == 0 || (u & 0x80000000u)) u ^= 0x80000000u;
+		else u = ~u;
+		memcpy(key_, &u, 4);
+		return 4;
+	}
+	case 2:
+	{
+		int len = strnlen(src, length_);
+		memcpy(key_, src, len);
+		memset(key_ + len, 0, length_ - len);
+		return len + 1;
+	}
+	default:
+		memcpy(key_, src, length_);
+		return length_;
+	}
+}
+
+/*ļֽڱȽϣȲͬʱ϶̵ļǽϳǰ׺С*/
+static int CompareBinary(const char *a, int alen, const char *b, int blen)
+{
+	int c = memcmp(a, b, alen < blen ? alen : blen);
+	if (c != 0) return c;
+	return alen - blen;
+}
+
 std::ostream & operator<<(std::ostream& out, const TKey& object)
 {
 	switch (object.key_type_)
@@ -986,11 +1390,18 @@ std::ostream & operator<<(std::ostream& out, const TKey& object)
 		cout << setw(9) << left << object.key_;
 	}
 	break;
+	case 3:
+	{
+		for (int i = 0; i < object.length_; i++)
+			cout << hex << setw(2) << setfill('0') << right << (int)(unsigned char)object.key_[i];
+		cout << dec << setfill(' ') << " ";
+	}
+	break;
 	}
 	return out;
 }
 
-bool TKey::operator<(const TKey t1)
+bool TKey::operator<(const TKey& t1) const
 {
 	switch (t1.key_type_)
 	{
@@ -1000,12 +1411,14 @@ bool TKey::operator<(const TKey t1)
 		return *(float*)key_ < *(float*)t1.key_;
 	case 2:
 		return (strncmp(key_, t1.key_, length_) < 0);
+	case 3:
+		return (CompareBinary(key_, length_, t1.key_, t1.length_) < 0);
 	default:
 		return false;
 	}
 }
 
-bool TKey::operator>(const TKey t1)
+bool TKey::operator>(const TKey& t1) const
 {
 	switch (t1.key_type_)
 	{
@@ -1015,12 +1428,14 @@ bool TKey::operator>(const TKey t1)
 		return *(float*)key_ > *(float*)t1.key_;
 	case 2:
 		return (strncmp(key_, t1.key_, length_) > 0);
+	case 3:
+		return (CompareBinary(key_, length_, t1.key_, t1.length_) > 0);
 	default:
 		return false;
 	}
 }
 
-bool TKey::operator==(const TKey t1)
+bool TKey::operator==(const TKey& t1) const
 {
 	switch (t1.key_type_)
 	{
@@ -1030,14 +1445,16 @@ bool TKey::operator==(const TKey t1)
 		return *(float*)key_ == *(float*)t1.key_;
 	case 2:
 		return (strncmp(key_, t1.key_, length_) == 0);
+	case 3:
+		return (CompareBinary(key_, length_, t1.key_, t1.length_) == 0);
 	default:
 		return false;
 	}
 }
 
-bool TKey::operator<=(const TKey t1) { return !(operator>(t1)); }
-bool TKey::operator>=(const TKey t1) { return !(operator<(t1)); }
-bool TKey::operator!=(const TKey t1) { return !(operator==(t1)); }
+bool TKey::operator<=(const TKey& t1) const { return !(operator>(t1)); }
+bool TKey::operator>=(const TKey& t1) const { return !(operator<(t1)); }
+bool TKey::operator!=(const TKey& t1) const { return !(operator==(t1)); }
 
 //xj
 TKey* TKey::operator+=(const TKey t1) {
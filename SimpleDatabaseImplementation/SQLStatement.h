@@ -30,49 +30,75 @@ protected:
 };
 #pragma endregion
 
-#pragma region class: SQLCreateDatabase 磺create database university;
+#pragma region class: SQLCreateDatabase 磺create database university; ļ1024MBֶΣcreate database university segment 1024;
 class SQLCreateDatabase : public SQL
 {
 public:
 	SQLCreateDatabase(vector<string> sql_vector);/*SQLCreateDatabaseĹ캯*/
 	string get_database_name();/*ȡdatabase*/
 	void set_database_name(string database_name);/*database*/
-	void Parse(vector<string> sql_vector);/*sqlȡdatabase*/
+	int get_segment_size();/*ȡļÿεĴСMB0ʾֶ*/
+	void Parse(vector<string> sql_vector);/*sqlȡdatabaseֶδС*/
 private:
 	string database_name_;//database
+	int segment_size_;//ļÿεĴСMB
 };
 #pragma endregion
 
-#pragma region class SQLCreateTable 磺create table student (name char(100), id int, primary key(id));
+#pragma region class SQLCreateTable 磺create table student (name char(100), id int, primary key(id)); 䳤¼ҳ create table student (name varchar(255), id int, primary key(id)) using slotted;
 class SQLCreateTable : public SQL
 {
 public:
-	SQLCreateTable() {};
+	SQLCreateTable() { page_format_ = PAGE_FORMAT_FIXED; };
 	SQLCreateTable(vector<string> sql_vector);/*SQLCreateTableĹ캯*/
 	string get_table_name();/*ȡtable*/
 	void set_table_name(string table_name);/*table*/
 	vector<Attribute> get_attributes();/*ȡtable*/
 	void SetAttributes(vector<Attribute> attribute);/*table*/
+	int get_page_format();/*ȡ¼ҳĸʽPAGE_FORMAT_FIXEDPAGE_FORMAT_SLOTTEDPAGE_FORMAT_PAX*/
 	void Parse(vector<string> sql_vector);/*sqlȡtable֡table*/
 private:
 	string table_name_;//table
 	vector<Attribute> attributes_;//table
+	int page_format_;//¼ҳĸʽ
 };
 #pragma endregion
 
-#pragma region class SQLCreateIndex 磺create index i1 on student(id); 
+#pragma region class SQLCreateIndex 磺create index i1 on student(id);  create index i2 on student(name, age); ϣ create index i3 on student(id) using hash;  create index i4 on student(id) include (name); ָ߳ create index i5 on student(name) threads 4;
 class SQLCreateIndex : public SQL
 {
 public:
 	SQLCreateIndex(vector<string> sql_vector);/*SQLCreateIndexĹ캯*/
 	string get_tb_name();/*ȡtable*/
 	string get_index_name();/*ȡ*/
-	string get_column_name();/*ȡֶε*/
+	vector<string> get_column_names();/*ȡֶ˳*/
+	int get_index_type();/*ȡͣINDEX_BTREEINDEX_HASH*/
+	vector<string> get_include_names();/*ȡincludeӾиҶеֶ*/
+	int get_threads();/*ȡthreadsӾָĽ߳δָʱΪ0*/
 	void Parse(vector<string> sql_vector);/*sqlȡtableֶ֡֡ε*/
 private:
 	string index_name_;//
 	string table_name_;//table
-	string col_name_;//ֶε
+	vector<string> col_names_;//ֶ
+	vector<string> include_names_;//Ҷеֶ
+	int index_type_;//
+	int threads_;//߳
+};
+#pragma endregion
+
+#pragma region class SQLCreateBloom 磺create bloom on student(id); ָ create bloom on student(id) blocks 64;
+class SQLCreateBloom : public SQL
+{
+public:
+	SQLCreateBloom(vector<string> sql_vector);/*SQLCreateBloomĹ캯*/
+	string get_tb_name();/*ȡtable*/
+	string get_column_name();/*ȡ¡ڵֶ*/
+	int get_blocks();/*ȡĿδָʱΪ0*/
+	void Parse(vector<string> sql_vector);/*sqlȡtableֶ֡*/
+private:
+	string table_name_;//table
+	string col_name_;//¡ڵֶ
+	int blocks_;//Ŀÿ4096δָʱΪ0ʹĬϿ
 };
 #pragma endregion
 
@@ -115,6 +141,44 @@ private:
 };
 #pragma endregion
 
+#pragma region class SQLVacuumIndex 磺vacuum index i1;
+class SQLVacuumIndex : public SQL
+{
+public:
+	SQLVacuumIndex(vector<string> sql_vector);/*SQLVacuumIndexĹ캯*/
+	string get_index_name();/*ȡindex*/
+	void Parse(vector<string> sql_vector);/*sqlȡindex*/
+private:
+	string index_name_;//
+};
+#pragma endregion
+
+#pragma region class SQLSet 磺set max_parallel_workers = 4;
+class SQLSet : public SQL
+{
+public:
+	SQLSet(vector<string> sql_vector);/*SQLSetĹ캯*/
+	string get_variable();/*ȡ֣תΪСд*/
+	int get_value();/*ȡõֵ*/
+	void Parse(vector<string> sql_vector);/*sqlȡֵ*/
+private:
+	string variable_;//
+	int value_;//õֵǸ
+};
+#pragma endregion
+
+#pragma region class SQLDropBloom 磺drop bloom on student;
+class SQLDropBloom : public SQL
+{
+public:
+	SQLDropBloom(vector<string> sql_vector);/*SQLDropBloomĹ캯*/
+	string get_tb_name();/*ȡtable*/
+	void Parse(vector<string> sql_vector);/*sqlȡtable*/
+private:
+	string table_name_;//table
+};
+#pragma endregion
+
 #pragma region class SQLUse 磺use university
 class SQLUse : public SQL
 {
@@ -160,6 +224,7 @@ class TKey
 public:
 	TKey(int keytype, int length);
 	TKey(const TKey& t1);
+	TKey& operator=(const TKey& t1);
 	~TKey();
 	void ReadValue(const char *content);
 	void ReadValue(string content);
@@ -167,14 +232,20 @@ public:
 	int get_key_type();
 	char* get_key();
 	int get_length();
+	//Ѽֵдdestlength_ֽڣֽڱȽ(memcmp)˳ֵС˳һ
+	void Encode(char *dest);
+	//յı룺charֻ'\0'֮ǰֽټһ'\0'ͬEncodeдֽ
+	int EncodeCompact(char *dest);
+	//EncodeCompacṭsrcֵضȡֽ
+	int DecodeCompact(const char *src);
 
 	friend std::ostream & operator<<(std::ostream& out, const TKey& object);
-	bool operator<(const TKey t1);
-	bool operator>(const TKey t1);
-	bool operator<=(const TKey t1);
-	bool operator>=(const TKey t1);
-	bool operator==(const TKey t1);
-	bool operator!=(const TKey t1);
+	bool operator<(const TKey& t1) const;
+	bool operator>(const TKey& t1) const;
+	bool operator<=(const TKey& t1) const;
+	bool operator>=(const TKey& t1) const;
+	bool operator==(const TKey& t1) const;
+	bool operator!=(const TKey& t1) const;
 	//xj0616 FOR aggregation
 	TKey* operator+=(const TKey t1);
 	TKey* operator/=(const TKey t1);
@@ -199,7 +270,7 @@ private:
 };
 #pragma endregion
 
-#pragma region class SQLSelect 磺select name from student where name = 'Tom';
+#pragma region class SQLSelect 磺select name from student where name = 'Tom'; select * from student order by id desc limit 10 offset 20;
 class SQLSelect : public SQL
 {
 public:
@@ -208,10 +279,19 @@ public:
 	vector<SQLWhere>& GetWheres();/*ȡSQLWhereֵѯ*/
 	void Parse(vector<string> sql_vector);/*sqlȡtableֺSQLWhereֵ*/
 	vector<string>&  get_select_attribute();/*ȡselect_attribute_*/
+	string get_order_by();/*ȡֶΣûorder byʱΪ*/
+	bool is_order_desc();/*Ƿ񰴽*/
+	int get_limit();/*෵صļ¼ûlimitʱΪ-1*/
+	int get_offset();/*֮ǰļ¼ûoffsetʱΪ0*/
 private:
+	void ParseWheres(vector<string>& sql_vector, unsigned int& pos);/*where֮*/
 	string table_name_;//table
 	vector<SQLWhere> wheres_;//SQLWhereֵwhereѯ
 	vector<string> select_attribute_;//洢Ҫѯֶεı
+	string order_by_;//order byֶ
+	bool order_desc_;//order by ... desc
+	int limit_;//limit n
+	int offset_;//offset m
 };
 #pragma endregion
 
@@ -0,0 +1,155 @@
+//飺Ŀ¼ļ¼ҳ
+//ãֶΰѼ¼Ϊ䳤ʽڿòĿ¼¼ɾ¼¼Ĳۺţ¼ַ
+#include "SlottedPage.h"
+#include "ConstValue.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+#define PAGE_SIZE (4 * 1024)
+
+/*ҳͷĿ¼еֶζ2ֽ*/
+static int Get16(char *p) { return *((unsigned short*)p); }
+static void Set16(char *p, int val) { *((unsigned short*)p) = (unsigned short)val; }
+
+static char* Slot(char *data, int slot) { return data + SLOTTED_HEADER + slot * SLOT_SIZE; }
+
+void SlottedPage::Init(char *data)
+{
+	*((int*)(&data[8])) = 0;
+	Set16(&data[12], 0);
+	Set16(&data[14], PAGE_SIZE);
+	Set16(&data[16], PAGE_SIZE - SLOTTED_HEADER);
+}
+
+int SlottedPage::SlotCount(char *data) { return Get16(&data[12]); }
+
+bool SlottedPage::IsUsed(char *data, int slot) { return slot < SlotCount(data) && Get16(Slot(data, slot) + 2) != 0; }
+
+char* SlottedPage::Record(char *data, int slot) { return data + Get16(Slot(data, slot)); }
+
+/*¼СڲʱпղۿãҪռһ*/
+bool SlottedPage::Fits(char *data, int len)
+{
+	int need = len + (*((int*)(&data[8])) < SlotCount(data) ? 0 : SLOT_SIZE);
+	return Get16(&data[16]) >= need;
+}
+
+int SlottedPage::Put(char *data, const char *rec, int len)
+{
+	int slots = SlotCount(data), slot = 0;
+	while (slot < slots && IsUsed(data, slot)) slot++;
+	int directory_end = SLOTTED_HEADER + (slot == slots ? slots + 1 : slots) * SLOT_SIZE;
+	if (Get16(&data[14]) - directory_end < len) Compact(data);
+
+	int start = Get16(&data[14]) - len;
+	memcpy(data + start, rec, len);
+	Set16(&data[14], start);
+	Set16(Slot(data, slot), start);
+	Set16(Slot(data, slot) + 2, len);
+	if (slot == slots)
+	{
+		Set16(&data[12], slots + 1);
+		len += SLOT_SIZE;
+	}
+	Set16(&data[16], Get16(&data[16]) - len);
+	*((int*)(&data[8])) += 1;
+	return slot;
+}
+
+/*ĩβĿղһȥĿ¼֮*/
+void SlottedPage::Remove(char *data, int slot)
+{
+	int freed = Get16(Slot(data, slot) + 2);
+	Set16(Slot(data, slot), 0);
+	Set16(Slot(data, slot) + 2, 0);
+	int slots = SlotCount(data);
+	while (slots > 0 && !IsUsed(data, slots - 1))
+	{
+		slots--;
+		Set16(&data[12], slots);
+		freed += SLOT_SIZE;
+	}
+	Set16(&data[16], Get16(&data[16]) + freed);
+	*((int*)(&data[8])) -= 1;
+	if (slots == 0) Init(data);
+}
+
+bool SlottedPage::Replace(char *data, int slot, const char *rec, int len)
+{
+	int old_len = Get16(Slot(data, slot) + 2);
+	if (len <= old_len)
+	{
+		memcpy(data + Get16(Slot(data, slot)), rec, len);
+		Set16(Slot(data, slot) + 2, len);
+		Set16(&data[16], Get16(&data[16]) + old_len - len);
+		return true;
+	}
+	if (Get16(&data[16]) + old_len < len) return false;
+	/*ȰѾɼ¼ڵĲÿգʱٰ¼¼ŵ֮ǰ*/
+	Set16(Slot(data, slot) + 2, 0);
+	Set16(&data[16], Get16(&data[16]) + old_len);
+	if (Get16(&data[14]) - (SLOTTED_HEADER + SlotCount(data) * SLOT_SIZE) < len) Compact(data);
+	int start = Get16(&data[14]) - len;
+	memcpy(data + start, rec, len);
+	Set16(&data[14], start);
+	Set16(Slot(data, slot), start);
+	Set16(Slot(data, slot) + 2, len);
+	Set16(&data[16], Get16(&data[16]) - len);
+	return true;
+}
+
+/*ƫƴӴСΰѼ¼ƵβƶĿλòḲǻûƶļ¼*/
+void SlottedPage::Compact(char *data)
+{
+	int slots = SlotCount(data);
+	vector<pair<int, int> > order;
+	for (int i = 0; i < slots; i++)
+	{
+		if (IsUsed(data, i)) order.push_back(make_pair(Get16(Slot(data, i)), i));
+	}
+	sort(order.begin(), order.end());
+	int end = PAGE_SIZE;
+	for (auto it = order.rbegin(); it != order.rend(); it++)
+	{
+		int len = Get16(Slot(data, it->second) + 2);
+		end -= len;
+		memmove(data + end, data + it->first, len);
+		Set16(Slot(data, it->second), end);
+	}
+	Set16(&data[14], end);
+}
+
+int SlottedPage::MaxLength(Table* tb)
+{
+	int len = 0;
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (auto attr = attrs.begin(); attr != attrs.end(); attr++)
+		len += attr->get_data_type() == T_CHAR ? attr->get_length() + 2 : 4;
+	return len;
+}
+
+/*ֶε볤ԱĶΪ׼*/
+int SlottedPage::Encode(Table* tb, vector<TKey>& tuple, char *dest)
+{
+	char *p = dest;
+	vector<Attribute> &attrs = tb->GetAttributes();
+	for (unsigned int i = 0; i < attrs.size(); i++)
+	{
+		if (attrs[i].get_data_type() == T_CHAR)
+		{
+			int len = strnlen(tuple[i].get_key(), min(tuple[i].get_length(), attrs[i].get_length()));
+			Set16(p, len);
+			memcpy(p + 2, tuple[i].get_key(), len);
+			p += 2 + len;
+		}
+		else
+		{
+			memcpy(p, tuple[i].get_key(), 4);
+			p += 4;
+		}
+	}
+	return p - dest;
+}
@@ -0,0 +1,42 @@
+//飺Ŀ¼ļ¼ҳ
+//ãֶΰѼ¼Ϊ䳤ʽڿòĿ¼¼ɾ¼¼Ĳۺţ¼ַ
+#pragma once
+#ifndef _SLOTTEDPAGE_H_
+#define _SLOTTEDPAGE_H_
+
+#include <vector>
+
+#include "CatalogManager.h"
+#include "SQLStatement.h"
+
+using namespace std;
+
+/*
+ҳ0-11ֽ붨ҳͬһ顢һ顢¼ǿղ12-13ֽΪ14-15ֽΪ㣬16-17ֽΪֽ¼֮Ŀն
+ΪĿ¼ÿ4ֽ[¼ڿڵƫ2][¼2]Ϊ0ʾղۣ¼ӿβǰš
+¼ַĿƫƾǲۺţɾֻѲÿգ¼¼ÿղۣŲ¶ֽʱȰѼ¼βۺŲ䡣
+¼ı룺intfloatֶΪ4ֽڣcharֶΪ[ʵʳ2][ַ]0
+*/
+#define SLOTTED_HEADER 20
+#define SLOT_SIZE 4
+
+class SlottedPage
+{
+public:
+	static void Init(char *data);										/*տ飺ûвۣ*/
+	static int SlotCount(char *data);									/*¼ĿƫƶС*/
+	static bool IsUsed(char *data, int slot);							/*òм¼*/
+	static char* Record(char *data, int slot);							/*òϼ¼ֽڣֶεĶȡRecordView*/
+	static bool Fits(char *data, int len);								/*ܷٷһlenֽڵļ¼*/
+	static int Put(char *data, const char *rec, int len);				/*һ¼زۺšǰFitsȷϷŵ*/
+	static void Remove(char *data, int slot);							/*ɾòϵļ¼*/
+	static bool Replace(char *data, int slot, const char *rec, int len);	/*Ѹòϵļ¼recۺŲ䣻зŲʱ޸Ĳfalse*/
+
+	static int MaxLength(Table* tb);									/*ļ¼ֽ*/
+	static int Encode(Table* tb, vector<TKey>& tuple, char *dest);		/*һ¼뵽destֽ*/
+
+private:
+	static void Compact(char *data);									/*м¼βն*/
+};
+
+#endif
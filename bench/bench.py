@@ -0,0 +1,106 @@
+"""Benchmark driver for the query executor.
+
+Usage: python3 bench/bench.py BINARY [BINARY ...] [--rows N] [--join A B] [--work DIR]
+
+For each dataset the driver generates the load script, loads it once with
+every binary, and then times each query script against a fresh copy of the
+loaded DATABASEData directory. Each query script runs the same statement
+30 times (10 for the projection). Times are printed in milliseconds, and the
+outputs after the startup help text, without the query method, are compared
+across binaries. Parallel scans (set max_parallel_workers) return rows in a
+different order and can change the last digit of a float avg, and a hash
+join returns rows in a different order than a nested loop join, so those
+outputs may differ.
+
+The 200 x 200 join quoted for the batch executor is --join 200 200.
+"""
+import argparse
+import os
+import random
+import re
+import shutil
+import subprocess
+import time
+
+
+def scan_dataset(rows):
+    rnd = random.Random(1)
+    load = ['create database bs;', 'use bs;',
+            'create table t(id int, name char(20), age int, score float);']
+    for i in range(rows):
+        load.append("insert into t values(%d,'n%d',%d,%f);" % (i, rnd.randint(0, 999), rnd.randint(0, 99), rnd.random()))
+    queries = {
+        'aggregate': ['select count(id), avg(score), max(age) from t where age > 50 and score < 0.5;'] * 30,
+        'projection': ['select id, name from t where age < 20;'] * 10,
+        'limit': ['select * from t where age > 3 limit 5;'] * 30,
+    }
+    return 'bs', load, queries
+
+
+def join_dataset(a_rows, b_rows):
+    rnd = random.Random(2)
+    load = ['create database bj;', 'use bj;',
+            'create table a(id int, name char(12), age int);',
+            'create table b(bid int, aid int, tag char(8));']
+    for i in range(a_rows):
+        load.append("insert into a values(%d,'n%d',%d);" % (i, i, rnd.randint(0, 29)))
+    for i in range(b_rows):
+        load.append("insert into b values(%d,%d,'n%d');" % (i, rnd.randint(0, 2 * a_rows), rnd.randint(0, a_rows)))
+    queries = {
+        'equi-join count': ['select count(a.id) from a join b where a.id = b.aid;'],
+        'equi-join filtered': ['select a.name, b.tag from a join b where a.id = b.aid and a.age < 5;'],
+        'join on char': ['select count(b.bid) from a join b where a.name = b.tag;'],
+    }
+    return 'bj', load, queries
+
+
+# The query method printed after each result names the access path, which is
+# expected to change between binaries; sources are UTF-8 or GBK.
+METHOD = re.compile(b'(?:' + b'|'.join(re.escape(u'| \u67e5\u8be2\u65b9\u5f0f'.encode(e)) for e in ('utf-8', 'gbk')) + b')[^\\n]*')
+
+
+def result_text(out):
+    return METHOD.sub(b'', out[out.rfind(b'\n-----'):])
+
+
+def run(binary, cwd, statements):
+    text = '\n'.join(statements + ['quit;']) + '\n'
+    start = time.time()
+    out = subprocess.run([binary], input=text.encode(), cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT).stdout
+    return (time.time() - start) * 1000, out
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('binaries', nargs='+')
+    parser.add_argument('--rows', type=int, default=60000, help='rows in the scan table')
+    parser.add_argument('--join', type=int, nargs=2, default=[3000, 12000], metavar=('A', 'B'), help='rows in the two join tables')
+    parser.add_argument('--work', default='bench_work', help='scratch directory')
+    args = parser.parse_args()
+    binaries = [os.path.abspath(b) for b in args.binaries]
+
+    for db, load, queries in [scan_dataset(args.rows), join_dataset(*args.join)]:
+        print('== %s: %d statements to load' % (db, len(load)))
+        for n, binary in enumerate(binaries):
+            base = os.path.join(args.work, '%s_%d' % (db, n))
+            shutil.rmtree(base, ignore_errors=True)
+            os.makedirs(base)
+            run(binary, base, load)
+        for name, statements in queries.items():
+            outputs = []
+            line = '%-20s' % name
+            for n, binary in enumerate(binaries):
+                base = os.path.join(args.work, '%s_%d' % (db, n))
+                cwd = os.path.join(args.work, 'run')
+                shutil.rmtree(cwd, ignore_errors=True)
+                shutil.copytree(base, cwd)
+                ms, out = run(binary, cwd, ['use %s;' % db] + statements)
+                outputs.append(result_text(out))
+                line += '%12.0f ms' % ms
+            if any(o != outputs[0] for o in outputs):
+                line += '   (outputs differ)'
+            print(line)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,143 @@
+"""Regression cases for the storage and query layers.
+
+Usage: python3 tests/regress.py BINARY [--work DIR] [CASE ...]
+
+Each case runs its statements in a fresh empty directory and compares the
+result tables printed by the binary with the expected rows. A case also fails
+when the binary writes an error to stderr or does not exit normally. With no
+CASE names every case runs. Out-of-bounds writes do not always crash a plain
+build; run the cases against an AddressSanitizer build as well.
+"""
+import argparse
+import os
+import shutil
+import subprocess
+
+
+def small_records():
+    # (a char(1), b char(1)) records are 2 bytes, so one block holds 2042 of
+    # them: more rows than a batch or the old 1024-row selection bitmap.
+    sql = ['create database r;', 'use r;', 'create table t(a char(1), b char(1));']
+    for i in range(2000):
+        sql.append("insert into t values('%s','%s');" % ('q' if i % 3 == 0 else 'p', 'x' if i % 2 else 'y'))
+    sql += [
+        "select count(a) from t where b = 'x';",
+        'set max_parallel_workers = 4;',
+        "select count(a) from t where b = 'y' and a = 'q';",
+        'set max_parallel_workers = 1;',
+        "update t set a = 'z' where b = 'x';",
+        "select count(b) from t where a = 'z';",
+        "delete from t where a = 'q';",
+        'select count(a) from t;',
+        "select count(a) from t where a = 'p';",
+    ]
+    return sql, [[['1000']], [['334']], [['1000']], [['1666']], [['666']]]
+
+
+def prefix_break_leaf():
+    # 400 keys sharing a 55-byte prefix fill one compressed leaf; 'a' shares
+    # nothing with them, so uncompressed they need several blocks.
+    sql = ['create database r;', 'use r;', 'create table t(id int, name char(60), age int, primary key(id));']
+    for i in range(400):
+        sql.append("insert into t values(%d,'%s%04d',%d);" % (i, 'x' * 55, i, i % 7))
+    sql += [
+        'create index i_name on t(name);',
+        'create index i_name_age on t(name, age);',
+        "insert into t values(1000,'a',1);",
+        "select id from t where name = 'a';",
+        "select count(id) from t where name > 'w';",
+        "select id from t where name = '%s0399';" % ('x' * 55),
+        "update t set name = 'hal' where id > 100;",
+        "select count(id) from t where name = 'hal';",
+        "select count(id) from t where name = 'hal' and age = 3;",
+    ]
+    return sql, [[['1000']], [['400']], [['399']], [['300']], [['43']]]
+
+
+def prefix_break_inner():
+    # The separators of the 375 leaves share a 55-byte prefix, and the first
+    # inner node holds 253 of them. Once the 'a' keys fill leaves of their
+    # own, their separators break that prefix.
+    sql = ['create database r;', 'use r;', 'create table t(id int, name char(255));']
+    for i in range(6000):
+        sql.append("insert into t values(%d,'%s%04d%s');" % (i, 'x' * 55, i, 'y' * 196))
+    sql += [
+        'create index i_name on t(name);',
+    ]
+    for i in range(50):
+        sql.append("insert into t values(%d,'%s%04d%s');" % (6000 + i, 'a' * 55, i, 'y' * 196))
+    sql += [
+        "select id from t where name = '%s0049%s';" % ('a' * 55, 'y' * 196),
+        "select count(id) from t where name < 'b';",
+        "select count(id) from t where name > 'w';",
+        "select id from t where name = '%s5999%s';" % ('x' * 55, 'y' * 196),
+        "delete from t where name > 'w';",
+        'select count(id) from t;',
+    ]
+    return sql, [[['6049']], [['50']], [['6000']], [['5999']], [['50']]]
+
+
+CASES = {
+    'prefix-break-inner': prefix_break_inner,
+    'prefix-break-leaf': prefix_break_leaf,
+    'small-records': small_records,
+}
+
+
+def result_tables(out):
+    """The rows of every result table in out, each row a list of cell strings."""
+    tables = []
+    lines = out.split('\n')
+    i = 0
+    while i + 2 < len(lines):
+        # +---+ / | header | / +---+ / rows / +---+
+        if lines[i].startswith('+') and lines[i + 1].startswith('|') and lines[i + 2].startswith('+'):
+            rows = []
+            i += 3
+            while i < len(lines) and lines[i].startswith('|'):
+                rows.append([cell.strip() for cell in lines[i].strip().strip('|').split('|')])
+                i += 1
+            tables.append(rows)
+        i += 1
+    return tables
+
+
+def run_case(binary, cwd, name):
+    sql, expected = CASES[name]()
+    shutil.rmtree(cwd, ignore_errors=True)
+    os.makedirs(cwd)
+    proc = subprocess.run([binary], input=('\n'.join(sql + ['quit;']) + '\n').encode(), cwd=cwd,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    out = proc.stdout.decode('utf-8', 'replace')
+    err = proc.stderr.decode('utf-8', 'replace')
+    problems = []
+    if proc.returncode != 0:
+        problems.append('exit status %d' % proc.returncode)
+    if 'Error' in err or 'ERROR' in err:
+        problems.append('stderr: ' + err.strip().split('\n')[0])
+    tables = result_tables(out)
+    if tables != expected:
+        problems.append('expected %r, got %r' % (expected, tables))
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('binary')
+    parser.add_argument('cases', nargs='*', help='cases to run (default: all)')
+    parser.add_argument('--work', default='regress_work', help='scratch directory')
+    args = parser.parse_args()
+    binary = os.path.abspath(args.binary)
+    failed = 0
+    for name in args.cases or sorted(CASES):
+        problems = run_case(binary, os.path.join(args.work, name), name)
+        print('%-24s %s' % (name, 'FAIL' if problems else 'ok'))
+        for problem in problems:
+            print('    ' + problem)
+        failed += bool(problems)
+    print('%d of %d cases failed' % (failed, len(args.cases or CASES)))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    exit(main())